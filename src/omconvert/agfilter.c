@@ -44,6 +44,9 @@
 
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS
+#define gmtime_r(_t, _tm) (gmtime_s((_tm), (_t)) == 0 ? (_tm) : NULL)
+#else
+#define _DEFAULT_SOURCE	// gmtime_r()
 #endif
 
 #include <stdlib.h>
@@ -148,7 +151,8 @@ static void AgFilterPrint(agfilter_status_t *status)
 		char timestring[MAX_TIME_STRING];	// 2000-01-01 12:00:00.000\0
 
 		time_t tn = (time_t)status->epochStartTime;
-		struct tm *tmn = gmtime(&tn);
+		struct tm tmBuffer;
+		struct tm *tmn = gmtime_r(&tn, &tmBuffer);
 		float sec = tmn->tm_sec + (float)(status->epochStartTime - (time_t)status->epochStartTime);
 
 		if (status->configuration->formatCsv == 1 || status->configuration->formatCsv == 3)
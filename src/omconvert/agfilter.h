@@ -29,7 +29,7 @@
 #ifndef AGFILTER_H
 #define AGFILTER_H
 
-//#include <stdint.h>
+#include <stdint.h>
 #include <stdbool.h>
 //#include <stdlib.h>
 #include <stdio.h>
@@ -59,7 +59,7 @@ typedef struct
 	double decimateAccumulator;						// Input decimation accumulator
 	double epochStartTime;		// Start time of current epoch
 	int intervalSample;			// Valid seconds within this larger epoch
-	int sample;					// Sample number
+	int64_t sample;				// Sample number
 	int epoch;					// Epoch number
 
 	int integCount;				// Integration count
@@ -29,6 +29,9 @@
 
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS
+#define gmtime_r(_t, _tm) (gmtime_s((_tm), (_t)) == 0 ? (_tm) : NULL)
+#else
+#define _DEFAULT_SOURCE	// gmtime_r()
 #endif
 
 #include <stdlib.h>
@@ -78,7 +81,8 @@ char CsvInit(csv_status_t *status, csv_configuration_t *configuration, int numCh
 			// "ActiGraph(tm) ActiLife"-compatible .CSV export (may need to be at 30Hz to work properly)
 			double t = status->configuration->startTime;
 			time_t tn = (time_t)t;
-			struct tm *tmn = gmtime(&tn);
+			struct tm tmBuffer;
+			struct tm *tmn = gmtime_r(&tn, &tmBuffer);
 			fprintf(status->file, "------------ Data File Created By ActiGraph GT3X+ %sActiLife v6.13.3 Firmware v3.0.0 date format dd/MM/yyyy at %d Hz  Filter Normal -----------\n", true?"omconvert ":"", (int)configuration->sampleRate);
 			fprintf(status->file, "Serial Number: NEO1DXXXXXXXX\n");
 			fprintf(status->file, "Start Time %02d:%02d:%02d\n", tmn->tm_hour, tmn->tm_min, tmn->tm_sec);
@@ -98,7 +102,8 @@ char CsvInit(csv_status_t *status, csv_configuration_t *configuration, int numCh
 			// "GENEActiv(tm) Software"-compatible .CSV export (may need to be at 80Hz to work properly?)
 			double t = status->configuration->startTime;
 			time_t tn = (time_t)t;
-			struct tm *tmn = gmtime(&tn);
+			struct tm tmBuffer;
+			struct tm *tmn = gmtime_r(&tn, &tmBuffer);
 			float sec = tmn->tm_sec + (float)(t - (time_t)t);
 
 			// File has 100-line header
@@ -203,7 +208,8 @@ bool CsvAddValue(csv_status_t *status, double* accel, double temp, bool valid)
 			char timestring[MAX_TIME_STRING];	// 2000-01-01 12:00:00.000\0
 
 			time_t tn = (time_t)t;
-			struct tm *tmn = gmtime(&tn);
+			struct tm tmBuffer;
+			struct tm *tmn = gmtime_r(&tn, &tmBuffer);
 			float sec = tmn->tm_sec + (float)(t - (time_t)t);
 			sprintf(timestring, "%04d-%02d-%02d %02d:%02d:%02d.%03d", 1900 + tmn->tm_year, tmn->tm_mon + 1, tmn->tm_mday, tmn->tm_hour, tmn->tm_min, (int)sec, (int)((sec - (int)sec) * 1000));
 
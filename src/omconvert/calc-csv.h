@@ -30,7 +30,7 @@
 #define CSV_H
 
 
-//#include <stdint.h>
+#include <stdint.h>
 #include <stdbool.h>
 //#include <stdlib.h>
 #include <stdio.h>
@@ -61,7 +61,7 @@ typedef struct
 
 	// 
 	FILE *file;
-	int sample;				// Sample number
+	int64_t sample;			// Sample number
 	int numChannels;
 
 } csv_status_t;
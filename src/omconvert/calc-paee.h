@@ -30,7 +30,7 @@
 #define PAEE_H
 
 
-//#include <stdint.h>
+#include <stdint.h>
 #include <stdbool.h>
 //#include <stdlib.h>
 #include <stdio.h>
@@ -61,7 +61,7 @@ typedef struct
 	// Standard PAEE
 	FILE *file;
 	double epochStartTime;		// Start time of current epoch
-	int sample;					// Sample number
+	int64_t sample;				// Sample number
 	int intervalSample;			// Valid samples within this minute
 	int minute;					// Minute number
 	double minutesAtLevel[PAEE_MAX_CUT_POINTS + 1];	// Minutes at each cut level
@@ -48,6 +48,9 @@ Algorithm:
 
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS
+#define gmtime_r(_t, _tm) (gmtime_s((_tm), (_t)) == 0 ? (_tm) : NULL)
+#else
+#define _DEFAULT_SOURCE	// gmtime_r()
 #endif
 
 #include <stdlib.h>
@@ -72,7 +75,8 @@ static const char *TimeString(char timeCsv, double t, char *buff)
 	static char staticBuffer[MAX_TIME_STRING] = { 0 };	// 2000-01-01 20:00:00.000|
 	if (buff == NULL) { buff = staticBuffer; }
 	time_t tn = (time_t)t;
-	struct tm *tmn = gmtime(&tn);
+	struct tm tmBuffer;
+	struct tm *tmn = gmtime_r(&tn, &tmBuffer);
 	float sec = tmn->tm_sec + (float)(t - (time_t)t);
 	if (timeCsv == 0)
 	{
@@ -138,8 +142,9 @@ void SleepEndSegment(sleep_status_t *status)
 	{
 		if (status->file != NULL)
 		{
-			fprintf(status->file, "%s", TimeString(status->configuration->timeCsv, status->sleepStartTime, NULL));
-			fprintf(status->file, ",%s", TimeString(status->configuration->timeCsv, status->sleepStartTime + status->epochsSleeping, NULL));
+			char timeString[MAX_TIME_STRING];
+			fprintf(status->file, "%s", TimeString(status->configuration->timeCsv, status->sleepStartTime, timeString));
+			fprintf(status->file, ",%s", TimeString(status->configuration->timeCsv, status->sleepStartTime + status->epochsSleeping, timeString));
 //if (status->configuration->timeCsv != 42)		// DELME: Special mode for algorithm comparison
 			fprintf(status->file, ",%u", status->epochsSleeping);
 			fprintf(status->file, "\n");
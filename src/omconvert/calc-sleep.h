@@ -30,7 +30,7 @@
 #define SLEEP_H
 
 
-//#include <stdint.h>
+#include <stdint.h>
 #include <stdbool.h>
 //#include <stdlib.h>
 #include <stdio.h>
@@ -53,7 +53,7 @@ typedef struct
 {
 	sleep_configuration_t *configuration;
 	FILE *file;
-	int sample;					// Sample index (from start)
+	int64_t sample;				// Sample index (from start)
 
 	// Epoch tracking
 	int intervalSample;			// Count of valid samples within this epoch
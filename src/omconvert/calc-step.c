@@ -80,6 +80,9 @@ Note: Paper does not specify precision -- assuming doubles (rather than, e.g., a
 
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS
+#define gmtime_r(_t, _tm) (gmtime_s((_tm), (_t)) == 0 ? (_tm) : NULL)
+#else
+#define _DEFAULT_SOURCE	// gmtime_r()
 #endif
 
 //#define STEP_DEBUG_DUMP	// dump per-sample trace values
@@ -151,7 +154,8 @@ static void StepPrint(step_status_t *status)
 	{
 		char timestring[MAX_TIME_STRING];	// 2000-01-01 12:00:00.000\0
 		time_t tn = (time_t)status->epochStartTime;
-		struct tm *tmn = gmtime(&tn);
+		struct tm tmBuffer;
+		struct tm *tmn = gmtime_r(&tn, &tmBuffer);
 		float sec = tmn->tm_sec + (float)(status->epochStartTime - (time_t)status->epochStartTime);
 		int reportedSteps = (int)(status->halfStepsInEpoch / 2);
 		status->cumulativeStepsReported += reportedSteps;
@@ -305,7 +309,7 @@ bool StepAddValueInternal(step_status_t *status, double *value, double temp, boo
 	// Debug info
 	if (status->sample == 0)
 		printf("sample,epoch,u,meanU,x,y,a,s,peak,truePeak,halfStepsInEpoch,cumulative steps\n");
-	printf("%d,%d,%f,%f,%f,%f,%f,%d,%d,%d,%d,%d\n", status->sample, status->lastEpoch, u, meanU, x, y, a, s, peak, truePeak, status->halfStepsInEpoch, status->cumulativeStepsReported);
+	printf("%lld,%d,%f,%f,%f,%f,%f,%d,%d,%d,%d,%d\n", (long long)status->sample, status->lastEpoch, u, meanU, x, y, a, s, peak, truePeak, status->halfStepsInEpoch, status->cumulativeStepsReported);
 #endif
 
 	// Increment sample number
@@ -29,7 +29,7 @@
 #ifndef STEP_H
 #define STEP_H
 
-//#include <stdint.h>
+#include <stdint.h>
 #include <stdbool.h>
 //#include <stdlib.h>
 #include <stdio.h>
@@ -64,7 +64,7 @@ typedef struct
 	FILE *file;
 	double decimateAccumulator;						// Input decimation accumulator
 	double epochStartTime;								// Start time of current epoch (0=not started)
-	unsigned int sample;									// Sample number
+	int64_t sample;										// Sample number
 	unsigned int lastEpoch;								// Last epoch number reported
 
 	double dcFilter[STEP_DC_FILTER_SIZE];	// DC box filter to subtract from SVM
@@ -74,7 +74,7 @@ typedef struct
 	int lastS;														// Previous sign value
 	int lastPeak;													// Previous true peak type
 	double lastPeakValue;									// Previous true peak value
-	unsigned int lastPeakSample;					// Previous true peak sample index
+	int64_t lastPeakSample;						// Previous true peak sample index
 
 	int halfStepsInEpoch;									// Current half-step count in this epoch (max 1 carry)
 
@@ -29,6 +29,9 @@
 
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS
+#define gmtime_r(_t, _tm) (gmtime_s((_tm), (_t)) == 0 ? (_tm) : NULL)
+#else
+#define _DEFAULT_SOURCE	// gmtime_r()
 #endif
 
 #include <stdlib.h>
@@ -163,7 +166,8 @@ static void SvmPrint(svm_status_t *status)
 		}
 
 		time_t tn = (time_t)status->epochStartTime;
-		struct tm *tmn = gmtime(&tn);
+		struct tm tmBuffer;
+		struct tm *tmn = gmtime_r(&tn, &tmBuffer);
 		float sec = tmn->tm_sec + (float)(status->epochStartTime - (time_t)status->epochStartTime);
 		sprintf(timestring, "%04d-%02d-%02d %02d:%02d:%02d", 1900 + tmn->tm_year, tmn->tm_mon + 1, tmn->tm_mday, tmn->tm_hour, tmn->tm_min, (int)sec);	// (int)((sec - (int)sec) * 1000)
 
@@ -209,13 +213,13 @@ static void SvmPrint(svm_status_t *status)
 
 
 // Processes the specified value
-bool SvmAddValue(svm_status_t *status, double* accel, double temp, char validity, int rawIndex)
+bool SvmAddValue(svm_status_t *status, double* accel, double temp, char validity, int64_t rawIndex)
 {
 	int countRaw = 0;
 	int c;
 
 	if (rawIndex >= status->rawIndex) {
-		countRaw = rawIndex - status->rawIndex;
+		countRaw = (int)(rawIndex - status->rawIndex);
 	}
 	status->rawIndex = rawIndex;
 
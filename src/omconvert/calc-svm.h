@@ -30,7 +30,7 @@
 #define SVM_H
 
 
-//#include <stdint.h>
+#include <stdint.h>
 #include <stdbool.h>
 //#include <stdlib.h>
 #include <stdio.h>
@@ -73,7 +73,7 @@ typedef struct
 	// Standard SVM
 	FILE *file;
 	double epochStartTime;	// Start time of current epoch
-	int sample;				// Sample number
+	int64_t sample;			// Sample number
 	int intervalSample;		// Valid samples within this interval
 
 	// Standard SVM Filter values
@@ -99,7 +99,7 @@ typedef struct
 	int countClippedInput;
 	int countClippedOutput;
 
-	int rawIndex;
+	int64_t rawIndex;
 	int countRaw;
 
 } svm_status_t;
@@ -109,7 +109,7 @@ typedef struct
 char SvmInit(svm_status_t *status, svm_configuration_t *configuration);
 
 // Processes the specified value
-bool SvmAddValue(svm_status_t *status, double *value, double temp, char validity, int rawIndex);
+bool SvmAddValue(svm_status_t *status, double *value, double temp, char validity, int64_t rawIndex);
 
 // Free data resources
 int SvmClose(svm_status_t *status);
@@ -41,6 +41,9 @@ or if the value range, for at least two out of three axes, was less than 50 mg.
 
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS
+#define gmtime_r(_t, _tm) (gmtime_s((_tm), (_t)) == 0 ? (_tm) : NULL)
+#else
+#define _DEFAULT_SOURCE	// gmtime_r()
 #endif
 
 #include <stdlib.h>
@@ -162,7 +165,8 @@ void WtvPrint(wtv_status_t *status)
 		char timestring[MAX_TIME_STRING];	// 2000-01-01 12:00:00.000\0
 
 		time_t tn = (time_t)status->epochStartTime;
-		struct tm *tmn = gmtime(&tn);
+		struct tm tmBuffer;
+		struct tm *tmn = gmtime_r(&tn, &tmBuffer);
 		float sec = tmn->tm_sec + (float)(status->epochStartTime - (time_t)status->epochStartTime);
 		sprintf(timestring, "%04d-%02d-%02d %02d:%02d:%02d", 1900 + tmn->tm_year, tmn->tm_mon + 1, tmn->tm_mday, tmn->tm_hour, tmn->tm_min, (int)sec);	// (int)((sec - (int)sec) * 1000)
 		//sprintf(timestring, "==> %04d-%02d-%02d %02d:%02d:%02d.%03d", status->totalWorn);
@@ -30,7 +30,7 @@
 #define WTV_H
 
 
-//#include <stdint.h>
+#include <stdint.h>
 #include <stdbool.h>
 //#include <stdlib.h>
 #include <stdio.h>
@@ -67,7 +67,7 @@ typedef struct
 	// Standard WTV
 	FILE *file;
 	double epochStartTime;	// Start time of current epoch
-	int sample;				// Sample number
+	int64_t sample;			// Sample number
 	int intervalSample;		// Valid samples within this interval
 	int halfHourEpochs;		// Number of 30-minute epochs to summarize over
 
@@ -0,0 +1,175 @@
+#!/bin/sh
+# Check 64-bit file offsets and sample counts on a synthetic sparse CWA file, with data past the 4 GB offset and a session of more than 2^31 output samples
+# Usage: ./check-large.sh [omconvert]
+# (run from the source directory, the ReadRange check is built from the sources here; needs about 5 GB free in the temporary directory, and takes several minutes)
+
+OMCONVERT="${1:-./omconvert}"
+SOURCE=$(dirname "$0")
+CC="${CC:-cc}"
+
+TEMP=$(mktemp -d) || exit 71
+trap 'rm -rf "$TEMP"' EXIT
+
+# Layout: two blocks of 1000 sectors (80 samples at 100 Hz, 800 seconds) of a constant 1.5 g on the x-axis, within the one-week gap allowed in a session
+#   block 1: sector 2 (after the header), 2020-01-01 00:00:00
+#   block 2: byte offset 4.5 GB (sector 9437184), 2020-01-07 12:00:00 (561600 seconds later)
+# The session ends one sector's duration after the last timestamp, so lasts 562400.8 seconds.
+SECTORS=1000
+OFFSET=4831838208
+BLOCK_TIME=561600
+DURATION=562400.8
+
+# Output rates: 500 Hz keeps the WAV file under 4 GB with the frames of the second block past 2^31 bytes, 4000 Hz is more than 2^31 samples
+WAV_RATE=500
+LARGE_RATE=4000
+
+# Binary output from a line of octal escapes for each sector
+WriteEscaped()
+{
+	while IFS= read -r line; do printf "$line"; done
+}
+
+# CWA header sector pair (session 1, 100 Hz +/-8 g)
+WriteHeader()
+{
+	awk 'BEGIN {
+		for (i = 0; i < 1024; i++) { b[i] = 255 }
+		b[0] = 77; b[1] = 68; b[2] = 252; b[3] = 3;				# "MD", 1020
+		b[5] = 210; b[6] = 4;									# Device id 1234
+		b[7] = 1; b[8] = 0; b[9] = 0; b[10] = 0;				# Session id
+		start = 20 * 67108864 + 1 * 4194304 + 1 * 131072;		# 2020-01-01 00:00:00
+		stop = 30 * 67108864 + 1 * 4194304 + 1 * 131072;		# 2030-01-01 00:00:00
+		for (i = 0; i < 4; i++) { b[13 + i] = int(start / 256 ^ i) % 256; b[17 + i] = int(stop / 256 ^ i) % 256 }
+		b[36] = 74;												# 100 Hz, +/-8 g
+		b[41] = 45;												# Firmware
+		for (s = 0; s < 2; s++) { line = ""; for (i = 0; i < 512; i++) { line = line sprintf("\\%03o", b[s * 512 + i]) } print line }
+	}' | WriteEscaped
+}
+
+# Data sectors: first sequence id, day of January 2020, hour, number of sectors
+WriteSectors()
+{
+	awk -v sequence="$1" -v day="$2" -v hour="$3" -v count="$4" '
+	function put(i, v, n,  j) { for (j = 0; j < n; j++) { b[i + j] = int(v / 256 ^ j) % 256 } }
+	BEGIN {
+		for (n = 0; n < count; n++) {
+			for (i = 0; i < 512; i++) { b[i] = 0 }
+			b[0] = 65; b[1] = 88; put(2, 508, 2);				# "AX", 508
+			put(6, 1, 4); put(10, sequence + n, 4);				# Session id, sequence id
+			k = (100 - (n * 80) % 100) % 100;					# Index of the sample at the whole-second timestamp
+			t = (n * 80 + k) / 100;
+			put(14, 20 * 67108864 + 1 * 4194304 + day * 131072 + (hour + int(t / 3600)) * 4096 + (int(t / 60) % 60) * 64 + t % 60, 4);
+			put(18, 100, 2); put(20, 300, 2); b[23] = 200;		# Light, temperature, battery
+			b[24] = 74; b[25] = 50; put(26, k, 2); put(28, 80, 2);	# 100 Hz +/-8 g, 3-axis 16-bit, timestamp offset, samples
+			for (i = 0; i < 80; i++) { put(30 + 6 * i, 384, 2) }	# x = 1.5 g, y = z = 0
+			sum = 0; for (i = 0; i < 510; i += 2) { sum += b[i] + 256 * b[i + 1] }
+			put(510, (65536 - sum % 65536) % 65536, 2);
+			line = ""; for (i = 0; i < 512; i++) { line = line sprintf("\\%03o", b[i]) } print line
+		}
+	}' | WriteEscaped
+}
+
+FAILED=0
+Check()
+{
+	if [ "$2" = "$3" ]; then echo "ok   $1: $2"; else echo "FAIL $1: $2 (expected $3)"; FAILED=1; fi
+}
+
+# The sparse file (the hole reads as bad sectors), and the same sectors without the hole
+echo "Generating files..."
+{ WriteHeader; WriteSectors 0 1 0 $SECTORS; } > "$TEMP/first.bin"
+WriteSectors 100000 7 12 $SECTORS > "$TEMP/second.bin"
+cp "$TEMP/first.bin" "$TEMP/sparse.cwa"
+dd if=/dev/null of="$TEMP/sparse.cwa" bs=512 seek=$((OFFSET / 512)) count=0 2>/dev/null || { echo "ERROR: Cannot create the sparse file." >&2; exit 73; }
+cat "$TEMP/second.bin" >> "$TEMP/sparse.cwa"
+cat "$TEMP/first.bin" "$TEMP/second.bin" > "$TEMP/compact.cwa"
+LC_ALL=C ls -ls "$TEMP/sparse.cwa"
+
+WAV_SAMPLES=$(awk "BEGIN { printf \"%.0f\", int($DURATION * $WAV_RATE + 0.5) }")
+WAV_BLOCK=$((BLOCK_TIME * WAV_RATE))
+LARGE_SAMPLES=$(awk "BEGIN { printf \"%.0f\", int($DURATION * $LARGE_RATE + 0.5) }")
+LARGE_BLOCK=$((BLOCK_TIME * LARGE_RATE))
+
+# Data past 4 GB: the sparse file converts the same as the compact file (chunked WAV writes at 64-bit offsets, and a sequential conversion)
+echo "Converting to WAV at $WAV_RATE Hz..."
+"$OMCONVERT" "$TEMP/sparse.cwa" -calibrate 0 -resample $WAV_RATE -threads 2 -out "$TEMP/sparse.wav" >/dev/null 2>&1 || { echo "ERROR: Sparse conversion failed." >&2; exit 70; }
+"$OMCONVERT" "$TEMP/compact.cwa" -calibrate 0 -resample $WAV_RATE -threads 1 -out "$TEMP/compact.wav" >/dev/null 2>&1 || { echo "ERROR: Compact conversion failed." >&2; exit 70; }
+Check "Sparse and compact WAV" "$(cmp -s "$TEMP/sparse.wav" "$TEMP/compact.wav" && echo same || echo different)" "same"
+Check "WAV size" "$(wc -c < "$TEMP/sparse.wav" | tr -d ' ')" "$((1024 + 8 * WAV_SAMPLES))"
+
+# WAV frames past 2^31 bytes: the second block starts with the same accelerometer frames as the first (4 channels of 16-bit, the data at 1024 bytes)
+Frames()
+{
+	od -A n -t d2 -v -j $((1024 + 8 * $1)) -N 800 "$TEMP/sparse.wav" | awk '{ printf "%s %s %s\n", $1, $2, $3; printf "%s %s %s\n", $5, $6, $7 }' | sort | uniq -c | tr -s ' '
+}
+Check "WAV frames at byte offset $((1024 + 8 * WAV_BLOCK))" "$(Frames $WAV_BLOCK)" "$(Frames 0)"
+Check "WAV frames before the second block are not data" "$([ "$(Frames $((WAV_BLOCK - 1000)))" = "$(Frames 0)" ] && echo same || echo different)" "different"
+
+# More than 2^31 samples: output sample count, and the times of the summary epochs with data (13 whole minutes of each block)
+echo "Converting to SVM at $LARGE_RATE Hz (more than 2^31 samples)..."
+"$OMCONVERT" "$TEMP/sparse.cwa" -calibrate 0 -resample $LARGE_RATE -svm-file "$TEMP/sparse.svm.csv" -svm-filter 0 -svm-epoch 60 -info "$TEMP/sparse.info" >/dev/null 2>&1 || { echo "ERROR: SVM conversion failed." >&2; exit 70; }
+Check "Output samples" "$(sed -n 's/^Output-samples: //p' "$TEMP/sparse.info")" "$LARGE_SAMPLES"
+Check "Epochs" "$(($(wc -l < "$TEMP/sparse.svm.csv") - 1))" "$(awk "BEGIN { e = $DURATION / 60; printf \"%d\", (e == int(e)) ? e : int(e) + 1 }")"
+Check "Epochs of data" "$(grep -c ",0.500000$" "$TEMP/sparse.svm.csv")" "26"
+Check "First epoch of the second block" "$(grep ",0.500000$" "$TEMP/sparse.svm.csv" | sed -n '14s/,.*//p')" "2020-01-07 12:00:00"
+
+# A WAV file cannot hold more than 2^31 samples
+Check "WAV over 4 GB refused" "$("$OMCONVERT" "$TEMP/sparse.cwa" -calibrate 0 -resample $LARGE_RATE -out "$TEMP/large.wav" 2>&1 >/dev/null | grep -c "Output too large for a WAV file")" "1"
+
+# Random-access reads past 2^31 samples (OmConvertPlayerReadRange), built from the sources without the command-line front end
+cat > "$TEMP/readrange.c" <<'EOF'
+#include <stdio.h>
+#include <stdlib.h>
+#include "omconvert.h"
+
+// Read one second of samples at each time (seconds from the session start): samples in session, first sample, samples read, valid samples, mean x/y/z
+int main(int argc, char *argv[])
+{
+	omdata_t omdata = { 0 };
+	omdata_config_t config;
+	omconvert_settings_t settings = { 0 };
+	om_convert_channel_t priority[] = { { 'a', 0 }, { 'a', 1 }, { 'a', 2 }, { 0, 0 } };
+	om_convert_arrangement_t arrangement;
+	om_convert_player_t player = { 0 };
+	om_convert_range_t range = { 0 };
+	int i, c;
+
+	if (argc < 4) { return 64; }
+	double rate = atof(argv[2]);
+	OmDataConfigInit(&config);
+	if (!OmDataLoad(&omdata, argv[1], &config) || omdata.firstSession == NULL) { fprintf(stderr, "ERROR: Problem loading file.\n"); return 66; }
+	OmConvertFindArrangement(&arrangement, &settings, &omdata, omdata.firstSession, priority);
+	OmConvertPlayerInitialize(&player, &arrangement, rate, 3);
+	range.capacity = (int64_t)rate;
+	for (c = 0; c < 3; c++) { range.values[c] = (double *)malloc((size_t)range.capacity * sizeof(double)); }
+	range.validity = (unsigned char *)malloc((size_t)range.capacity);
+	for (i = 3; i < argc; i++)
+	{
+		double t = arrangement.startTime + atof(argv[i]);
+		int64_t count = OmConvertPlayerReadRange(&player, t, t + 1.0, &range);
+		int64_t n, valid = 0;
+		double sum[3] = { 0 };
+		for (n = 0; n < count; n++)
+		{
+			if (range.validity[n] & 0x01) { continue; }
+			for (c = 0; c < 3; c++) { sum[c] += range.values[c][n]; }
+			valid++;
+		}
+		printf("%lld %lld %lld %lld", (long long)player.numSamples, (long long)range.firstSample, (long long)count, (long long)valid);
+		for (c = 0; c < 3; c++) { printf(" %.6f", (valid > 0) ? sum[c] / valid : 0.0); }
+		printf("\n");
+	}
+	for (c = 0; c < 3; c++) { free(range.values[c]); }
+	free(range.validity);
+	OmConvertPlayerFree(&player);
+	OmDataFree(&omdata);
+	return 0;
+}
+EOF
+SOURCES=$(ls "$SOURCE"/*.c | grep -v '/main\.c$')
+$CC -std=c99 -O2 -DNO_ZLIB=1 -I"$SOURCE" -o "$TEMP/readrange" "$TEMP/readrange.c" $SOURCES -lm -lpthread 2>/dev/null || { echo "ERROR: Cannot build the ReadRange check." >&2; exit 70; }
+READ=$("$TEMP/readrange" "$TEMP/sparse.cwa" $LARGE_RATE $BLOCK_TIME $((BLOCK_TIME - 2)) 2>/dev/null)
+Check "ReadRange at the second block" "$(echo "$READ" | sed -n 1p)" "$LARGE_SAMPLES $LARGE_BLOCK $LARGE_RATE $LARGE_RATE 1.500000 0.000000 0.000000"
+Check "ReadRange before the second block" "$(echo "$READ" | sed -n 2p)" "$LARGE_SAMPLES $((LARGE_BLOCK - 2 * LARGE_RATE)) $LARGE_RATE 0 0.000000 0.000000 0.000000"
+
+exit $FAILED
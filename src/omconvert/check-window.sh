@@ -0,0 +1,26 @@
+#!/bin/sh
+# Check that a -start/-stop time window gives the same samples as the same span of a full conversion
+# Usage: ./check-window.sh datafile.cwa "YYYY-MM-DD hh:mm:ss" "YYYY-MM-DD hh:mm:ss" [omconvert]
+
+if [ $# -lt 3 ]; then
+	echo "Usage: $0 datafile.cwa <start> <stop> [omconvert]" >&2
+	exit 64
+fi
+INPUT="$1"
+START="$2"
+STOP="$3"
+OMCONVERT="${4:-./omconvert}"
+
+TEMP=$(mktemp -d) || exit 71
+trap 'rm -rf "$TEMP"' EXIT
+
+"$OMCONVERT" "$INPUT" -calibrate 0 -csv-file "$TEMP/full.csv" >/dev/null 2>&1 || { echo "ERROR: Full conversion failed." >&2; exit 70; }
+"$OMCONVERT" "$INPUT" -calibrate 0 -start "$START" -stop "$STOP" -csv-file "$TEMP/window.csv" >/dev/null 2>&1 || { echo "ERROR: Window conversion failed." >&2; exit 70; }
+
+# Every row of the window must be the row with the same time in the full conversion
+awk -F, '
+	NR == FNR { full[$1] = $0; next }
+	FNR == 1 { next }
+	{ count++; if (full[$1] != $0) { if (!differ) { print "First difference: " $0 " (full: " full[$1] ")" } differ++ } }
+	END { printf "%d samples in the window, %d differ.\n", count, differ; exit (count == 0 || differ > 0) }
+' "$TEMP/full.csv" "$TEMP/window.csv"
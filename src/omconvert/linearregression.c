@@ -36,9 +36,9 @@
 
 
 // Linear regression with one independent variable
-double *LinearModelFitOneIndependent(int n, double *y, double *x)
+double *LinearModelFitOneIndependent(int n, double *y, double *x, double *coef)
 {
-	static double coef[3];		// offset(intersect), scale(gradient), spare(to be compatible with two-variable version)
+	// coef: offset(intersect), scale(gradient), spare(to be compatible with two-variable version)
 	int i;
 
 	// sum(Xi * Yi)
@@ -72,15 +72,15 @@ double *LinearModelFitOneIndependent(int n, double *y, double *x)
 	coef[1] = b;
 	coef[2] = 0.0;		// just to be compatible with two-variable version
 
-	return &coef[0];
+	return coef;
 }
 
 
 // Linear regression with two independent variables
-double *LinearModelFitTwoIndependent(int n, double *y, double *x1, double *x2)
+double *LinearModelFitTwoIndependent(int n, double *y, double *x1, double *x2, double *coef)
 {
 	// Implemented from information from: http://faculty.cas.usf.edu/mbrannick/regression/Reg2IV.html
-	static double coef[3];		// offset (intersect), scale 1 (gradient 1), scale 2 (gradient 2)
+	// coef: offset (intersect), scale 1 (gradient 1), scale 2 (gradient 2)
 	int i;
 
 	double sumx1 = 0, sumx2 = 0, sumy = 0;
@@ -126,14 +126,14 @@ double *LinearModelFitTwoIndependent(int n, double *y, double *x1, double *x2)
 	coef[1] = b1;
 	coef[2] = b2;
 
-	return &coef[0];
+	return coef;
 }
 
 
 #ifdef ENABLE_APPROXIMATE
 // Linear regression with two independent variables, weighted
 // NOTE: This is not really correct...
-double *LinearModelFitTwoIndependentWeightedApproximately(int n, double *y, double *x1, double *x2, double *weights)
+double *LinearModelFitTwoIndependentWeightedApproximately(int n, double *y, double *x1, double *x2, double *weights, double *coef)
 {
 	double *weightedY = (double *)malloc(sizeof(double) * n);
 	double *weightedX1 = (double *)malloc(sizeof(double) * n);
@@ -151,7 +151,7 @@ double *LinearModelFitTwoIndependentWeightedApproximately(int n, double *y, doub
 		influenceSum += sw;
 	}
 
-	double *coef = LinearModelFitTwoIndependent(n, weightedY, weightedX1, weightedX2);
+	LinearModelFitTwoIndependent(n, weightedY, weightedX1, weightedX2, coef);
 	double influence = n != 0 ? influenceSum / n : 0;
 	if (influence != 0.0) { coef[0] /= influence; }
 
@@ -178,7 +178,7 @@ double *LinearModelFitTwoIndependentWeightedApproximately(int n, double *y, doub
 
 
 
-double *LinearModelFitTwoIndependentWeighted(int n, double *y, double *x1, double *x2, double *weights)
+double *LinearModelFitTwoIndependentWeighted(int n, double *y, double *x1, double *x2, double *weights, double *coef)
 {
 	#define NPARAMS 2
 
@@ -205,7 +205,6 @@ double *LinearModelFitTwoIndependentWeighted(int n, double *y, double *x1, doubl
 	int ret = gsl_multifit_wlinear(matrixX, vectorW, vectorY, vectorC, /*gsl_matrix * cov*/ NULL, /*double * chisq*/ NULL, work);
 	gsl_multifit_linear_free(work);
 
-	static double coef[NPARAMS + 1];
 	// NPARAMS+1
 	coef[0] = gsl_vector_get(vectorC, 0);
 	coef[1] = gsl_vector_get(vectorC, 1);
@@ -35,20 +35,19 @@
 //#define ENABLE_GSL
 
 
-// WARNING: These return a statically allocated array so are not safe (as is) in multi-threaded contexts
-// TODO: Change the API to take a pointer for the return coefficients (will be thread safe)
+// The coefficients are returned in the caller's array of three values (offset, gradient 1, gradient 2), which is also the return value
 
 
-double *LinearModelFitOneIndependent(int n, double *y, double *x);
-double *LinearModelFitTwoIndependent(int n, double *y, double *x1, double *x2);
+double *LinearModelFitOneIndependent(int n, double *y, double *x, double *coef);
+double *LinearModelFitTwoIndependent(int n, double *y, double *x1, double *x2, double *coef);
 
 #ifdef ENABLE_APPROXIMATE
-double *LinearModelFitTwoIndependentWeightedApproximately(int n, double *y, double *x1, double *x2, double *weights);
+double *LinearModelFitTwoIndependentWeightedApproximately(int n, double *y, double *x1, double *x2, double *weights, double *coef);
 #endif
 
 
 #ifdef ENABLE_GSL
-double *LinearModelFitTwoIndependentWeighted(int n, double *y, double *x1, double *x2, double *weights);
+double *LinearModelFitTwoIndependentWeighted(int n, double *y, double *x1, double *x2, double *weights, double *coef);
 #endif
 
 
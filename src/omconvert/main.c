@@ -98,6 +98,7 @@ int main(int argc, char *argv[])
 	settings.paeeModel = "";	// default
 	settings.agfilterEpoch = 1;
 	settings.stepEpoch = 60;
+	settings.cacheBudget = 16;
 
 	for (i = 1; i < argc; i++)
 	{
@@ -108,10 +109,27 @@ int main(int argc, char *argv[])
 		else if (strcmp(argv[i], "-interpolate-mode") == 0) { settings.interpolate = atoi(argv[++i]); }
 		else if (strcmp(argv[i], "-aux-channel") == 0) { settings.auxChannel = atoi(argv[++i]); }
 		else if (strcmp(argv[i], "-info") == 0) { settings.infoFilename = argv[++i]; }
+		else if (strcmp(argv[i], "-metadata-only") == 0) { settings.metadataOnly = true; }
+		else if (strcmp(argv[i], "-verify") == 0) { settings.verifyFilename = argv[++i]; }
 		else if (strcmp(argv[i], "-stationary") == 0) { settings.stationaryFilename = argv[++i]; }
 		else if (strcmp(argv[i], "-header-csv") == 0) { settings.headerCsv = atoi(argv[++i]); }
 		else if (strcmp(argv[i], "-time") == 0) { settings.timeCsv = atoi(argv[++i]); }
 		else if (strcmp(argv[i], "-forceaccept") == 0) { settings.forceAccept = true; }
+		else if (strcmp(argv[i], "-threads") == 0) { settings.threads = atoi(argv[++i]); }
+		else if (strcmp(argv[i], "-index") == 0) { settings.index = true; }
+		else if (strcmp(argv[i], "-io") == 0)
+		{
+			const char *io = argv[++i];
+			if (strcmp(io, "mmap") == 0) { settings.io = OMDATA_IO_MMAP; }
+			else if (strcmp(io, "read") == 0) { settings.io = OMDATA_IO_READ; }
+			else if (strcmp(io, "direct") == 0) { settings.io = OMDATA_IO_DIRECT; }
+			else if (strcmp(io, "uring") == 0) { settings.io = OMDATA_IO_URING; }
+			else { fprintf(stderr, "Invalid I/O backend: %s\n", io); help = 1; }
+		}
+		else if (strcmp(argv[i], "-memory-budget") == 0) { settings.memoryBudget = atoi(argv[++i]); }
+		else if (strcmp(argv[i], "-cache-budget") == 0) { settings.cacheBudget = atoi(argv[++i]); }
+		else if (strcmp(argv[i], "-start") == 0) { settings.startTime = ParseTime(argv[++i]); if (settings.startTime <= 0) { fprintf(stderr, "Invalid start time.\n"); help = 1; } }
+		else if (strcmp(argv[i], "-stop") == 0) { settings.stopTime = ParseTime(argv[++i]); if (settings.stopTime <= 0) { fprintf(stderr, "Invalid stop time.\n"); help = 1; } }
 
 		else if (strcmp(argv[i], "-calibrate") == 0) { settings.calibrate = atoi(argv[++i]); }
 		else if (strcmp(argv[i], "-calibrate-repeated") == 0) { settings.repeatedStationary = atoi(argv[++i]); }
@@ -178,6 +196,8 @@ int main(int argc, char *argv[])
 		else if (strcmp(argv[i], "-step-file") == 0) { settings.stepFilename = argv[++i]; }
 		else if (strcmp(argv[i], "-step-epoch") == 0) { settings.stepEpoch = atoi(argv[++i]); }
 
+		else if (strcmp(argv[i], "-aux-file") == 0) { settings.auxFilename = argv[++i]; }
+
 		else if (argv[i][0] == '-')
 		{
 			fprintf(stderr, "Unknown option: %s\n", argv[i]);
@@ -213,13 +233,22 @@ int main(int argc, char *argv[])
 		fprintf(stderr, "\n");
 		fprintf(stderr, "\t-out <filename.wav>\n");
 		fprintf(stderr, "\t-resample <rate (default from input configuration)>\n");
-		fprintf(stderr, "\t-interpolate-mode <1=nearest, 2=linear, 3=cubic (default)>\n");
+		fprintf(stderr, "\t-interpolate-mode <1=nearest, 2=linear, 3=cubic (default), 4=anti-aliased (fixed-point low-pass filter where the rates have a small integer ratio, e.g. 100 Hz to 30/40/50 Hz; otherwise cubic)>\n");
 //		fprintf(stderr, "\t-aux-channel <0=ignore, 1=include (default)>\n");
 		fprintf(stderr, "\t-info <filename.txt>\n");
+		fprintf(stderr, "\t-metadata-only (only write the -info file, or to stdout, from the header and the first and last data sectors)\n");
+		fprintf(stderr, "\t-verify <filename.csv> (only check the sectors: bad sectors, sequence breaks, time gaps and configuration changes)\n");
 		fprintf(stderr, "\t-stationary <filename.csv>\n");
 		fprintf(stderr, "\t-header-csv <0=none, 1=header in first row (default)>\n");
 		fprintf(stderr, "\t-time <0=absolute (default), 1=UNIX epoch>\n");
-		fprintf(stderr, "\t-forceaccept");
+		fprintf(stderr, "\t-forceaccept\n");
+		fprintf(stderr, "\t-threads <0=one per processor (default), 1=single-threaded>\n");
+		fprintf(stderr, "\t-index (read/write an index file <filename.cwa>.omidx)\n");
+		fprintf(stderr, "\t-io <mmap|read|direct|uring (default mmap where supported without a memory budget, otherwise read)>\n");
+		fprintf(stderr, "\t-memory-budget <MB for windowed reading, 0=map whole file where supported (default)>\n");
+		fprintf(stderr, "\t-cache-budget <MB for decoded samples, 0=off (default 16)>\n");
+		fprintf(stderr, "\t-start <YYYY-MM-DD hh:mm:ss (only load data from this time)>\n");
+		fprintf(stderr, "\t-stop <YYYY-MM-DD hh:mm:ss (only load data until this time)>\n");
 		fprintf(stderr, "\n");
 		fprintf(stderr, "\t-calibrate <0=off, 1=auto (default)>\n");	// 2=auto (force interpolator)
 		fprintf(stderr, "\t-calibrate-repeated <0=include (default), 1=ignore>\n");
@@ -248,6 +277,13 @@ int main(int argc, char *argv[])
 		fprintf(stderr, "\t-step-file <filename.step.csv>\n");
 		fprintf(stderr, "\t-step-epoch <seconds (default 60)>\n");		
 		fprintf(stderr, "\n");
+		fprintf(stderr, "\t-aux-file <filename.aux.csv> (CWA files only: light, temperature, battery and events for each sector)\n");
+		fprintf(stderr, "\n");
+		fprintf(stderr, "Each session in the recording is converted (concurrently, see -threads): any \"{n}\" in an output\n");
+		fprintf(stderr, "file name is replaced with the session number, otherwise the output files for sessions after the\n");
+		fprintf(stderr, "first have \".s<n>\" inserted before the extension (e.g. out.wav, out.s2.wav; out.svm.csv, out.svm.s2.csv).\n");
+		fprintf(stderr, "Threads left over from the sessions generate chunks of each session's output concurrently.\n");
+		fprintf(stderr, "\n");
 
 		ret = EXIT_USAGE;
 	}
@@ -0,0 +1,148 @@
+/*
+* Copyright (c) 2026, Open Movement contributors.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Open Movement Data Arena - block allocator for the loaded tables
+// Open Movement contributors, 2026
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "omarena.h"
+
+
+#define OMARENA_ALIGN 16
+#define OMARENA_ROUND(_n) (((_n) + (OMARENA_ALIGN - 1)) & ~(size_t)(OMARENA_ALIGN - 1))
+
+struct omarena_block_tag_t
+{
+	omarena_block_t *next;
+	size_t size;				// Size of the data area
+	size_t used;				// Bytes used in the data area
+};
+
+#define OMARENA_HEADER OMARENA_ROUND(sizeof(omarena_block_t))
+#define OMARENA_DATA(_block) ((unsigned char *)(_block) + OMARENA_HEADER)
+
+
+void OmArenaInit(omarena_t *arena, size_t blockSize)
+{
+	memset(arena, 0, sizeof(omarena_t));
+	arena->blockSize = OMARENA_ROUND(blockSize);
+}
+
+
+void *OmArenaAlloc(omarena_t *arena, size_t size)
+{
+	omarena_block_t *block = arena->current;
+	size = OMARENA_ROUND(size);
+
+	if (block == NULL || block->size - block->used < size)
+	{
+		// New block (large enough for the allocation to be extended to twice its size)
+		size_t blockSize = (arena->first == NULL && arena->blockSize > 0) ? arena->blockSize : OMARENA_DEFAULT_BLOCK;
+		if (blockSize < 2 * size) { blockSize = 2 * size; }
+		block = (omarena_block_t *)malloc(OMARENA_HEADER + blockSize);
+		if (block == NULL) { fprintf(stderr, "ERROR: Problem allocating %u byte block.\n", (unsigned int)blockSize); return NULL; }
+		block->next = arena->first;
+		block->size = blockSize;
+		block->used = 0;
+		arena->first = block;
+		arena->current = block;
+		arena->blocks++;
+		arena->reserved += blockSize;
+	}
+
+	arena->last = OMARENA_DATA(block) + block->used;
+	block->used += size;
+	arena->allocations++;
+	arena->used += size;
+	return arena->last;
+}
+
+
+size_t OmArenaAvailable(omarena_t *arena, void *ptr)
+{
+	omarena_block_t *block = arena->current;
+	if (ptr == NULL || block == NULL || ptr != arena->last) { return 0; }
+	return block->size - (size_t)((unsigned char *)ptr - OMARENA_DATA(block));
+}
+
+
+int OmArenaExtend(omarena_t *arena, void *ptr, size_t size)
+{
+	omarena_block_t *block = arena->current;
+	if (ptr == NULL || block == NULL || ptr != arena->last) { return 0; }
+
+	size_t offset = (size_t)((unsigned char *)ptr - OMARENA_DATA(block));
+	size = OMARENA_ROUND(size);
+	if (size > block->size - offset) { return 0; }
+
+	arena->used += size - (block->used - offset);	// (the allocation may also be shrunk)
+	block->used = offset + size;
+	arena->extensions++;
+	return 1;
+}
+
+
+void OmArenaAdopt(omarena_t *arena, omarena_t *other)
+{
+	omarena_block_t *block;
+	if (other->first == NULL) { return; }
+
+	// Append the other blocks after the first block (the current block is unchanged)
+	for (block = other->first; block->next != NULL; block = block->next) { ; }
+	if (arena->first == NULL)
+	{
+		arena->first = other->first;
+	}
+	else
+	{
+		block->next = arena->first->next;
+		arena->first->next = other->first;
+	}
+
+	arena->allocations += other->allocations;
+	arena->extensions += other->extensions;
+	arena->blocks += other->blocks;
+	arena->used += other->used;
+	arena->reserved += other->reserved;
+
+	other->first = NULL;
+	OmArenaFree(other);
+}
+
+
+void OmArenaFree(omarena_t *arena)
+{
+	omarena_block_t *block, *next;
+	for (block = arena->first; block != NULL; block = next)
+	{
+		next = block->next;
+		free(block);
+	}
+	OmArenaInit(arena, 0);
+}
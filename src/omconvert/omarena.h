@@ -0,0 +1,76 @@
+/*
+* Copyright (c) 2026, Open Movement contributors.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Open Movement Data Arena - block allocator for the loaded tables
+// Open Movement contributors, 2026
+
+// Allocations are made from large blocks and are only released all together.
+// The most recent allocation can be extended in place while there is space remaining in its block,
+// so a table that is grown while nothing else is allocated from the same arena stays contiguous.
+
+#ifndef OMARENA_H
+#define OMARENA_H
+
+#include <stddef.h>
+
+#define OMARENA_DEFAULT_BLOCK (64 * 1024)
+
+typedef struct omarena_block_tag_t omarena_block_t;
+
+typedef struct
+{
+	omarena_block_t *first;		// All blocks
+	omarena_block_t *current;	// Block being allocated from
+	void *last;					// Most recent allocation (can be extended)
+	size_t blockSize;			// Size of the first block (later blocks are at least the default size)
+
+	// Statistics
+	int allocations;			// Number of allocations made
+	int extensions;				// Number of allocations extended in place
+	int blocks;					// Number of blocks allocated
+	size_t used;				// Bytes allocated
+	size_t reserved;			// Bytes in the blocks
+} omarena_t;
+
+// Initialize an arena, the first block is allocated (on first use) with the given size (0 = default)
+void OmArenaInit(omarena_t *arena, size_t blockSize);
+
+// Allocate from the arena (uninitialized)
+void *OmArenaAlloc(omarena_t *arena, size_t size);
+
+// Size that an allocation could be extended to in place (0 if it is not the most recent allocation)
+size_t OmArenaAvailable(omarena_t *arena, void *ptr);
+
+// Extend the most recent allocation in place, returns non-zero if successful (otherwise the allocation is unchanged)
+int OmArenaExtend(omarena_t *arena, void *ptr, size_t size);
+
+// Move the blocks of another arena in to this arena (the other arena is left empty)
+void OmArenaAdopt(omarena_t *arena, omarena_t *other);
+
+// Free all allocations
+void OmArenaFree(omarena_t *arena);
+
+#endif
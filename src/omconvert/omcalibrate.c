@@ -46,15 +46,17 @@
 
 #define ALT_SD	// More stable - see Knuth TAOCP vol 2, 3rd edition, page 232
 
+#define OMCALIBRATE_DECODE_SAMPLES 1024	// Number of samples decoded at a time from direct data
+
 
 // (Internal) Find stationary points (using either a player or direct data)
-static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibrate_config_t *config, omdata_t *data, om_convert_player_t *player)
+static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibrate_config_t *config, omdata_t *data, omdata_session_t *session, om_convert_player_t *player)
 {
 	double sampleRate, startTime;
 	double firstSampleTime = 0;
 	int lastWindow = -1;
-	int numSamples;
-	int samplesInPreviousSegments = 0;
+	int64_t numSamples;
+	int64_t samplesInPreviousSegments = 0;
 	omdata_segment_t *dataSegment = NULL;
 
 	if (player != NULL)
@@ -65,7 +67,7 @@ static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibr
 	}
 	else if (data != NULL)
 	{
-		omdata_stream_t *stream = &data->stream['a'];
+		omdata_stream_t *stream = (session != NULL) ? &session->stream['a'] : &data->stream['a'];
 		if (!stream->inUse) 
 		{
 			fprintf(stderr, "ERROR: Calibration failed as accelerometer stream not found.\n");
@@ -115,10 +117,26 @@ static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibr
 
 	// Time interpolation for direct data
 	int lastSectorIndex = -1;
-	int nextTimestampSample = -1, lastTimestampSample = -1;
+
+	// Block of decoded samples for direct data
+	int16_t decodedValues[OMDATA_MAX_CHANNELS][OMCALIBRATE_DECODE_SAMPLES] = { { 0 } };
+	int16_t *decoded[OMDATA_MAX_CHANNELS];
+	omdata_segment_t *decodedSegment = NULL;
+	int decodedStart = 0, decodedCount = 0;
+	for (int c = 0; c < OMDATA_MAX_CHANNELS; c++) { decoded[c] = decodedValues[c]; }
+	int64_t nextTimestampSample = -1, lastTimestampSample = -1;
 	double nextTimestampValue = 0, lastTimestampValue = 0;
 
-	int sample;
+	// Block of samples from the player
+	om_convert_block_t *block = NULL;
+	if (player != NULL)
+	{
+		block = (om_convert_block_t *)malloc(sizeof(om_convert_block_t));
+		if (block == NULL) { fprintf(stderr, "ERROR: Problem allocating player block.\n"); numSamples = 0; }
+		else { block->start = 0; block->count = 0; }
+	}
+
+	int64_t sample;
 	for (sample = 0; sample < numSamples; sample++)
 	{
 		int c;
@@ -129,14 +147,19 @@ static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibr
 
 		if (player != NULL)
 		{
-			OmConvertPlayerSeek(player, sample);
-			if (!player->valid) { sampleCount = 0; continue; }
-			// Convert to units
+			// Next block of samples from the player
+			if (sample >= block->start + block->count)
+			{
+				if (OmConvertPlayerSeekBlock(player, sample, block) <= 0) { break; }
+			}
+			int n = (int)(sample - block->start);
+			if (block->invalid & ((uint64_t)1 << n)) { sampleCount = 0; continue; }
+			// Already in units
 			for (c = 0; c < OMCALIBRATE_AXES; c++)	// player.arrangement->numChannels
 			{
-				values[c] = player->scale[c] * player->values[c];
+				values[c] = block->values[c][n];
 			}
-			temp = player->temp;
+			temp = block->temp[n];
 			currentTime = ((double)sample / sampleRate) + startTime;
 
 			// Have we filled a window?
@@ -145,7 +168,7 @@ static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibr
 		}
 		else if (data != NULL)
 		{
-			int sampleWithinSegment = sample - samplesInPreviousSegments;
+			int sampleWithinSegment = (int)(sample - samplesInPreviousSegments);
 
 			// Check we have data
 			if (dataSegment == NULL)
@@ -185,7 +208,7 @@ static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibr
 			}
 
 			// Sector index
-			int sectorIndex = dataSegment->sectorIndex[sectorWithinSegment];
+			int sectorIndex = OmDataSegmentSector(dataSegment, sectorWithinSegment);
 
 #if 1
 
@@ -196,7 +219,7 @@ static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibr
 				// Get current sector time
 				int sampleIndexOffset = 0;
 				double newTimestampValue = OmDataTimestampForSector(data, sectorIndex, 'a', &sampleIndexOffset);
-				int newTimestampSample = sample + sampleIndexOffset;
+				int64_t newTimestampSample = sample + sampleIndexOffset;
 
 				// Replace 'next' timestamp if different
 				if (newTimestampSample != nextTimestampSample)
@@ -214,7 +237,7 @@ static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibr
 			}
 			
 			// If we only have one timestamp to estimate from
-			int elapsedSamples = sample - lastTimestampSample + 1;
+			int64_t elapsedSamples = sample - lastTimestampSample + 1;
 			if (nextTimestampSample <= lastTimestampSample)
 			{
 				currentTime = lastTimestampValue + (elapsedSamples / sampleRate);
@@ -238,15 +261,26 @@ static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibr
 			lastTime = currentTime;
 #endif
 
-			// Get samples
+			// Get samples (decoded a block at a time)
+			if (dataSegment != decodedSegment || sampleWithinSegment < decodedStart || sampleWithinSegment >= decodedStart + decodedCount)
+			{
+				decodedSegment = dataSegment;
+				decodedStart = sampleWithinSegment;
+				decodedCount = dataSegment->description.numSamples - sampleWithinSegment;
+				if (decodedCount > OMCALIBRATE_DECODE_SAMPLES) { decodedCount = OMCALIBRATE_DECODE_SAMPLES; }
+				OmDataGetValuesBlock(data, dataSegment, decodedStart, decodedCount, decoded, NULL);
+			}
 			int16_t intvalues[OMCALIBRATE_AXES];
-			OmDataGetValues(data, dataSegment, sampleWithinSegment, intvalues);
+			for (c = 0; c < OMCALIBRATE_AXES; c++)
+			{
+				intvalues[c] = decoded[c][sampleWithinSegment - decodedStart];
+			}
 
 			// Get temperature
 			temp = 0;
 			if (dataSegment->description.offset == 30)
 			{
-				const unsigned char *p = (const unsigned char *)data->buffer + (OMDATA_SECTOR_SIZE * sectorIndex);
+				const unsigned char *p = OmDataSector(data, sectorIndex);
 				int16_t inttemp = p[20] | ((int16_t)p[21] << 8);		// @20 WORD Temperature
 				// Convert
 				temp = ((int)inttemp * 150 - 20500) / 1000.0;
@@ -436,6 +470,8 @@ static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibr
 
 	}
 
+	free(block);
+
 	return stationaryPoints;
 }
 
@@ -443,13 +479,13 @@ static omcalibrate_stationary_points_t *OmCalibrateFindStationaryPoints(omcalibr
 // Find stationary points (using an interpolating player)
 omcalibrate_stationary_points_t *OmCalibrateFindStationaryPointsFromPlayer(omcalibrate_config_t *config, om_convert_player_t *player)
 {
-	return OmCalibrateFindStationaryPoints(config, NULL, player);
+	return OmCalibrateFindStationaryPoints(config, NULL, NULL, player);
 }
 
 // Find stationary points (using direct data)
-omcalibrate_stationary_points_t *OmCalibrateFindStationaryPointsFromData(omcalibrate_config_t *config, omdata_t *data)
+omcalibrate_stationary_points_t *OmCalibrateFindStationaryPointsFromData(omcalibrate_config_t *config, omdata_t *data, omdata_session_t *session)
 {
-	return OmCalibrateFindStationaryPoints(config, data, NULL);
+	return OmCalibrateFindStationaryPoints(config, data, session, NULL);
 }
 
 
@@ -748,22 +784,23 @@ int OmCalibrateFindAutoCalibration(omcalibrate_config_t *config, omcalibrate_sta
 			off[c] = 0;
 			tOff[c] = 0;
 
+			double coefBuffer[3] = { 0 };
 			double *coef;
 			if (config->useTemp)
 			{
 				//	mdl = LinearModel.fit([D(:,j) temp], target(:,j), 'linear', 'Weights', weights);
-				//coef = LinearModelFitTwoIndependent(numPoints, target[c], values[c], temp);
+				//coef = LinearModelFitTwoIndependent(numPoints, target[c], values[c], temp, coefBuffer);
 #ifdef ENABLE_GSL
-				coef = LinearModelFitTwoIndependentWeighted(numPoints, target[c], values[c], temp, weights);
+				coef = LinearModelFitTwoIndependentWeighted(numPoints, target[c], values[c], temp, weights, coefBuffer);
 #else
-				coef = LinearModelFitTwoIndependent(numPoints, target[c], values[c], temp);
-				//coef = LinearModelFitTwoIndependentWeightedApproximately(numPoints, target[c], values[c], temp, weights);
+				coef = LinearModelFitTwoIndependent(numPoints, target[c], values[c], temp, coefBuffer);
+				//coef = LinearModelFitTwoIndependentWeightedApproximately(numPoints, target[c], values[c], temp, weights, coefBuffer);
 #endif
 			}
 			else
 			{
 				//	mdl = LinearModel.fit([D(:,j)], target(:,j), 'linear', 'Weights', weights);
-				coef = LinearModelFitOneIndependent(numPoints, target[c], values[c]);
+				coef = LinearModelFitOneIndependent(numPoints, target[c], values[c], coefBuffer);
 			}
 
 			off[c] = coef[0];			// offset		= intersect
@@ -77,8 +77,8 @@ typedef struct
 // Find stationary points (using an interpolating player)
 omcalibrate_stationary_points_t *OmCalibrateFindStationaryPointsFromPlayer(omcalibrate_config_t *config, om_convert_player_t *player);
 
-// Find stationary points (using direct data)
-omcalibrate_stationary_points_t *OmCalibrateFindStationaryPointsFromData(omcalibrate_config_t *config, omdata_t *data);
+// Find stationary points (using direct data from a session, or the first session if NULL)
+omcalibrate_stationary_points_t *OmCalibrateFindStationaryPointsFromData(omcalibrate_config_t *config, omdata_t *data, omdata_session_t *session);
 
 // Free stationary points
 void OmCalibrateFreeStationaryPoints(omcalibrate_stationary_points_t *stationaryPoints);
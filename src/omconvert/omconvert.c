@@ -39,11 +39,14 @@
 	#define _CRT_SECURE_NO_WARNINGS
 	#define _CRT_NONSTDC_NO_WARNINGS // strdup
 	#define timegm _mkgmtime
+	#define gmtime_r(_t, _tm) (gmtime_s((_tm), (_t)) == 0 ? (_tm) : NULL)
 	#define strcasecmp _stricmp
+	#define fseeko _fseeki64
 	#define USE_FTIME
 #elif defined(__APPLE__)
 	#define USE_FTIME		// Remove if deprecated and don't need backwards-compatibility
 #else
+	#define _FILE_OFFSET_BITS 64	// WAV output over 2 GB on 32-bit systems with fseeko()
 	#define _BSD_SOURCE 	// This line (deprecated)...
 	#define _DEFAULT_SOURCE // ...or this line...
 	#include <features.h>	// ...and this line, are needed for timegm() in time.h on Linux
@@ -54,16 +57,38 @@
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <float.h>
 #include "omconvert.h"
 #include "exits.h"
 #include "omdata.h"
+#include "omstore.h"
 #include "omcalibrate.h"
 #include "wav.h"
+#include "resampler.h"
 
 #ifdef USE_FTIME
 #include <sys/timeb.h>
 #endif
 
+#ifdef _WIN32
+	#include "pthread-win32.h"
+#else
+	#include <pthread.h>
+#endif
+
+#ifndef NO_SIMD
+	#if defined(__AVX2__)
+		#include <immintrin.h>
+		#define OMCONVERT_AVX2
+	#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+		#define OMCONVERT_SSE2
+	#elif defined(__aarch64__) && defined(__ARM_NEON)
+		#include <arm_neon.h>
+		#define OMCONVERT_NEON
+	#endif
+#endif
+
 #define CONVERT_VERSION 1
 
 #define MAX_TIME_STRING 80 // 26
@@ -116,10 +141,10 @@ typedef struct
 	int stepOk;
 
 	// Overall stats
-	int countInvalid;
-	int countClipped;
-	int countClippedInput;
-	int countClippedOutput;
+	int64_t countInvalid;
+	int64_t countClipped;
+	int64_t countClippedInput;
+	int64_t countClippedOutput;
 
 } calc_t;
 
@@ -322,7 +347,7 @@ static int CalcInit(calc_t *calc, double sampleRate, double startTime, int numCh
 }
 
 
-static bool CalcAddValue(calc_t *calc, double* accel, double temp, char validity, int rawIndex)
+static bool CalcAddValue(calc_t *calc, double* accel, double temp, char validity, int64_t rawIndex)
 {
 	bool ok = true;
 	bool valid = (validity & 1) ? false : true;		 // Valid if not invalid(!)
@@ -345,6 +370,28 @@ static bool CalcAddValue(calc_t *calc, double* accel, double temp, char validity
 }
 
 
+// Add each sample of a block (validity from the block's masks)
+static bool CalcAddBlock(calc_t *calc, const om_convert_block_t *block, int numChannels)
+{
+	int n;
+	for (n = 0; n < block->count; n++)
+	{
+		double accel[OMDATA_MAX_CHANNELS + 1];
+		int c;
+		for (c = 0; c < numChannels; c++)
+		{
+			accel[c] = block->values[c][n];
+		}
+		char validity = 0;
+		if (block->invalid & ((uint64_t)1 << n)) { validity |= 0x01; }			// Invalid
+		if (block->clippedInput & ((uint64_t)1 << n)) { validity |= 0x02; }		// Input clipped
+		if (block->clippedOutput & ((uint64_t)1 << n)) { validity |= 0x04; }	// Output clipped
+		if (!CalcAddValue(calc, accel, block->temp[n], validity, block->rawIndex[n])) { return false; }
+	}
+	return true;
+}
+
+
 static void CalcClose(calc_t *calc)
 {
 	if (calc->svmOk) { SvmClose(&calc->svmStatus); }
@@ -450,6 +497,127 @@ static double CubicInterpolate(double v0, double v1, double v2, double v3, doubl
 }
 
 
+// Vector operations on om_convert_value_t for the block kernels (OMCONVERT_LANES values at a time)
+#if defined(OMCONVERT_AVX2) && defined(OMCONVERT_FLOAT32)
+	#define OMCONVERT_LANES 8
+	typedef __m256 om_convert_vector_t;
+	#define VLOAD(_p) _mm256_loadu_ps(_p)
+	#define VSTORE(_p, _v) _mm256_storeu_ps((_p), (_v))
+	#define VSET(_x) _mm256_set1_ps(_x)
+	#define VADD(_a, _b) _mm256_add_ps((_a), (_b))
+	#define VSUB(_a, _b) _mm256_sub_ps((_a), (_b))
+	#define VMUL(_a, _b) _mm256_mul_ps((_a), (_b))
+	#define VSELECTLT(_x, _y, _a, _b) _mm256_blendv_ps((_b), (_a), _mm256_cmp_ps((_x), (_y), _CMP_LT_OQ))	// (x < y) ? a : b
+#elif defined(OMCONVERT_AVX2)
+	#define OMCONVERT_LANES 4
+	typedef __m256d om_convert_vector_t;
+	#define VLOAD(_p) _mm256_loadu_pd(_p)
+	#define VSTORE(_p, _v) _mm256_storeu_pd((_p), (_v))
+	#define VSET(_x) _mm256_set1_pd(_x)
+	#define VADD(_a, _b) _mm256_add_pd((_a), (_b))
+	#define VSUB(_a, _b) _mm256_sub_pd((_a), (_b))
+	#define VMUL(_a, _b) _mm256_mul_pd((_a), (_b))
+	#define VSELECTLT(_x, _y, _a, _b) _mm256_blendv_pd((_b), (_a), _mm256_cmp_pd((_x), (_y), _CMP_LT_OQ))
+#elif defined(OMCONVERT_SSE2) && defined(OMCONVERT_FLOAT32)
+	#define OMCONVERT_LANES 4
+	typedef __m128 om_convert_vector_t;
+	#define VLOAD(_p) _mm_loadu_ps(_p)
+	#define VSTORE(_p, _v) _mm_storeu_ps((_p), (_v))
+	#define VSET(_x) _mm_set1_ps(_x)
+	#define VADD(_a, _b) _mm_add_ps((_a), (_b))
+	#define VSUB(_a, _b) _mm_sub_ps((_a), (_b))
+	#define VMUL(_a, _b) _mm_mul_ps((_a), (_b))
+	#define VSELECTLT(_x, _y, _a, _b) _mm_or_ps(_mm_and_ps(_mm_cmplt_ps((_x), (_y)), (_a)), _mm_andnot_ps(_mm_cmplt_ps((_x), (_y)), (_b)))
+#elif defined(OMCONVERT_SSE2)
+	#define OMCONVERT_LANES 2
+	typedef __m128d om_convert_vector_t;
+	#define VLOAD(_p) _mm_loadu_pd(_p)
+	#define VSTORE(_p, _v) _mm_storeu_pd((_p), (_v))
+	#define VSET(_x) _mm_set1_pd(_x)
+	#define VADD(_a, _b) _mm_add_pd((_a), (_b))
+	#define VSUB(_a, _b) _mm_sub_pd((_a), (_b))
+	#define VMUL(_a, _b) _mm_mul_pd((_a), (_b))
+	#define VSELECTLT(_x, _y, _a, _b) _mm_or_pd(_mm_and_pd(_mm_cmplt_pd((_x), (_y)), (_a)), _mm_andnot_pd(_mm_cmplt_pd((_x), (_y)), (_b)))
+#elif defined(OMCONVERT_NEON) && defined(OMCONVERT_FLOAT32)
+	#define OMCONVERT_LANES 4
+	typedef float32x4_t om_convert_vector_t;
+	#define VLOAD(_p) vld1q_f32(_p)
+	#define VSTORE(_p, _v) vst1q_f32((_p), (_v))
+	#define VSET(_x) vdupq_n_f32(_x)
+	#define VADD(_a, _b) vaddq_f32((_a), (_b))
+	#define VSUB(_a, _b) vsubq_f32((_a), (_b))
+	#define VMUL(_a, _b) vmulq_f32((_a), (_b))
+	#define VSELECTLT(_x, _y, _a, _b) vbslq_f32(vcltq_f32((_x), (_y)), (_a), (_b))
+#elif defined(OMCONVERT_NEON)
+	#define OMCONVERT_LANES 2
+	typedef float64x2_t om_convert_vector_t;
+	#define VLOAD(_p) vld1q_f64(_p)
+	#define VSTORE(_p, _v) vst1q_f64((_p), (_v))
+	#define VSET(_x) vdupq_n_f64(_x)
+	#define VADD(_a, _b) vaddq_f64((_a), (_b))
+	#define VSUB(_a, _b) vsubq_f64((_a), (_b))
+	#define VMUL(_a, _b) vmulq_f64((_a), (_b))
+	#define VSELECTLT(_x, _y, _a, _b) vbslq_f64(vcltq_f64((_x), (_y)), (_a), (_b))
+#endif
+
+
+// Block kernels: interpolate one channel over a block of samples, scaled (the same operations, in the same order, as the functions above -- several samples at a time)
+static void NearestInterpolateBlock(const om_convert_value_t *v1, const om_convert_value_t *v2, const om_convert_value_t *x, om_convert_value_t scale, om_convert_value_t *out, int count)
+{
+	int n = 0;
+#ifdef OMCONVERT_LANES
+	const om_convert_vector_t half = VSET(0.5), vscale = VSET(scale);
+	for (; n + OMCONVERT_LANES <= count; n += OMCONVERT_LANES)
+	{
+		VSTORE(out + n, VMUL(vscale, VSELECTLT(VLOAD(x + n), half, VLOAD(v1 + n), VLOAD(v2 + n))));
+	}
+#endif
+	for (; n < count; n++)
+	{
+		out[n] = (om_convert_value_t)(scale * NearestInterpolate(v1[n], v2[n], x[n]));
+	}
+}
+
+static void LinearInterpolateBlock(const om_convert_value_t *v1, const om_convert_value_t *v2, const om_convert_value_t *x, om_convert_value_t scale, om_convert_value_t *out, int count)
+{
+	int n = 0;
+#ifdef OMCONVERT_LANES
+	const om_convert_vector_t vscale = VSET(scale);
+	for (; n + OMCONVERT_LANES <= count; n += OMCONVERT_LANES)
+	{
+		om_convert_vector_t a = VLOAD(v1 + n);
+		om_convert_vector_t val = VADD(VMUL(VSUB(VLOAD(v2 + n), a), VLOAD(x + n)), a);
+		VSTORE(out + n, VMUL(vscale, val));
+	}
+#endif
+	for (; n < count; n++)
+	{
+		out[n] = (om_convert_value_t)(scale * LinearInterpolate(v1[n], v2[n], x[n]));
+	}
+}
+
+static void CubicInterpolateBlock(const om_convert_value_t *v0, const om_convert_value_t *v1, const om_convert_value_t *v2, const om_convert_value_t *v3, const om_convert_value_t *x, om_convert_value_t scale, om_convert_value_t *out, int count)
+{
+	int n = 0;
+#ifdef OMCONVERT_LANES
+	const om_convert_vector_t vscale = VSET(scale);
+	for (; n + OMCONVERT_LANES <= count; n += OMCONVERT_LANES)
+	{
+		om_convert_vector_t a0 = VLOAD(v0 + n), a1 = VLOAD(v1 + n), a2 = VLOAD(v2 + n), a3 = VLOAD(v3 + n), t = VLOAD(x + n);
+		om_convert_vector_t p = VSUB(VSUB(a3, a2), VSUB(a0, a1));
+		om_convert_vector_t q = VSUB(VSUB(a0, a1), p);
+		om_convert_vector_t r = VSUB(a2, a0);
+		om_convert_vector_t val = VADD(VADD(VADD(VMUL(VMUL(VMUL(p, t), t), t), VMUL(VMUL(q, t), t)), VMUL(r, t)), a1);
+		VSTORE(out + n, VMUL(vscale, val));
+	}
+#endif
+	for (; n < count; n++)
+	{
+		out[n] = (om_convert_value_t)(scale * CubicInterpolate(v0[n], v1[n], v2[n], v3[n], x[n]));
+	}
+}
+
+
 
 
 
@@ -475,118 +643,483 @@ void InterpolatorInit(interpolator_t *interpolator, char mode, omdata_t *data, o
 		{
 			interpolator->maxRange = seg->description.range;
 		}
+		interpolator->segmentCount++;
+	}
+
+	// Segments in order for searching
+	interpolator->time = -DBL_MAX;
+	interpolator->segmentFirst = interpolator->seg;
+	if (interpolator->segmentCount > 0)
+	{
+		interpolator->segments = (omdata_segment_t **)malloc(interpolator->segmentCount * sizeof(omdata_segment_t *));
+		interpolator->segmentPreviousSamples = (int64_t *)malloc(interpolator->segmentCount * sizeof(int64_t));
+		if (interpolator->segments == NULL || interpolator->segmentPreviousSamples == NULL)
+		{
+			free(interpolator->segments);
+			free(interpolator->segmentPreviousSamples);
+			interpolator->segments = NULL;
+			interpolator->segmentPreviousSamples = NULL;
+		}
+		else
+		{
+			int64_t previousSamples = 0;
+			int i = 0;
+			for (omdata_segment_t *seg = session->stream[streamIndex].segmentFirst; seg != NULL; seg = seg->segmentNext, i++)
+			{
+				interpolator->segments[i] = seg;
+				interpolator->segmentPreviousSamples[i] = previousSamples;
+				previousSamples += seg->description.numSamples;
+			}
+		}
 	}
 }
 
-// TODO: Currently this can only advance forwards (never backwards) -- as it's sorted, we could do a binary search for the nearest time
-void InterpolatorSeek(interpolator_t *interpolator, double t)
+#define INTERPOLATOR_FILTER_INPUTS 256		// Each block of filtered values spans this many input samples (times the down-sampling factor)...
+#define INTERPOLATOR_FILTER_WARMUP 32		// ...after first running the filter over this many (times the down-sampling factor)...
+#define INTERPOLATOR_FILTER_MARGIN 3		// ...and continues for this many more (times the down-sampling factor), so the values either side are in the block
+#define INTERPOLATOR_FILTER_MAX_RATIO 16	// Largest up- or down-sampling factor filtered
+#define INTERPOLATOR_FILTER_CAPACITY ((INTERPOLATOR_FILTER_WARMUP + INTERPOLATOR_FILTER_INPUTS + INTERPOLATOR_FILTER_MARGIN) * INTERPOLATOR_FILTER_MAX_RATIO)
+
+// Anti-aliased values of the current segment at the output rate, filtered in fixed-point a block at a time (each block from the same position, so the values do not depend on the order of seeking)
+typedef struct om_convert_filter_tag
 {
-	interpolator->clipped = false;
-	interpolator->valid = true;
+	int outputRate;							// (0 if not an integer rate)
+	bool warned;
+	omdata_segment_t *seg;					// Segment the rate ratio is for
+	int upSample;							// Rational rate ratio for the segment (0 if the segment is not filtered)
+	int downSample;
+	double delay;							// Group delay of the filter (input samples, at low frequencies)
+	int channels;
+	int block;								// Block of filtered values (-1 if none)
+	int first;								// Output index of the first filtered value
+	int count;								// Number of filtered values
+	int16_t *input;							// Input samples for the filter [][channels]
+	unsigned char *inputClipped;
+	int16_t *output;						// Filtered values [count][channels]
+	unsigned char *clipped;					// Whether the input at each filtered value was clipped
+	resampler_t resampler;
+} om_convert_filter_t;
+
+static void InterpolatorFilterInit(interpolator_t *interpolator, double outputRate)
+{
+	size_t inputs = INTERPOLATOR_FILTER_CAPACITY;
+	om_convert_filter_t *filter = (om_convert_filter_t *)calloc(1, sizeof(om_convert_filter_t));
+	if (filter != NULL)
+	{
+		filter->input = (int16_t *)malloc(inputs * OMDATA_MAX_CHANNELS * sizeof(int16_t));
+		filter->inputClipped = (unsigned char *)malloc(inputs);
+		filter->output = (int16_t *)malloc((inputs + 1) * OMDATA_MAX_CHANNELS * sizeof(int16_t));
+		filter->clipped = (unsigned char *)malloc(inputs + 1);
+	}
+	if (filter == NULL || filter->input == NULL || filter->inputClipped == NULL || filter->output == NULL || filter->clipped == NULL)
+	{
+		fprintf(stderr, "WARNING: Problem allocating the anti-aliasing filter (using cubic interpolation).\n");
+		if (filter != NULL) { free(filter->input); free(filter->inputClipped); free(filter->output); free(filter->clipped); }
+		free(filter);
+		return;
+	}
+	filter->outputRate = ((int)outputRate == outputRate) ? (int)outputRate : 0;
+	filter->block = -1;
+	interpolator->filter = filter;
+}
+
+static void InterpolatorFree(interpolator_t *interpolator)
+{
+	free(interpolator->segments);
+	free(interpolator->segmentPreviousSamples);
+	interpolator->segments = NULL;
+	interpolator->segmentPreviousSamples = NULL;
+	if (interpolator->filter != NULL)
+	{
+		free(interpolator->filter->input);
+		free(interpolator->filter->inputClipped);
+		free(interpolator->filter->output);
+		free(interpolator->filter->clipped);
+		free(interpolator->filter);
+		interpolator->filter = NULL;
+	}
+}
+
+// Rate ratio of a segment, returns whether its values are filtered (an integer rate with a small integer ratio to the output rate, and a filter for it)
+static bool InterpolatorFilterSegment(om_convert_filter_t *filter, omdata_segment_t *seg)
+{
+	if (filter->seg == seg) { return filter->upSample > 0; }
+	filter->seg = seg;
+	filter->upSample = 0;
+	filter->downSample = 0;
+	filter->block = -1;
+
+	int inputRate = (int)seg->description.sampleRate;
+	if (filter->outputRate <= 0 || inputRate <= 0 || inputRate != seg->description.sampleRate || inputRate == filter->outputRate) { return false; }
+	if (seg->description.channels <= 0 || seg->description.channels > OMDATA_MAX_CHANNELS || seg->description.channels > RESAMPLER_MAX_AXES) { return false; }
+	if (!resampler_init(&filter->resampler, inputRate, filter->outputRate, 0, seg->description.channels)
+		|| filter->resampler.upSample > INTERPOLATOR_FILTER_MAX_RATIO || filter->resampler.downSample > INTERPOLATOR_FILTER_MAX_RATIO)
+	{
+		if (!filter->warned) { fprintf(stderr, "NOTE: No anti-aliasing filter for %d Hz to %d Hz (using cubic interpolation).\n", inputRate, filter->outputRate); }
+		filter->warned = true;
+		return false;
+	}
+	filter->upSample = filter->resampler.upSample;
+	filter->downSample = filter->resampler.downSample;
+	filter->channels = seg->description.channels;
+
+	// Group delay at DC (sum(k * b[k]) / sum(b[k]) - sum(k * a[k]) / sum(a[k]), in intermediate samples) -- the filtered values are taken this much later to keep them aligned
+	double sumB = 0, sumKB = 0, sumA = 0, sumKA = 0;
+	int k;
+	for (k = 0; k < filter->resampler.numCoefficients; k++)
+	{
+		sumB += FILTER_TO_FLOAT(filter->resampler.B[k]); sumKB += k * FILTER_TO_FLOAT(filter->resampler.B[k]);
+		sumA += FILTER_TO_FLOAT(filter->resampler.A[k]); sumKA += k * FILTER_TO_FLOAT(filter->resampler.A[k]);
+	}
+	filter->delay = (sumB != 0 && sumA != 0) ? (sumKB / sumB - sumKA / sumA) / filter->upSample : 0;
+	return true;
+}
+
+// Filter a block of values of the segment
+static void InterpolatorFilterBlock(interpolator_t *interpolator, int block)
+{
+	om_convert_filter_t *filter = interpolator->filter;
+	omdata_segment_t *seg = filter->seg;
+	int channels = filter->channels;
+	int blockStart = block * INTERPOLATOR_FILTER_INPUTS * filter->downSample;
+	int start = blockStart - INTERPOLATOR_FILTER_WARMUP * filter->downSample;
+	int end = blockStart + (INTERPOLATOR_FILTER_INPUTS + INTERPOLATOR_FILTER_MARGIN) * filter->downSample;
+	if (end > seg->description.numSamples) { end = seg->description.numSamples; }
+
+	// (before the start of the segment, the first sample is repeated so that the filter settles on it)
+	int n;
+	for (n = start; n < end; n++)
+	{
+		filter->inputClipped[n - start] = OmDataGetValuesCached(interpolator->data, seg, (n > 0) ? n : 0, filter->input + (size_t)(n - start) * channels);
+	}
+
+	// Restart the filter at the start position (a multiple of the down-sampling factor, so the outputs are at the same positions for every block)
+	int total = 0;
+	size_t count;
+	resampler_init(&filter->resampler, filter->resampler.inFrequency, filter->resampler.outFrequency, 0, channels);
+	resampler_input(&filter->resampler, filter->input, end - start);
+	while ((count = resampler_output(&filter->resampler, filter->output + (size_t)total * channels, INTERPOLATOR_FILTER_CAPACITY - total)) > 0) { total += (int)count; }
+	for (n = 0; n < total; n++)
+	{
+		filter->clipped[n] = filter->inputClipped[n * filter->downSample / filter->upSample];
+	}
+	filter->first = start / filter->downSample * filter->upSample;
+	filter->count = total;
+	filter->block = block;
+}
+
+// Interpolate the filtered values at a fractional index of the segment, returns false if the segment is not filtered or the position is past the end of the filtered values
+static bool InterpolatorFilterValues(interpolator_t *interpolator, double index)
+{
+	om_convert_filter_t *filter = interpolator->filter;
+	if (!InterpolatorFilterSegment(filter, interpolator->seg)) { return false; }
+
+	// Position in the filtered values (later by the group delay)
+	int64_t last = ((int64_t)interpolator->seg->description.numSamples * filter->upSample + filter->downSample - 1) / filter->downSample - 1;
+	double position = (index + filter->delay) * filter->upSample / filter->downSample;
+	if (position > (double)last) { return false; }		// (no filtered value past the end of the data, left to the unfiltered values)
+	int64_t output = (int64_t)floor(position);
+	double prop = position - (double)output;
+	if (output < 0) { output = 0; prop = 0.0; }
+	int block = (int)(output / (INTERPOLATOR_FILTER_INPUTS * filter->upSample));
+	if (block != filter->block) { InterpolatorFilterBlock(interpolator, block); }
+	if (filter->count <= 0) { return false; }
+
+	// Values at (-1, 0, 1, 2) for the interpolation (as the unfiltered values, repeated at the ends)
+	int i = (int)(output - filter->first);
+	int z, c;
+	bool clipped = false;
+	for (z = 0; z < 4; z++)
+	{
+		int j = i + z - 1;
+		if (j < 0) { j = 0; }
+		if (j >= filter->count) { j = filter->count - 1; }
+		const int16_t *values = filter->output + (size_t)j * filter->channels;
+		for (c = 0; c < filter->channels; c++) { interpolator->values[z][c] = values[c]; }
+		if (z == 1 || z == 2) { clipped |= (filter->clipped[j] != 0); }
+	}
+	interpolator->prop = prop;
+	interpolator->clipped = clipped;
+	interpolator->cachedSeg = NULL;
+	return true;
+}
+
+// Move on to a segment
+static void InterpolatorSegment(interpolator_t *interpolator, omdata_segment_t *seg, int64_t previousSegmentSamples)
+{
+	interpolator->seg = seg;
+	interpolator->previousSegmentSamples = previousSegmentSamples;
+	if (interpolator->seg != NULL)
+	{
+		interpolator->scale = interpolator->seg->description.scaling;
+	}
+}
+
+// Search again for the segment of an earlier time (the first that ends at or after the time)
+static void InterpolatorSearchSegment(interpolator_t *interpolator, double t)
+{
+	interpolator->timeIndex = -1;
+	if (interpolator->segments == NULL)
+	{
+		InterpolatorSegment(interpolator, interpolator->segmentFirst, 0);
+		return;
+	}
+
+	int lo = 0, hi = interpolator->segmentCount;
+	while (lo < hi)
+	{
+		int mid = lo + (hi - lo) / 2;
+		if (interpolator->segments[mid]->endTime < t) { lo = mid + 1; } else { hi = mid; }
+	}
+	if (lo < interpolator->segmentCount)
+	{
+		InterpolatorSegment(interpolator, interpolator->segments[lo], interpolator->segmentPreviousSamples[lo]);
+	}
+	else
+	{
+		InterpolatorSegment(interpolator, NULL, interpolator->segmentPreviousSamples[lo - 1] + interpolator->segments[lo - 1]->description.numSamples);
+	}
+}
+
+// Skip many time indices by binary search (the last timestamp at or before the time, if it is a number of indices on)
+#define INTERPOLATOR_SKIP_LINEAR 8
+static void InterpolatorSearchTimeIndex(interpolator_t *interpolator, double t)
+{
+	omdata_segment_t *seg = interpolator->seg;
+	int lo = interpolator->timeIndex + INTERPOLATOR_SKIP_LINEAR;
+	if (lo >= seg->timestampCount || t < OmDataSegmentTimestamp(seg, lo).timestamp) { return; }
+	int hi = seg->timestampCount - 1;
+	while (lo < hi)
+	{
+		int mid = lo + (hi - lo + 1) / 2;
+		if (OmDataSegmentTimestamp(seg, mid).timestamp <= t) { lo = mid; } else { hi = mid - 1; }
+	}
+	interpolator->timeIndex = lo;
+}
+
+// Find the timestamps either side of a time (returns false if there is no data at that time)
+static bool InterpolatorLocate(interpolator_t *interpolator, double t, om_convert_plan_entry_t *entry)
+{
+	// Moving backwards, search for the segment again
+	if (t < interpolator->time)
+	{
+		InterpolatorSearchSegment(interpolator, t);
+	}
+	interpolator->time = t;
 
 	// Skip segment if needed
 	while (interpolator->seg != NULL && t > interpolator->seg->endTime)
 	{
-		interpolator->previousSegmentSamples += interpolator->seg->description.numSamples;
-		interpolator->seg = interpolator->seg->segmentNext;
+		InterpolatorSegment(interpolator, interpolator->seg->segmentNext, interpolator->previousSegmentSamples + interpolator->seg->description.numSamples);
 		interpolator->timeIndex = -1;
-		if (interpolator->seg != NULL)
-		{
-			interpolator->scale = interpolator->seg->description.scaling;
-		}
 	}
 
 	if (interpolator->seg != NULL && t >= interpolator->seg->startTime)
 	{
-		// Skip time indices if needed
-		while (interpolator->timeIndex + 1 < interpolator->seg->timestampCount && t >= interpolator->seg->timestamps[interpolator->timeIndex + 1].timestamp)
-		{
-			interpolator->timeIndex++;
-		}
-
 		// Check we're between two time indices
 		if (interpolator->seg->description.numSamples > 0)
 		{
-			int i1, i2;
-			double t1, t2;
-
-			if (interpolator->timeIndex >= 0 && interpolator->timeIndex < interpolator->seg->timestampCount)
-			{
-				i1 = interpolator->seg->timestamps[interpolator->timeIndex].sample;
-				t1 = interpolator->seg->timestamps[interpolator->timeIndex].timestamp;
-			}
-			else
+			// Skip time indices if needed (the timestamps either side of the current index are kept, rather than decoded for every sample)
+			InterpolatorSearchTimeIndex(interpolator, t);
+			for (;;)
 			{
-				i1 = 0;
-				t1 = interpolator->seg->startTime;
-			}
+				omdata_segment_t *seg = interpolator->seg;
+				om_convert_plan_entry_t *interval = &interpolator->interval;
+				if (interval->seg != seg || interval->timeIndex != interpolator->timeIndex)
+				{
+					interval->seg = seg;
+					interval->timeIndex = interpolator->timeIndex;
 
-			if (interpolator->timeIndex + 1 < interpolator->seg->timestampCount)
-			{
-				i2 = interpolator->seg->timestamps[interpolator->timeIndex + 1].sample;
-				t2 = interpolator->seg->timestamps[interpolator->timeIndex + 1].timestamp;
+					if (interpolator->timeIndex >= 0 && interpolator->timeIndex < seg->timestampCount)
+					{
+						omdata_segment_timestamp_t ts = OmDataSegmentTimestamp(seg, interpolator->timeIndex);
+						interval->i1 = ts.sample;
+						interval->t1 = ts.timestamp;
+					}
+					else
+					{
+						interval->i1 = 0;
+						interval->t1 = seg->startTime;
+					}
+
+					if (interpolator->timeIndex + 1 < seg->timestampCount)
+					{
+						omdata_segment_timestamp_t ts = OmDataSegmentTimestamp(seg, interpolator->timeIndex + 1);
+						interval->i2 = ts.sample;
+						interval->t2 = ts.timestamp;
+					}
+					else
+					{
+						interval->i2 = seg->description.numSamples - 1;
+						interval->t2 = seg->endTime;
+					}
+				}
+
+				if (interpolator->timeIndex + 1 < seg->timestampCount && t >= interval->t2)
+				{
+					interpolator->timeIndex++;
+					continue;
+				}
+
+				entry->i1 = interval->i1;
+				entry->t1 = interval->t1;
+				entry->i2 = interval->i2;
+				entry->t2 = interval->t2;
+				return true;
 			}
-			else
+		}
+		else
+		{
+			// Skip time indices if needed
+			while (interpolator->timeIndex + 1 < interpolator->seg->timestampCount && t >= OmDataSegmentTimestamp(interpolator->seg, interpolator->timeIndex + 1).timestamp)
 			{
-				i2 = interpolator->seg->description.numSamples - 1;
-				t2 = interpolator->seg->endTime;
+				interpolator->timeIndex++;
 			}
+		}
+	}
 
-			// Interpolate the timestamps here (don't think cubic is valid as the source points should be equidistant for that to be valid, so use linear)
-			double timeProp = (t2 - t1) != 0.0 ? (t - t1) / (t2 - t1) : 0.0;		// Linear interpolate in time (see note above)
-			double index = (i2 - i1) * timeProp + i1;	// Fractional index at that position
-			interpolator->sampleIndex = (int)index;		// Actual index (v1)
-			interpolator->prop = index - (int)index;	// Offset towards next value (v2)
+	// Invalid
+	return false;
+}
 
-//printf(">>> %f => %d . %f\n", index, interpolator->sampleIndex, interpolator->prop);
+// Plan entry for an output sample (from the current entry onwards, otherwise by binary search)
+static const om_convert_plan_entry_t *InterpolatorPlanEntry(interpolator_t *interpolator, int64_t sample)
+{
+	const om_convert_plan_stream_t *plan = interpolator->plan;
+	int i = interpolator->planCursor;
+	if (i < 0 || i >= plan->entryCount || plan->entries[i].firstSample > sample)
+	{
+		int lo = 0, hi = plan->entryCount - 1;
+		while (lo < hi)
+		{
+			int mid = lo + (hi - lo + 1) / 2;
+			if (plan->entries[mid].firstSample <= sample) { lo = mid; } else { hi = mid - 1; }
+		}
+		i = lo;
+	}
+	while (i + 1 < plan->entryCount && plan->entries[i + 1].firstSample <= sample) { i++; }
+	interpolator->planCursor = i;
+	return &plan->entries[i];
+}
 
-			// Have we got enough for (-1, 0, 1, 2)?
-			int idx[4];
+// Record the interpolation at the next output sample in the plan (a new entry only when it is between different timestamps)
+static void InterpolatorPlanRecord(interpolator_t *interpolator, int64_t sample, const om_convert_plan_entry_t *entry)
+{
+	om_convert_plan_stream_t *plan = interpolator->plan;
+	om_convert_plan_entry_t *last = (plan->entryCount > 0) ? &plan->entries[plan->entryCount - 1] : NULL;
+	if (last == NULL || last->seg != entry->seg || last->timeIndex != entry->timeIndex || last->valid != entry->valid)
+	{
+		if (plan->entryCount >= plan->entryCapacity)
+		{
+			int capacity = (plan->entryCapacity > 0) ? 2 * plan->entryCapacity : 1024;
+			om_convert_plan_entry_t *entries = (om_convert_plan_entry_t *)realloc(plan->entries, capacity * sizeof(om_convert_plan_entry_t));
+			if (entries == NULL) { fprintf(stderr, "WARNING: Problem growing the resampling plan (no longer recording).\n"); plan->failed = true; return; }
+			plan->entries = entries;
+			plan->entryCapacity = capacity;
+		}
+		plan->entries[plan->entryCount] = *entry;
+		plan->entries[plan->entryCount].firstSample = sample;
+		interpolator->planCursor = plan->entryCount;
+		plan->entryCount++;
+	}
+	plan->covered = sample + 1;
+}
 
-			idx[1] = interpolator->sampleIndex;				// v1 (@0)
+void InterpolatorSeek(interpolator_t *interpolator, double t, int64_t sample)
+{
+	om_convert_plan_entry_t located;
+	const om_convert_plan_entry_t *entry;
 
-			if (interpolator->sampleIndex >= 1)
-			{
-				idx[0] = interpolator->sampleIndex - 1;		// v0 (@-1)
-			}
-			else
-			{
-				idx[0] = idx[1];
-			}
+	interpolator->clipped = false;
+	interpolator->valid = true;
 
-			if (interpolator->sampleIndex + 1 < interpolator->seg->description.numSamples)
-			{
-				idx[2] = interpolator->sampleIndex + 1;		// v2 (@1)
-			}
-			else
-			{
-				idx[2] = idx[1];
-			}
+	if (interpolator->plan != NULL && sample < interpolator->plan->covered)
+	{
+		// Replay the timestamps from the plan
+		entry = InterpolatorPlanEntry(interpolator, sample);
+		if (entry->seg != interpolator->seg) { InterpolatorSegment(interpolator, entry->seg, entry->previousSegmentSamples); }
+		interpolator->timeIndex = entry->timeIndex;
+		interpolator->time = t;
+	}
+	else
+	{
+		located.valid = InterpolatorLocate(interpolator, t, &located);
+		located.seg = interpolator->seg;
+		located.previousSegmentSamples = interpolator->previousSegmentSamples;
+		located.timeIndex = interpolator->timeIndex;
+		entry = &located;
+
+		// Record the first pass over the samples
+		if (interpolator->plan != NULL && sample == interpolator->plan->covered && !interpolator->plan->failed) { InterpolatorPlanRecord(interpolator, sample, &located); }
+	}
 
-			if (interpolator->sampleIndex + 2 < interpolator->seg->description.numSamples)
-			{
-				idx[3] = interpolator->sampleIndex + 2;		// v3 (@2)
-			}
-			else
-			{
-				idx[3] = idx[2];
-			}
+	if (!entry->valid)
+	{
+		interpolator->valid = false;
+		return;
+	}
 
+	// Interpolate the timestamps here (don't think cubic is valid as the source points should be equidistant for that to be valid, so use linear)
+	double timeProp = (entry->t2 - entry->t1) != 0.0 ? (t - entry->t1) / (entry->t2 - entry->t1) : 0.0;		// Linear interpolate in time (see note above)
+	double index = (entry->i2 - entry->i1) * timeProp + entry->i1;	// Fractional index at that position
+	interpolator->sampleIndex = (int)index;		// Actual index (v1)
+	interpolator->prop = index - (int)index;	// Offset towards next value (v2)
 
-			// For each index (-1, 0, 1, 2), cache the underlying values (for the interpolator to work over)
-			int z;
-			for (z = 0; z < 4; z++)
-			{
-				char clipped = OmDataGetValues(interpolator->data, interpolator->seg, idx[z], interpolator->values[z]);
-				if (z == 1 || z == 2) { interpolator->clipped |= clipped; }
-			}
+//printf(">>> %f => %d . %f\n", index, interpolator->sampleIndex, interpolator->prop);
 
-			return;
-		}
+	// Anti-aliased values
+	if (interpolator->filter != NULL && InterpolatorFilterValues(interpolator, index)) { return; }
+
+	// Values already cached for this position
+	if (interpolator->cachedSeg == interpolator->seg && interpolator->cachedIndex == interpolator->sampleIndex)
+	{
+		interpolator->clipped = interpolator->cachedClipped;
+		return;
 	}
 
-	// Invalid
-	interpolator->valid = false;
+	// Have we got enough for (-1, 0, 1, 2)?
+	int idx[4];
+
+	idx[1] = interpolator->sampleIndex;				// v1 (@0)
+
+	if (interpolator->sampleIndex >= 1)
+	{
+		idx[0] = interpolator->sampleIndex - 1;		// v0 (@-1)
+	}
+	else
+	{
+		idx[0] = idx[1];
+	}
+
+	if (interpolator->sampleIndex + 1 < interpolator->seg->description.numSamples)
+	{
+		idx[2] = interpolator->sampleIndex + 1;		// v2 (@1)
+	}
+	else
+	{
+		idx[2] = idx[1];
+	}
+
+	if (interpolator->sampleIndex + 2 < interpolator->seg->description.numSamples)
+	{
+		idx[3] = interpolator->sampleIndex + 2;		// v3 (@2)
+	}
+	else
+	{
+		idx[3] = idx[2];
+	}
+
+
+	// For each index (-1, 0, 1, 2), cache the underlying values (for the interpolator to work over)
+	int z;
+	for (z = 0; z < 4; z++)
+	{
+		char clipped = OmDataGetValuesCached(interpolator->data, interpolator->seg, idx[z], interpolator->values[z]);
+		if (z == 1 || z == 2) { interpolator->clipped |= clipped; }
+	}
+	interpolator->cachedSeg = interpolator->seg;
+	interpolator->cachedIndex = interpolator->sampleIndex;
+	interpolator->cachedClipped = interpolator->clipped;
 }
 
 double InterpolatorValue(interpolator_t *interpolator, int subchannel, char *valid)
@@ -605,7 +1138,7 @@ double InterpolatorValue(interpolator_t *interpolator, int subchannel, char *val
 	
 	if (interpolator->mode == 1) { val = NearestInterpolate(interpolator->values[1][subchannel], interpolator->values[2][subchannel], interpolator->prop); }
 	else if (interpolator->mode == 2) { val = LinearInterpolate(interpolator->values[1][subchannel], interpolator->values[2][subchannel], interpolator->prop); }
-	else if (interpolator->mode == 3) { val = CubicInterpolate(interpolator->values[0][subchannel], interpolator->values[1][subchannel], interpolator->values[2][subchannel], interpolator->values[3][subchannel], interpolator->prop); }
+	else if (interpolator->mode == 3 || interpolator->mode == 4) { val = CubicInterpolate(interpolator->values[0][subchannel], interpolator->values[1][subchannel], interpolator->values[2][subchannel], interpolator->values[3][subchannel], interpolator->prop); }
 	else { val = 0.0; }
 
 	if (valid != NULL) { *valid = 1; }
@@ -632,7 +1165,8 @@ const char *TimeString(double t, char *buff)
 	static char staticBuffer[MAX_TIME_STRING] = { 0 };	// 2000-01-01 20:00:00.000|
 	if (buff == NULL) { buff = staticBuffer; }
 	time_t tn = (time_t)t;
-	struct tm *tmn = gmtime(&tn);
+	struct tm tmBuffer;
+	struct tm *tmn = gmtime_r(&tn, &tmBuffer);
 	float sec = tmn->tm_sec + (float)(t - (time_t)t);
 	sprintf(buff, "%04d-%02d-%02d %02d:%02d:%02d.%03d", 1900 + tmn->tm_year, tmn->tm_mon + 1, tmn->tm_mday, tmn->tm_hour, tmn->tm_min, (int)sec, (int)((sec - (int)sec) * 1000));
 	return buff;
@@ -720,26 +1254,55 @@ int OmConvertFindArrangement(om_convert_arrangement_t *arrangement, omconvert_se
 
 	// Clamp to record time if close
 	double limit = 15.000;
+	char timeString[MAX_TIME_STRING];
 	if (omdata->metadata.recordingStart < omdata->metadata.recordingStop && (omdata->metadata.recordingStop - omdata->metadata.recordingStart) > 2 * limit)
 	{
 		if (fabs(arrangement->startTime - omdata->metadata.recordingStart) < limit) 
 		{ 
 			arrangement->startTime = omdata->metadata.recordingStart; 
-			fprintf(stderr, "Clamping session to recording start time (%s)...\n", TimeString(omdata->metadata.recordingStart, NULL)); 
+			fprintf(stderr, "Clamping session to recording start time (%s)...\n", TimeString(omdata->metadata.recordingStart, timeString)); 
 		}
 		if (fabs(arrangement->endTime - omdata->metadata.recordingStop) < limit)
 		{
 			arrangement->endTime = omdata->metadata.recordingStop; 
-			fprintf(stderr, "Clamping session to recording stop time (%s)...\n", TimeString(omdata->metadata.recordingStop, NULL));
+			fprintf(stderr, "Clamping session to recording stop time (%s)...\n", TimeString(omdata->metadata.recordingStop, timeString));
 		}
 	}
 
+	// Restrict to the time window
+	if (settings->startTime > 0 && arrangement->startTime < settings->startTime)
+	{
+		arrangement->startTime = settings->startTime;
+	}
+	if (settings->stopTime > 0 && arrangement->endTime > settings->stopTime)
+	{
+		arrangement->endTime = settings->stopTime;
+	}
+	if (arrangement->endTime < arrangement->startTime) { arrangement->endTime = arrangement->startTime; }
+
 	arrangement->duration = arrangement->endTime - arrangement->startTime;
 
 	return 0;
 }
 
 
+om_convert_plan_t *OmConvertPlanCreate(void)
+{
+	return (om_convert_plan_t *)calloc(1, sizeof(om_convert_plan_t));
+}
+
+void OmConvertPlanFree(om_convert_plan_t *plan)
+{
+	if (plan == NULL) { return; }
+	int si;
+	for (si = 0; si < OMDATA_MAX_STREAM; si++)
+	{
+		free(plan->stream[si].entries);
+	}
+	free(plan->adc.entries);
+	free(plan);
+}
+
 void OmConvertPlayerInitialize(om_convert_player_t *player, om_convert_arrangement_t *arrangement, double sampleRate, char interpolate)
 {
 	omdata_session_t *session = arrangement->session;
@@ -766,10 +1329,10 @@ void OmConvertPlayerInitialize(om_convert_player_t *player, om_convert_arrangeme
 			player->sampleRate = arrangement->defaultRate;
 		}
 
-		player->numSamples = (int)(arrangement->duration * player->sampleRate + 0.5);
+		player->numSamples = (int64_t)(arrangement->duration * player->sampleRate + 0.5);
 	}
 
-	fprintf(stderr, "DEBUG: Session between t0=%f, t1=%f  ==>  %f seconds at %f Hz  ==> %d samples * %d channels\n", arrangement->startTime, arrangement->endTime, arrangement->duration, player->sampleRate, player->numSamples, arrangement->numChannels);
+	fprintf(stderr, "DEBUG: Session between t0=%f, t1=%f  ==>  %f seconds at %f Hz  ==> %lld samples * %d channels\n", arrangement->startTime, arrangement->endTime, arrangement->duration, player->sampleRate, (long long)player->numSamples, arrangement->numChannels);
 
 	// Start tracking each stream with an omdata_interpolator_t over each segment... (tracks up to four different index-timestamp pairs, advance converts time a fractional index point, then sample each sub-channel at that point)
 	int j;
@@ -777,11 +1340,32 @@ void OmConvertPlayerInitialize(om_convert_player_t *player, om_convert_arrangeme
 	{
 		int si = arrangement->streamIndexes[j];
 		InterpolatorInit(&player->segmentInterpolators[si], player->interpolate, arrangement->data, session, si);
+		if (player->interpolate == 4) { InterpolatorFilterInit(&player->segmentInterpolators[si], player->sampleRate); }
 	}
 
 	// ADC interpolator
 	InterpolatorInit(&player->adcInterpolator, 3, arrangement->data, session, 'l');
 
+	// Record or replay the arrangement's resampling plan (if it is for this rate)
+	om_convert_plan_t *plan = arrangement->plan;
+	if (plan != NULL && player->numSamples > 0)
+	{
+		if (plan->sampleRate <= 0)
+		{
+			plan->sampleRate = player->sampleRate;
+			plan->startTime = arrangement->startTime;
+		}
+		if (plan->sampleRate == player->sampleRate && plan->startTime == arrangement->startTime)
+		{
+			for (j = 0; j < arrangement->numStreamIndexes; j++)
+			{
+				int si = arrangement->streamIndexes[j];
+				player->segmentInterpolators[si].plan = &plan->stream[si];
+			}
+			player->adcInterpolator.plan = &plan->adc;
+		}
+	}
+
 
 	// Record the scale
 	int c;
@@ -804,7 +1388,7 @@ void OmConvertPlayerInitialize(om_convert_player_t *player, om_convert_arrangeme
 }
 
 
-int OmConvertPlayerRawIndexWithinSegment(om_convert_player_t *player, char channel)
+int64_t OmConvertPlayerRawIndexWithinSegment(om_convert_player_t *player, char channel)
 {
 	// Update the interpolator for each stream to the current time
 	int j;
@@ -819,7 +1403,8 @@ int OmConvertPlayerRawIndexWithinSegment(om_convert_player_t *player, char chann
 	return -1;
 }
 
-void OmConvertPlayerSeek(om_convert_player_t *player, int sample)
+// Move the interpolator for each stream (and the ADC) to the time of a sample
+static void OmConvertPlayerPosition(om_convert_player_t *player, int64_t sample)
 {
 	double t = player->arrangement->startTime + (sample / player->sampleRate);
 
@@ -828,9 +1413,14 @@ void OmConvertPlayerSeek(om_convert_player_t *player, int sample)
 	for (j = 0; j < player->arrangement->numStreamIndexes; j++)
 	{
 		int si = player->arrangement->streamIndexes[j];
-		InterpolatorSeek(&player->segmentInterpolators[si], t);
+		InterpolatorSeek(&player->segmentInterpolators[si], t, sample);
 	}
-	InterpolatorSeek(&player->adcInterpolator, t);
+	InterpolatorSeek(&player->adcInterpolator, t, sample);
+}
+
+void OmConvertPlayerSeek(om_convert_player_t *player, int64_t sample)
+{
+	OmConvertPlayerPosition(player, sample);
 
 	// Sample the sub-channels
 	int c;
@@ -861,20 +1451,178 @@ void OmConvertPlayerSeek(om_convert_player_t *player, int sample)
 	return;
 }
 
-double ParseTime(char *tstr)
+int OmConvertPlayerSeekBlock(om_convert_player_t *player, int64_t sample, om_convert_block_t *block)
 {
-	int index = 0;
-	char *token = NULL;
-	char *p;
-	char end = 0;
-	struct tm tm0 = { 0 };
-	int milli = 0;
-
-	memset(&tm0, 0, sizeof(tm0));
-
-	for (p = tstr; !end; p++)
+	int64_t remaining = player->numSamples - sample;
+	int count = (remaining < OMCONVERT_PLAYER_BLOCK) ? (remaining > 0 ? (int)remaining : 0) : OMCONVERT_PLAYER_BLOCK;
+	int numChannels = player->arrangement->numChannels;
+
+	block->start = sample;
+	block->count = count;
+	block->invalid = 0;
+	block->clippedInput = 0;
+	block->clippedOutput = 0;
+
+	// Source values (-1, 0, 1, 2) and position for each channel of each sample, for the block kernels
+	om_convert_value_t source[4][OMDATA_MAX_CHANNELS][OMCONVERT_PLAYER_BLOCK];
+	om_convert_value_t prop[OMDATA_MAX_CHANNELS][OMCONVERT_PLAYER_BLOCK];
+	om_convert_value_t adcSource[4][3][OMCONVERT_PLAYER_BLOCK];
+	om_convert_value_t adcProp[3][OMCONVERT_PLAYER_BLOCK];
+	int first = (player->interpolate >= 3) ? 0 : 1, last = (player->interpolate >= 3) ? 3 : 2;
+
+	int n;
+	for (n = 0; n < count; n++)
 	{
-		end = (*p == '\0');
+		OmConvertPlayerPosition(player, sample + n);
+		block->rawIndex[n] = OmConvertPlayerRawIndexWithinSegment(player, 'a');
+
+		// Gather the sub-channels (invalid channels interpolate to zero)
+		int c, z;
+		bool valid = true, clipped = false;
+		for (c = 0; c < numChannels; c++)
+		{
+			interpolator_t *interpolator = &player->segmentInterpolators[(int)player->arrangement->channelAssignment[c].stream];
+			int subchannel = player->arrangement->channelAssignment[c].subchannel;
+			if (!interpolator->valid || interpolator->seg == NULL || subchannel >= interpolator->seg->description.channels)
+			{
+				valid = false;
+				for (z = first; z <= last; z++) { source[z][c][n] = 0; }
+				prop[c][n] = 0.0;
+			}
+			else
+			{
+				for (z = first; z <= last; z++) { source[z][c][n] = interpolator->values[z][subchannel]; }
+				prop[c][n] = (om_convert_value_t)interpolator->prop;
+			}
+			clipped |= interpolator->clipped;
+		}
+		if (!valid) { block->invalid |= (uint64_t)1 << n; }
+		if (clipped) { block->clippedInput |= (uint64_t)1 << n; }
+
+		// Aux channels (the ADC interpolator only re-reads its values when it moves to another sector)
+		interpolator_t *adc = &player->adcInterpolator;
+		for (c = 0; c < 3; c++)
+		{
+			bool adcValid = adc->valid && adc->seg != NULL && c < adc->seg->description.channels;
+			for (z = 0; z < 4; z++) { adcSource[z][c][n] = adcValid ? adc->values[z][c] : 0; }
+			adcProp[c][n] = adcValid ? (om_convert_value_t)adc->prop : 0;
+		}
+	}
+
+	// Aux channels are always cubic interpolated
+	om_convert_value_t adcValues[3][OMCONVERT_PLAYER_BLOCK];
+	int c;
+	for (c = 0; c < 3; c++)
+	{
+		CubicInterpolateBlock(adcSource[0][c], adcSource[1][c], adcSource[2][c], adcSource[3][c], adcProp[c], 1.0, adcValues[c], count);
+		for (n = 0; n < count; n++) { block->aux[c][n] = (short)adcValues[c][n]; }
+	}
+	for (n = 0; n < count; n++)
+	{
+		// TODO: Cope with other temperature conversions
+		block->temp[n] = (om_convert_value_t)(((int)block->aux[2][n] * 150 - 20500) / 1000.0);
+	}
+
+	// Interpolate each channel over the block (the interpolation mode is the same for every stream)
+	for (c = 0; c < numChannels; c++)
+	{
+		om_convert_value_t scale = (om_convert_value_t)player->scale[c];
+		switch (player->interpolate)
+		{
+			case 1: NearestInterpolateBlock(source[1][c], source[2][c], prop[c], scale, block->values[c], count); break;
+			case 2: LinearInterpolateBlock(source[1][c], source[2][c], prop[c], scale, block->values[c], count); break;
+			case 3: case 4: CubicInterpolateBlock(source[0][c], source[1][c], source[2][c], source[3][c], prop[c], scale, block->values[c], count); break;
+			default: for (n = 0; n < count; n++) { block->values[c][n] = scale * 0; } break;
+		}
+	}
+
+	return count;
+}
+
+// Apply a calibration to the values of a block
+static void OmConvertBlockCalibrate(om_convert_block_t *block, const omcalibrate_calibration_t *calibration, int numChannels)
+{
+	int c, n;
+	for (c = 0; c < numChannels && c < OMCALIBRATE_AXES; c++)
+	{
+		om_convert_value_t *v = block->values[c];
+		const om_convert_value_t offset = (om_convert_value_t)calibration->offset[c], scale = (om_convert_value_t)calibration->scale[c];
+		const om_convert_value_t referenceTemperature = (om_convert_value_t)calibration->referenceTemperature, tempOffset = (om_convert_value_t)calibration->tempOffset[c];
+		for (n = 0; n < block->count; n++)
+		{
+			// Rescaling is:  v = (v + offset) * scale + (temp - referenceTemperature) * tempOffset
+			v[n] = (v[n] + offset) * scale + (block->temp[n] - referenceTemperature) * tempOffset;
+		}
+	}
+}
+
+int64_t OmConvertPlayerReadRange(om_convert_player_t *player, double t0, double t1, om_convert_range_t *buffers)
+{
+	// Samples in the range
+	double first = ceil((t0 - player->arrangement->startTime) * player->sampleRate);
+	double last = ceil((t1 - player->arrangement->startTime) * player->sampleRate);
+	int64_t start = (first > 0) ? (int64_t)first : 0;
+	int64_t end = (last < (double)player->numSamples) ? (int64_t)last : player->numSamples;
+	if (end - start > buffers->capacity) { end = start + buffers->capacity; }
+	buffers->firstSample = start;
+	if (end <= start) { return 0; }
+
+	om_convert_block_t *block = (om_convert_block_t *)malloc(sizeof(om_convert_block_t));
+	if (block == NULL) { fprintf(stderr, "ERROR: Problem allocating player block.\n"); return -1; }
+
+	int numChannels = player->arrangement->numChannels;
+	int64_t sample;
+	for (sample = start; sample < end; sample += block->count)
+	{
+		if (OmConvertPlayerSeekBlock(player, sample, block) <= 0) { break; }
+		if (end - sample < block->count) { block->count = (int)(end - sample); }
+		if (buffers->calibration != NULL) { OmConvertBlockCalibrate(block, buffers->calibration, numChannels); }
+
+		int64_t offset = sample - start;
+		int c, n;
+		for (c = 0; c < numChannels; c++)
+		{
+			if (buffers->values[c] != NULL) { for (n = 0; n < block->count; n++) { buffers->values[c][offset + n] = block->values[c][n]; } }
+		}
+		if (buffers->temp != NULL) { for (n = 0; n < block->count; n++) { buffers->temp[offset + n] = block->temp[n]; } }
+		if (buffers->validity != NULL)
+		{
+			for (n = 0; n < block->count; n++)
+			{
+				buffers->validity[offset + n] = ((block->invalid >> n) & 1) ? 0x01 : 0x00;
+				if ((block->clippedInput >> n) & 1) { buffers->validity[offset + n] |= 0x02; }
+			}
+		}
+	}
+
+	free(block);
+	return sample - start;
+}
+
+void OmConvertPlayerFree(om_convert_player_t *player)
+{
+	int si;
+	for (si = 0; si < OMDATA_MAX_STREAM; si++)
+	{
+		InterpolatorFree(&player->segmentInterpolators[si]);
+	}
+	InterpolatorFree(&player->adcInterpolator);
+}
+
+double ParseTime(char *tstr)
+{
+	int index = 0;
+	char *token = NULL;
+	char *p;
+	char end = 0;
+	struct tm tm0 = { 0 };
+	int milli = 0;
+
+	memset(&tm0, 0, sizeof(tm0));
+
+	for (p = tstr; !end; p++)
+	{
+		end = (*p == '\0');
 		if (token == NULL && *p >= '0' && *p <= '9')
 		{
 			token = p;
@@ -997,6 +1745,7 @@ int OmConvertRunWav(omconvert_settings_t *settings, calc_t *calc)
 		unsigned long samplesOffset = 0;
 		unsigned long samplesRemaining = wavInfo.numSamples;
 		double temp = 0.0;
+		om_convert_block_t block;
 		while (!feof(fp))
 		{
 			long offset = wavInfo.offset + ((sizeof(short) * wavInfo.chans) * samplesOffset);
@@ -1009,44 +1758,56 @@ int OmConvertRunWav(omconvert_settings_t *settings, calc_t *calc)
 			samplesOffset += samplesRead;
 			samplesRemaining -= samplesRead;
 
-			double values[MAX_CHANNELS];
-			for (i = 0; i < (int)samplesRead; i++)
+			for (i = 0; i < (int)samplesRead; i += block.count)
 			{
-				const short *v = buffer + i * wavInfo.chans;
-
-				// Auxiliary channel is last channel
-				int validity = 0;
-				if (wavInfo.chans > 3 && wavInfo.chans != 6)
+				block.start = samplesOffset + i;
+				block.count = ((int)samplesRead - i < OMCONVERT_PLAYER_BLOCK) ? ((int)samplesRead - i) : OMCONVERT_PLAYER_BLOCK;
+				block.invalid = 0;
+				block.clippedInput = 0;
+				block.clippedOutput = 0;
+
+				int n;
+				for (n = 0; n < block.count; n++)
 				{
-					uint16_t aux = v[wavInfo.chans - 1];
-					if (aux & WAV_AUX_UNAVAILABLE) { validity |= 0x01; }		// Invalid sample
-					if (aux & WAV_AUX_CLIPPING)
-					{ 
-						if (v[0] > -32768 && v[0] < 32767 && v[1] > -32768 && v[1] < 32767 && v[2] > -32768 && v[2] < 32767)
-						{
-							validity |= 0x02;	// Not clipped after calibration, must have been clipped before calibration
-						}
-						else
-						{
-							validity |= 0x04;	// Clipped after calibration, may have also been clipped before calibration.
+					const short *v = buffer + (i + n) * wavInfo.chans;
+					uint64_t bit = (uint64_t)1 << n;
+
+					// Auxiliary channel is last channel
+					if (wavInfo.chans > 3 && wavInfo.chans != 6)
+					{
+						uint16_t aux = v[wavInfo.chans - 1];
+						if (aux & WAV_AUX_UNAVAILABLE) { block.invalid |= bit; }		// Invalid sample
+						if (aux & WAV_AUX_CLIPPING)
+						{ 
+							if (v[0] > -32768 && v[0] < 32767 && v[1] > -32768 && v[1] < 32767 && v[2] > -32768 && v[2] < 32767)
+							{
+								block.clippedInput |= bit;	// Not clipped after calibration, must have been clipped before calibration
+							}
+							else
+							{
+								block.clippedOutput |= bit;	// Clipped after calibration, may have also been clipped before calibration.
+							}
 						}
+						// TODO: Update temperature 'temp'
 					}
-					// TODO: Update temperature 'temp'
-				}
 
-				// Scaling from metadata
-				for (int j = 0; j < activeChans; j++)
-				{
-					values[j] = v[j] * scale[j];
+					// Scaling from metadata
+					for (int j = 0; j < activeChans; j++)
+					{
+						block.values[j][n] = (om_convert_value_t)(v[j] * scale[j]);
+					}
+					block.temp[n] = (om_convert_value_t)temp;
+					block.rawIndex[n] = samplesOffset + i + n;
 				}
-				
-				if (!CalcAddValue(calc, values, temp, validity, samplesOffset + i))
+
+				if (!CalcAddBlock(calc, &block, activeChans))
 				{
 					fprintf(stderr, "ERROR: Problem writing calculations.\n");
 					retVal = EXIT_IOERR;
 					break;
 				}
 			}
+			if (retVal != EXIT_OK) { break; }
 		}
 	}
 
@@ -1059,13 +1820,473 @@ int OmConvertRunWav(omconvert_settings_t *settings, calc_t *calc)
 }
 
 
-int OmConvertRunConvert(omconvert_settings_t *settings, calc_t *calc)
+// Output file name for a session: any "{n}" is replaced with the session number, otherwise sessions after the first have ".s<n>" inserted before the extension (e.g. "out.wav" and "out.s2.wav"); returns an allocated string (NULL if no file name)
+static char *OmConvertSessionFilename(const char *filename, int sessionNumber)
+{
+	char number[16];
+	char *result;
+
+	if (filename == NULL) { return NULL; }
+	sprintf(number, "%d", sessionNumber);
+
+	if (strstr(filename, "{n}") != NULL)
+	{
+		// Replace each "{n}" with the session number
+		const char *p;
+		size_t length = 1;
+		for (p = filename; *p != '\0'; )
+		{
+			if (strncmp(p, "{n}", 3) == 0) { length += strlen(number); p += 3; }
+			else { length++; p++; }
+		}
+		result = (char *)malloc(length);
+		if (result == NULL) { return NULL; }
+		result[0] = '\0';
+		for (p = filename; *p != '\0'; )
+		{
+			if (strncmp(p, "{n}", 3) == 0) { strcat(result, number); p += 3; }
+			else { size_t len = strlen(result); result[len] = *p; result[len + 1] = '\0'; p++; }
+		}
+		return result;
+	}
+
+	result = (char *)malloc(strlen(filename) + strlen(number) + 3);
+	if (result == NULL) { return NULL; }
+	if (sessionNumber <= 1 || filename[0] == '\0')
+	{
+		strcpy(result, filename);
+		return result;
+	}
+
+	// Insert before the extension, the last '.' of the base name (or append if none)
+	const char *base = filename;
+	const char *p;
+	for (p = filename; *p != '\0'; p++) { if (*p == '/' || *p == '\\') { base = p + 1; } }
+	const char *dot = strrchr(base, '.');
+	if (dot == NULL || dot == base) { dot = base + strlen(base); }
+	memcpy(result, filename, dot - filename);
+	sprintf(result + (dot - filename), ".s%s%s", number, dot);
+	return result;
+}
+
+
+#define OMCONVERT_SESSION_FILENAMES 11
+#define OMCONVERT_WAV_CACHE (1024 * 1024)
+#define OMCONVERT_WAV_MAX_DATA (0xffffffffull - 2048)	// WAV chunk sizes are 32-bit (less the headers)
+
+// Conversion of a single session
+typedef struct
+{
+	int sessionNumber;				// 1-based
+	omdata_session_t *session;
+	omconvert_settings_t settings;	// Copy of the settings with the output file names for this session
+	char *filenames[OMCONVERT_SESSION_FILENAMES];	// Allocated file names
+	calc_t calc;
+	int result;
+} om_convert_session_t;
+
+// Session conversions shared between the workers
+typedef struct
+{
+	omdata_t *omdata;
+	const char *artist;
+	const char *name;
+	om_convert_session_t *sessions;
+	int sessionCount;
+	int nextSession;
+	pthread_mutex_t mutex;
+} om_convert_sessions_t;
+
+// Session conversion worker (each has its own reader over the loaded data)
+typedef struct
+{
+	om_convert_sessions_t *sessions;
+	omdata_t *data;
+	omdata_t reader;
+	pthread_t thread;
+	bool started;
+} om_convert_session_worker_t;
+
+#define OMCONVERT_CHUNK_BLOCKS 64		// Player blocks generated by a chunk worker at a time (4096 samples)
+
+// Output of a session generated in chunks by several workers
+typedef struct
+{
+	om_convert_arrangement_t *arrangement;
+	const omcalibrate_calibration_t *calibration;
+	const float *outputScale;
+	double sampleRate;
+	char interpolate;
+	int64_t outputSamples;
+	int64_t chunkCount;
+	const char *outFilename;		// WAV file to write the frames to (NULL if none)
+	long long dataOffset;			// Offset of the first frame in the WAV file
+	bool feedCalc;					// Chunks are held in the slots until the calculations have consumed them in order
+	om_convert_block_t *slots;		// slotCount chunks of blocks
+	int64_t *slotChunk;				// Chunk completed in each slot (-1 if none)
+	int *slotBlocks;				// Number of blocks in each slot
+	int slotCount;
+	int64_t nextChunk;				// Next chunk to generate
+	int64_t consumedChunks;			// Chunks consumed by the calculations
+	int result;						// First failure
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+} om_convert_chunks_t;
+
+// Chunk worker (each has its own reader, player and output file handle)
+typedef struct
+{
+	om_convert_chunks_t *chunks;
+	omdata_t reader;
+	om_convert_arrangement_t arrangement;
+	om_convert_player_t player;
+	FILE *ofp;
+	unsigned char *frames;			// A chunk of WAV frames
+	om_convert_block_t *block;		// Block when not feeding the calculations
+	pthread_t thread;
+	bool started;
+} om_convert_chunk_worker_t;
+
+
+// Calibrate a player block and flag the samples that will clip in the output
+static void OmConvertBlockOutput(om_convert_block_t *block, const omcalibrate_calibration_t *calibration, const float *outputScale, int numChannels)
+{
+	int c, n;
+	OmConvertBlockCalibrate(block, calibration, numChannels);
+
+	// Output range scaled, saturated
+	for (c = 0; c < numChannels; c++)
+	{
+		for (n = 0; n < block->count; n++)
+		{
+			om_convert_value_t ov = block->values[c][n] * outputScale[c];
+			if (ov <= -32768.0 || ov >= 32767.0) { block->clippedOutput |= (uint64_t)1 << n; }	// Output clipped
+		}
+	}
+}
+
+// Convert an output block to WAV frames (each channel then the auxiliary channel), returns the number of bytes
+static int OmConvertBlockFrames(const om_convert_block_t *block, const float *outputScale, int numChannels, double sampleRate, unsigned char *frames)
+{
+	int c, n;
+	signed short *values = (signed short *)frames;
+	for (n = 0; n < block->count; n++, values += numChannels + 1)
+	{
+		uint64_t bit = (uint64_t)1 << n;
+
+		// Convert to integers
+		for (c = 0; c < numChannels; c++)
+		{
+			om_convert_value_t ov = block->values[c][n] * outputScale[c];
+			if (ov <= -32768.0) { ov = -32768.0; }
+			if (ov >= 32767.0) { ov = 32767.0; }
+			values[c] = (signed short)(ov);
+		}
+
+		// Auxiliary channel
+		uint16_t aux = 0;
+		if (block->invalid & bit) { aux |= WAV_AUX_UNAVAILABLE; }
+		if ((block->clippedInput | block->clippedOutput) & bit) { aux |= WAV_AUX_CLIPPING; }
+
+		int cycle = (int)((block->start + n) % (int)sampleRate);
+		if (cycle == 0) { aux |= WAV_AUX_SENSOR_BATTERY | (block->aux[0][n] & 0x3ff); }
+		if (cycle == 1) { aux |= WAV_AUX_SENSOR_LIGHT | (block->aux[1][n] & 0x3ff); }
+		if (cycle == 2) { aux |= WAV_AUX_SENSOR_TEMPERATURE | (block->aux[2][n] & 0x3ff); }
+
+		values[numChannels] = aux;
+	}
+	return block->count * (numChannels + 1) * (int)sizeof(int16_t);
+}
+
+// Generate the next unclaimed chunk until there are none left
+static void *OmConvertChunkWorker(void *arg)
+{
+	om_convert_chunk_worker_t *worker = (om_convert_chunk_worker_t *)arg;
+	om_convert_chunks_t *chunks = worker->chunks;
+	int numChannels = worker->arrangement.numChannels;
+	int frameBytes = (numChannels + 1) * sizeof(int16_t);
+
+	pthread_mutex_lock(&chunks->mutex);
+	for (;;)
+	{
+		// Wait for a free slot
+		while (chunks->result == EXIT_OK && chunks->feedCalc && chunks->nextChunk < chunks->chunkCount && chunks->nextChunk >= chunks->consumedChunks + chunks->slotCount)
+		{
+			pthread_cond_wait(&chunks->cond, &chunks->mutex);
+		}
+		if (chunks->result != EXIT_OK || chunks->nextChunk >= chunks->chunkCount) { break; }
+		int64_t chunk = chunks->nextChunk++;
+		pthread_mutex_unlock(&chunks->mutex);
+
+		int slot = (int)(chunk % chunks->slotCount);
+		int64_t start = chunk * OMCONVERT_CHUNK_BLOCKS * OMCONVERT_PLAYER_BLOCK;
+		int64_t sample = start;
+		int result = EXIT_OK;
+		int b;
+		for (b = 0; b < OMCONVERT_CHUNK_BLOCKS && sample < chunks->outputSamples; b++)
+		{
+			om_convert_block_t *block = chunks->feedCalc ? &chunks->slots[(size_t)slot * OMCONVERT_CHUNK_BLOCKS + b] : worker->block;
+			if (OmConvertPlayerSeekBlock(&worker->player, sample, block) <= 0) { break; }
+			OmConvertBlockOutput(block, chunks->calibration, chunks->outputScale, numChannels);
+			if (worker->ofp != NULL) { OmConvertBlockFrames(block, chunks->outputScale, numChannels, chunks->sampleRate, worker->frames + (size_t)(sample - start) * frameBytes); }
+			sample += block->count;
+		}
+
+		// Write the frames at their position in the file
+		if (worker->ofp != NULL)
+		{
+			if (fseeko(worker->ofp, chunks->dataOffset + (long long)start * frameBytes, SEEK_SET) != 0 || fwrite(worker->frames, frameBytes, (size_t)(sample - start), worker->ofp) != (size_t)(sample - start))
+			{
+				fprintf(stderr, "ERROR: Problem writing output.\n");
+				result = EXIT_IOERR;
+			}
+		}
+		if (chunk % 32 == 0) { fprintf(stderr, "."); }
+
+		pthread_mutex_lock(&chunks->mutex);
+		if (result != EXIT_OK && chunks->result == EXIT_OK) { chunks->result = result; }
+		if (chunks->feedCalc)
+		{
+			chunks->slotBlocks[slot] = b;
+			chunks->slotChunk[slot] = chunk;
+		}
+		pthread_cond_broadcast(&chunks->cond);
+	}
+	pthread_mutex_unlock(&chunks->mutex);
+	return NULL;
+}
+
+// Generate the session output with several workers, each with its own player over a chunk of the output, feeding the calculations in order
+static int OmConvertChunks(om_convert_chunks_t *chunks, omdata_t *omdata, calc_t *calc, int threads)
+{
+	om_convert_arrangement_t *arrangement = chunks->arrangement;
+	int i;
+
+	// The plan is only replayed (players record the samples they pass on their own)
+	if (arrangement->plan != NULL)
+	{
+		for (i = 0; i < OMDATA_MAX_STREAM; i++) { arrangement->plan->stream[i].failed = true; }
+		arrangement->plan->adc.failed = true;
+	}
+
+	chunks->chunkCount = (chunks->outputSamples + OMCONVERT_CHUNK_BLOCKS * OMCONVERT_PLAYER_BLOCK - 1) / (OMCONVERT_CHUNK_BLOCKS * OMCONVERT_PLAYER_BLOCK);
+	chunks->nextChunk = 0;
+	chunks->consumedChunks = 0;
+	chunks->result = EXIT_OK;
+	chunks->slotCount = 2 * threads;
+	if (chunks->feedCalc)
+	{
+		chunks->slots = (om_convert_block_t *)malloc((size_t)chunks->slotCount * OMCONVERT_CHUNK_BLOCKS * sizeof(om_convert_block_t));
+		chunks->slotChunk = (int64_t *)malloc(chunks->slotCount * sizeof(int64_t));
+		chunks->slotBlocks = (int *)calloc(chunks->slotCount, sizeof(int));
+		if (chunks->slots == NULL || chunks->slotChunk == NULL || chunks->slotBlocks == NULL) { chunks->result = EXIT_SOFTWARE; }
+		for (i = 0; chunks->slotChunk != NULL && i < chunks->slotCount; i++) { chunks->slotChunk[i] = -1; }
+	}
+	pthread_mutex_init(&chunks->mutex, NULL);
+	pthread_cond_init(&chunks->cond, NULL);
+
+	// Workers (the decoded sample cache is attached to the segments, so only the session's own reader may use it)
+	om_convert_chunk_worker_t *workers = (om_convert_chunk_worker_t *)calloc(threads, sizeof(om_convert_chunk_worker_t));
+	if (workers == NULL) { threads = 0; chunks->result = EXIT_SOFTWARE; }
+	int started = 0;
+	for (i = 0; i < threads && chunks->result == EXIT_OK; i++)
+	{
+		om_convert_chunk_worker_t *worker = &workers[i];
+		worker->chunks = chunks;
+		if (!OmDataOpenReader(&worker->reader, omdata, threads)) { continue; }
+		worker->reader.cacheBudget = 0;
+		worker->arrangement = *arrangement;
+		worker->arrangement.data = &worker->reader;
+		OmConvertPlayerInitialize(&worker->player, &worker->arrangement, chunks->sampleRate, chunks->interpolate);
+		if (chunks->outFilename != NULL)
+		{
+			worker->ofp = fopen(chunks->outFilename, "r+b");
+			worker->frames = (unsigned char *)malloc((size_t)OMCONVERT_CHUNK_BLOCKS * OMCONVERT_PLAYER_BLOCK * (arrangement->numChannels + 1) * sizeof(int16_t));
+		}
+		if (!chunks->feedCalc) { worker->block = (om_convert_block_t *)malloc(sizeof(om_convert_block_t)); }
+		if ((chunks->outFilename != NULL && (worker->ofp == NULL || worker->frames == NULL)) || (!chunks->feedCalc && worker->block == NULL))
+		{
+			fprintf(stderr, "ERROR: Cannot open output WAV file: %s\n", chunks->outFilename);
+			chunks->result = EXIT_CANTCREAT;
+		}
+		else
+		{
+			worker->started = (pthread_create(&worker->thread, NULL, OmConvertChunkWorker, worker) == 0);
+			if (worker->started) { started++; }
+		}
+	}
+	if (started == 0 && chunks->result == EXIT_OK) { chunks->result = EXIT_SOFTWARE; }
+
+	// Feed the calculations with the chunks in order
+	pthread_mutex_lock(&chunks->mutex);
+	int64_t chunk;
+	for (chunk = 0; chunks->feedCalc && chunk < chunks->chunkCount; chunk++)
+	{
+		int slot = (int)(chunk % chunks->slotCount);
+		while (chunks->result == EXIT_OK && chunks->slotChunk[slot] != chunk) { pthread_cond_wait(&chunks->cond, &chunks->mutex); }
+		if (chunks->result != EXIT_OK) { break; }
+		pthread_mutex_unlock(&chunks->mutex);
+
+		int result = EXIT_OK;
+		int b;
+		for (b = 0; b < chunks->slotBlocks[slot]; b++)
+		{
+			if (!CalcAddBlock(calc, &chunks->slots[(size_t)slot * OMCONVERT_CHUNK_BLOCKS + b], arrangement->numChannels))
+			{
+				fprintf(stderr, "ERROR: Problem writing calculations.\n");
+				result = EXIT_IOERR;
+				break;
+			}
+		}
+
+		pthread_mutex_lock(&chunks->mutex);
+		if (result != EXIT_OK && chunks->result == EXIT_OK) { chunks->result = result; }
+		chunks->slotChunk[slot] = -1;
+		chunks->consumedChunks = chunk + 1;
+		pthread_cond_broadcast(&chunks->cond);
+	}
+	if (chunks->result != EXIT_OK) { pthread_cond_broadcast(&chunks->cond); }
+	pthread_mutex_unlock(&chunks->mutex);
+
+	for (i = 0; i < threads; i++)
+	{
+		om_convert_chunk_worker_t *worker = &workers[i];
+		if (worker->started) { pthread_join(worker->thread, NULL); }
+		if (worker->ofp != NULL && fclose(worker->ofp) != 0 && chunks->result == EXIT_OK)
+		{
+			fprintf(stderr, "ERROR: Problem writing output.\n");
+			chunks->result = EXIT_IOERR;
+		}
+		free(worker->frames);
+		free(worker->block);
+		OmConvertPlayerFree(&worker->player);
+		if (worker->arrangement.data != NULL) { OmDataCloseReader(&worker->reader); }
+	}
+	free(workers);
+	pthread_cond_destroy(&chunks->cond);
+	pthread_mutex_destroy(&chunks->mutex);
+	free(chunks->slots);
+	free(chunks->slotChunk);
+	free(chunks->slotBlocks);
+	return chunks->result;
+}
+
+
+// Write the information about the conversion input
+static void OmConvertInfoInput(FILE *infofp, omconvert_settings_t *settings, omdata_t *omdata, const char *artist, const char *name)
+{
+	char timeString[MAX_TIME_STRING];
+	fprintf(infofp, "#:\n");
+	fprintf(infofp, "#::: Data about the input to the conversion process\n");
+	fprintf(infofp, "Result-file-version: %d\n", 1);
+	fprintf(infofp, "Convert-version: %d\n", CONVERT_VERSION);
+	fprintf(infofp, "Processed: %s\n", TimeString(TimeNow(), timeString));
+	fprintf(infofp, "File-input: %s\n", settings->filename);
+	fprintf(infofp, "Results-output: %s\n", (settings->infoFilename != NULL) ? settings->infoFilename : "");
+	fprintf(infofp, "Input-sectors-total: %d\n", omdata->statsTotalSectors);
+	if (!settings->metadataOnly)	// (the data sectors are not scanned)
+	{
+		fprintf(infofp, "Input-sectors-data: %d\n", omdata->statsDataSectors);
+		fprintf(infofp, "Input-sectors-bad: %d\n", omdata->statsBadSectors);
+	}
+	fprintf(infofp, "#:\n");
+	fprintf(infofp, "#::: Data about the device that made the recording\n");
+	fprintf(infofp, "%s", artist);
+	fprintf(infofp, "#:\n");
+	fprintf(infofp, "#::: Data about the recording itself\n");
+	fprintf(infofp, "%s", name);
+}
+
+
+// Write the integrity check report (issues in sector order, then a summary of each stream and of the file)
+static void OmConvertVerifyReport(FILE *fp, omdata_t *omdata)
+{
+	const omdata_verify_t *verify = omdata->verify;
+	char timeString[MAX_TIME_STRING];
+	int i;
+	fprintf(fp, "Type,Stream,Sector,Count,Time,Value\n");
+	for (i = 0; i < verify->issueCount; i++)
+	{
+		const omdata_issue_t *issue = &verify->issues[i];
+		if (issue->type == 'b') { fprintf(fp, "bad,,%d,%d,,\n", issue->sector, issue->count); continue; }
+		const char *type = (issue->type == 's') ? "break" : (issue->type == 'g') ? "gap" : "config";
+		fprintf(fp, "%s,%c,%d,%d,%s,%g\n", type, issue->stream, issue->sector, issue->count, TimeString(issue->time, timeString), issue->value);
+	}
+	int s;
+	for (s = 0; s < OMDATA_MAX_STREAM; s++)
+	{
+		const omdata_verify_stream_t *state = &verify->stream[s];
+		if (state->firstSector < 0) { continue; }
+		fprintf(fp, "stream,%c,%d,%d,%s,%f\n", s, state->firstSector, state->sectorCount, TimeString(state->firstTime, timeString), state->expectedTime - state->firstTime);
+	}
+	fprintf(fp, "total,,0,%d,,%d\n", omdata->statsTotalSectors, verify->badSectors);
+}
+
+
+// Write the information about the final state
+static void OmConvertInfoExit(FILE *infofp, int retVal)
+{
+	fprintf(infofp, "#:\n");
+	fprintf(infofp, "#::: Data about the final state\n");
+	fprintf(infofp, "Exit: %d\n", retVal);
+}
+
+
+// Write the side-channel values of each of the session's sectors (at their own rate, rather than through the player)
+static int OmConvertAuxExport(omconvert_settings_t *settings, omdata_t *omdata, omdata_session_t *session)
+{
+	FILE *fp = fopen(settings->auxFilename, "wt");
+	if (fp == NULL)
+	{
+		fprintf(stderr, "ERROR: Cannot open output aux file: %s\n", settings->auxFilename);
+		return EXIT_CANTCREAT;
+	}
+	if (settings->headerCsv) { fprintf(fp, "Time,Light,Temperature,Battery,Events\n"); }
+
+	int count = 0;
+	bool found = false;
+	omdata_segment_t *seg;
+	for (seg = session->stream['l'].segmentFirst; seg != NULL; seg = seg->segmentNext)
+	{
+		if (seg->description.packing != 0 || seg->description.channels != 3) { continue; }	// Only side-channel values in CWA sectors
+		found = true;
+		int i;
+		for (i = 0; i < seg->sectorCount; i++)
+		{
+			int sectorIndex = OmDataSegmentSector(seg, i);
+			double t = OmDataSectorStartTime(omdata, sectorIndex);
+			if (settings->startTime > 0 && t < settings->startTime) { continue; }
+			if (settings->stopTime > 0 && t >= settings->stopTime) { continue; }
+
+			int16_t values[3];
+			unsigned char events = 0;
+			OmDataSectorAux(omdata, sectorIndex, values, &events);
+
+			char timeString[MAX_TIME_STRING];
+			if (settings->timeCsv) { sprintf(timeString, "%.3f", t); } else { TimeString(t, timeString); }
+			double temp = ((int)values[2] * 150 - 20500) / 1000.0;	// As the player
+			double battery = values[0] * 6.0 / 1024;				// Volts
+			fprintf(fp, "%s,%d,%.2f,%.3f,%u\n", timeString, values[1], temp, battery, events);
+			count++;
+		}
+	}
+	fclose(fp);
+	if (!found) { fprintf(stderr, "WARNING: No light, temperature or battery values in the input (only CWA files have them), aux file has no values: %s\n", settings->auxFilename); }
+	fprintf(stderr, "Aux values written: %d\n", count);
+	return EXIT_OK;
+}
+
+
+// Convert a single session (reading through the given data, which may be a worker's reader)
+static int OmConvertSession(om_convert_session_t *convertSession, omdata_t *omdata, const char *artist, const char *name)
 {
 	int retVal = EXIT_OK;
-	omdata_t omdata = { 0 };
+	omconvert_settings_t *settings = &convertSession->settings;
+	omdata_session_t *session = convertSession->session;
+	calc_t *calc = &convertSession->calc;
 	om_convert_arrangement_t arrangement = { 0 };
 
-	if (!settings->calibrate && settings->stationaryFilename != NULL) { fprintf(stderr, "ERROR: Cannot output to stationary points file when not auto-calibrating.\n"); return EXIT_CONFIG; }
+	fprintf(stderr, "=== SESSION %d ===\n", convertSession->sessionNumber);
 
 	// Output information file
 	FILE *infofp = NULL;
@@ -1077,60 +2298,24 @@ int OmConvertRunConvert(omconvert_settings_t *settings, calc_t *calc)
 			fprintf(stderr, "ERROR: Cannot open output information file: %s\n", settings->infoFilename);
 			return EXIT_CANTCREAT;
 		}
+		OmConvertInfoInput(infofp, settings, omdata, artist, name);
 	}
-		
-	// Load input data
-	if (!OmDataLoad(&omdata, settings->filename))
-	{
-		const char *msg = "ERROR: Problem loading file.\n";
-		fprintf(stderr, "%s", msg);
-		fprintf(stdout, "%s", msg);
-		return EXIT_DATAERR;
-	}
-	fprintf(stderr, "Data loaded!\n");
-
-	OmDataDump(&omdata);
-
-	// Metadata - [Artist "IART" WAV chunk] Data about the device that made the recording
-	char artist[WAV_META_LENGTH] = { 0 };
-	sprintf(artist + strlen(artist), "Id: %u\n", omdata.metadata.deviceId);
-	sprintf(artist + strlen(artist), "Device: %s\n", omdata.metadata.deviceTypeString);
-	sprintf(artist + strlen(artist), "Revision: %d\n", omdata.metadata.deviceVersion);
-	sprintf(artist + strlen(artist), "Firmware: %d\n", omdata.metadata.firmwareVer);
-
-	// Metadata - [Title "INAM" WAV chunk] Data about the recording configuration
-	char clearTime[MAX_TIME_STRING] = { 0 };	// 2000-01-01 20:00:00.000|
-	char changeTime[MAX_TIME_STRING] = { 0 };	// 2000-01-01 20:00:00.000|
-	char startTime[MAX_TIME_STRING] = { 0 };	// 2000-01-01 20:00:00.000|
-	char stopTime[MAX_TIME_STRING] = { 0 };		// 2000-01-01 20:00:00.000|
-	char name[WAV_META_LENGTH] = { 0 };
-	sprintf(name + strlen(name), "Session: %u\n", (unsigned int)omdata.metadata.sessionId);
-	sprintf(name + strlen(name), "ClearTime: %s\n", TimeString(omdata.metadata.clearTime, clearTime));
-	sprintf(name + strlen(name), "ChangeTime: %s\n", TimeString(omdata.metadata.changeTime, changeTime));
-	sprintf(name + strlen(name), "Start: %s\n", TimeString(omdata.metadata.recordingStart, startTime));
-	sprintf(name + strlen(name), "Stop: %s\n", TimeString(omdata.metadata.recordingStop, stopTime));
-	sprintf(name + strlen(name), "Config-A: %d,%d\n", omdata.metadata.configAccel.frequency, omdata.metadata.configAccel.sensitivity);
-	sprintf(name + strlen(name), "Metadata: %s\n", omdata.metadata.metadata);
 
-	// Write other information to info file
-	if (infofp != NULL)
+	// Aux values do not need the player
+	if (settings->auxFilename != NULL)
 	{
-		fprintf(infofp, "#:\n");
-		fprintf(infofp, "#::: Data about the input to the conversion process\n");
-		fprintf(infofp, "Result-file-version: %d\n", 1);
-		fprintf(infofp, "Convert-version: %d\n", CONVERT_VERSION);
-		fprintf(infofp, "Processed: %s\n", TimeString(TimeNow(), NULL));
-		fprintf(infofp, "File-input: %s\n", settings->filename);
-		fprintf(infofp, "Results-output: %s\n", settings->infoFilename);
-		fprintf(infofp, "Input-sectors-total: %d\n", omdata.statsTotalSectors);
-		fprintf(infofp, "Input-sectors-data: %d\n", omdata.statsDataSectors);
-		fprintf(infofp, "Input-sectors-bad: %d\n", omdata.statsBadSectors);
-		fprintf(infofp, "#:\n");
-		fprintf(infofp, "#::: Data about the device that made the recording\n");
-		fprintf(infofp, "%s", artist);
-		fprintf(infofp, "#:\n");
-		fprintf(infofp, "#::: Data about the recording itself\n");
-		fprintf(infofp, "%s", name);
+		retVal = OmConvertAuxExport(settings, omdata, session);
+		bool otherOutput = settings->outFilename != NULL || settings->stationaryFilename != NULL || settings->csvFilename != NULL || settings->svmFilename != NULL || settings->wtvFilename != NULL
+			|| settings->paeeFilename != NULL || settings->sleepFilename != NULL || settings->agfilterFilename != NULL || settings->stepFilename != NULL;
+		if (retVal != EXIT_OK || !otherOutput)
+		{
+			if (infofp != NULL)
+			{
+				OmConvertInfoExit(infofp, retVal);
+				fclose(infofp);
+			}
+			return retVal;
+		}
 	}
 
 	// Calibration configuration
@@ -1138,7 +2323,6 @@ int OmConvertRunConvert(omconvert_settings_t *settings, calc_t *calc)
 	OmCalibrateConfigInit(&calibrateConfig);
 	calibrateConfig.stationaryTime = settings->stationaryTime; // 10.0;
 	calibrateConfig.stationaryRepeated = settings->repeatedStationary;
-	bool doneCalibration = false;
 	double errorBeforeCalibration = 0.0;
 	double errorAfterCalibration = 0.0;
 	double stationaryMin[3] = { 0 }, stationaryMax[3] = { 0 };
@@ -1148,207 +2332,208 @@ int OmConvertRunConvert(omconvert_settings_t *settings, calc_t *calc)
 	omcalibrate_calibration_t calibration;
 	OmCalibrateCopy(&calibration, settings->defaultCalibration);
 
-	// For each session:
-	omdata_session_t *session;
-	int sessionCount = 0;
-	for (session = omdata.firstSession; session != NULL; session = session->sessionNext)
-	{
-		sessionCount++;
-		fprintf(stderr, "=== SESSION %d ===\n", sessionCount);
+	// Find a configuration
+	OmConvertFindArrangement(&arrangement, settings, omdata, session, defaultChannelPriority);
 
-		if (sessionCount > 1)
+	// Calibrate now?
+	if (settings->calibrate)
+	{
+		// Find stationary points
+		// - If this is a CWA file with co-located temperature and accelerometer readings, use the data directly,
+		// - otherwise, use a 'player' to interpolate over the data.
+		omcalibrate_stationary_points_t *stationaryPoints;
+		bool calibrateFromData = (settings->calibrate != 0 && settings->calibrate != 2);
+		if (calibrateFromData && (!session->stream['a'].inUse || session->stream['a'].segmentFirst->description.offset != 30))
 		{
-			fprintf(stderr, "NOTE: Skipping session %d...\n", sessionCount);
-			continue;
+			calibrateFromData = false;
+			fprintf(stderr, "NOTE: Calibration requested directly from data, but an interpolator must be used instead.\n");
 		}
 
-		// Find a configuration
-		OmConvertFindArrangement(&arrangement, settings, &omdata, session, defaultChannelPriority);
-
-		// Calibrate now?
-		if (!doneCalibration && settings->calibrate)
+		if (calibrateFromData)
 		{
-			doneCalibration = true;
-
-			// Find stationary points
-			// - If this is a CWA file with co-located temperature and accelerometer readings, use the data directly,
-			// - otherwise, use a 'player' to interpolate over the data.
-			omcalibrate_stationary_points_t *stationaryPoints;
-			bool calibrateFromData = (settings->calibrate != 0 && settings->calibrate != 2);
-			if (calibrateFromData && (!omdata.stream['a'].inUse || omdata.stream['a'].segmentFirst->description.offset != 30))
-			{
-				calibrateFromData = false;
-				fprintf(stderr, "NOTE: Calibration requested directly from data, but an interpolator must be used instead.\n");
-			}
-
-			if (calibrateFromData)
-			{
-				fprintf(stderr, "Finding stationary points from data...\n");
-				stationaryPoints = OmCalibrateFindStationaryPointsFromData(&calibrateConfig, &omdata);
-			}
-			else
-			{
-				// Start a player
-				om_convert_player_t calibrationPlayer = { 0 };
-				OmConvertPlayerInitialize(&calibrationPlayer, &arrangement, settings->sampleRate, settings->interpolate);	// Initialize here for find stationary points
-				fprintf(stderr, "Finding stationary points from player...\n");
-				stationaryPoints = OmCalibrateFindStationaryPointsFromPlayer(&calibrateConfig, &calibrationPlayer);		// Player already initialized
-			}
+			fprintf(stderr, "Finding stationary points from data...\n");
+			stationaryPoints = OmCalibrateFindStationaryPointsFromData(&calibrateConfig, omdata, session);
+		}
+		else
+		{
+			// The output player replays the time interpolation of this pass
+			arrangement.plan = OmConvertPlanCreate();
+
+			// Start a player
+			om_convert_player_t calibrationPlayer = { 0 };
+			OmConvertPlayerInitialize(&calibrationPlayer, &arrangement, settings->sampleRate, settings->interpolate);	// Initialize here for find stationary points
+			fprintf(stderr, "Finding stationary points from player...\n");
+			stationaryPoints = OmCalibrateFindStationaryPointsFromPlayer(&calibrateConfig, &calibrationPlayer);		// Player already initialized
+			OmConvertPlayerFree(&calibrationPlayer);
+		}
 
-			fprintf(stderr, "Found stationary points: %d\n", stationaryPoints->numValues);
-			errorBeforeCalibration = OmCalibrateMeanSvmError(&calibration, stationaryPoints);
+		fprintf(stderr, "Found stationary points: %d\n", stationaryPoints->numValues);
+		errorBeforeCalibration = OmCalibrateMeanSvmError(&calibration, stationaryPoints);
 
-			// Dump no calibration
-			OmCalibrateDump(&calibration, stationaryPoints, 0);
+		// Dump no calibration
+		OmCalibrateDump(&calibration, stationaryPoints, 0);
 
-			// Auto-calibrate
-			fprintf(stderr, "Auto-calibrating...\n");
-			int calibrationResult = OmCalibrateFindAutoCalibration(&calibrateConfig, stationaryPoints, &calibration);
-			errorAfterCalibration = OmCalibrateMeanSvmError(&calibration, stationaryPoints);
-			OmCalibrateDump(&calibration, stationaryPoints, 1);
-			if (calibrationResult < 0)
-			{
-				fprintf(stderr, "Auto-calibration: using default calibration...\n");
-				int ec = calibration.errorCode;		// Copy error code
-				int na = calibration.numAxes;		// ...and num-axes
-				OmCalibrateCopy(&calibration, settings->defaultCalibration);
-				calibration.errorCode = ec;			// Copy error code to identity calibration
-				calibration.numAxes = na;			// ...and num-axes
-			}
+		// Auto-calibrate
+		fprintf(stderr, "Auto-calibrating...\n");
+		int calibrationResult = OmCalibrateFindAutoCalibration(&calibrateConfig, stationaryPoints, &calibration);
+		errorAfterCalibration = OmCalibrateMeanSvmError(&calibration, stationaryPoints);
+		OmCalibrateDump(&calibration, stationaryPoints, 1);
+		if (calibrationResult < 0)
+		{
+			fprintf(stderr, "Auto-calibration: using default calibration...\n");
+			int ec = calibration.errorCode;		// Copy error code
+			int na = calibration.numAxes;		// ...and num-axes
+			OmCalibrateCopy(&calibration, settings->defaultCalibration);
+			calibration.errorCode = ec;			// Copy error code to identity calibration
+			calibration.numAxes = na;			// ...and num-axes
+		}
 
-			// Find min/max x/y/z
-			stationaryCount = stationaryPoints->numValues;
-			FILE *sfp = NULL;
-			if (settings->stationaryFilename != NULL)
-			{
-				sfp = fopen(settings->stationaryFilename, "wt");
-				if (sfp == NULL) { fprintf(stderr, "WARNING: Couldn't write stationary points to file: %s\n", settings->stationaryFilename); }
-			}
-			int i;
-			for (i = 0; i < stationaryPoints->numValues; i++)
+		// Find min/max x/y/z
+		stationaryCount = stationaryPoints->numValues;
+		FILE *sfp = NULL;
+		if (settings->stationaryFilename != NULL)
+		{
+			sfp = fopen(settings->stationaryFilename, "wt");
+			if (sfp == NULL) { fprintf(stderr, "WARNING: Couldn't write stationary points to file: %s\n", settings->stationaryFilename); }
+		}
+		int i;
+		for (i = 0; i < stationaryPoints->numValues; i++)
+		{
+			char timestring[MAX_TIME_STRING];	// 2000-01-01 12:00:00.000\0
+			time_t tn = (time_t)stationaryPoints->values[i].time;
+			struct tm tmBuffer;
+			struct tm *tmn = gmtime_r(&tn, &tmBuffer);
+			float sec = tmn->tm_sec + (float)(stationaryPoints->values[i].time - (time_t)stationaryPoints->values[i].time);
+			sprintf(timestring, "%04d-%02d-%02d %02d:%02d:%02d", 1900 + tmn->tm_year, tmn->tm_mon + 1, tmn->tm_mday, tmn->tm_hour, tmn->tm_min, (int)sec);	// (int)((sec - (int)sec) * 1000)
+
+			//double temp = stationaryPoints->values[i].actualTemperature;
+			int c;
+			if (sfp != NULL) { fprintf(sfp, "%s", timestring); }
+			for (c = 0; c < OMCALIBRATE_AXES; c++)
 			{
-				char timestring[MAX_TIME_STRING];	// 2000-01-01 12:00:00.000\0
-				time_t tn = (time_t)stationaryPoints->values[i].time;
-				struct tm *tmn = gmtime(&tn);
-				float sec = tmn->tm_sec + (float)(stationaryPoints->values[i].time - (time_t)stationaryPoints->values[i].time);
-				sprintf(timestring, "%04d-%02d-%02d %02d:%02d:%02d", 1900 + tmn->tm_year, tmn->tm_mon + 1, tmn->tm_mday, tmn->tm_hour, tmn->tm_min, (int)sec);	// (int)((sec - (int)sec) * 1000)
-
-				//double temp = stationaryPoints->values[i].actualTemperature;
-				int c;
-				if (sfp != NULL) { fprintf(sfp, "%s", timestring); }
-				for (c = 0; c < OMCALIBRATE_AXES; c++)
-				{
-					double v = stationaryPoints->values[i].mean[c];
-					if (sfp != NULL) { fprintf(sfp, ",%.10f", v); }
-					if (i == 0 || v < stationaryMin[c]) { stationaryMin[c] = v; }
-					if (i == 0 || v > stationaryMax[c]) { stationaryMax[c] = v; }
-				}
-				if (sfp != NULL) { fprintf(sfp, ",%.10f", stationaryPoints->values[i].actualTemperature); }
-				if (sfp != NULL) { fprintf(sfp, "\n"); }
+				double v = stationaryPoints->values[i].mean[c];
+				if (sfp != NULL) { fprintf(sfp, ",%.10f", v); }
+				if (i == 0 || v < stationaryMin[c]) { stationaryMin[c] = v; }
+				if (i == 0 || v > stationaryMax[c]) { stationaryMax[c] = v; }
 			}
-			if (sfp != NULL) { fclose(sfp); }
-
-			// Free stationary points
-			OmCalibrateFreeStationaryPoints(stationaryPoints);
+			if (sfp != NULL) { fprintf(sfp, ",%.10f", stationaryPoints->values[i].actualTemperature); }
+			if (sfp != NULL) { fprintf(sfp, "\n"); }
 		}
+		if (sfp != NULL) { fclose(sfp); }
 
-		// Player for the session
-		om_convert_player_t player = { 0 };
-		OmConvertPlayerInitialize(&player, &arrangement, settings->sampleRate, settings->interpolate);
+		// Free stationary points
+		OmCalibrateFreeStationaryPoints(stationaryPoints);
+	}
 
-		// Channels, rate, samples
-		int outputChannels = arrangement.numChannels + 1;
-		int outputRate = (int)(player.sampleRate + 0.5);
-		int outputSamples = player.numSamples;
+	// Player for the session
+	om_convert_player_t player = { 0 };
+	OmConvertPlayerInitialize(&player, &arrangement, settings->sampleRate, settings->interpolate);
 
-		// Metadata - [Creation date "ICRD" WAV chunk] - Specify the time of the first sample (also in the comment for Matlab)
-		char datetime[WAV_META_LENGTH] = { 0 };
-		sprintf(datetime, "%s", TimeString(arrangement.startTime, NULL));
+	// Channels, rate, samples
+	int outputChannels = arrangement.numChannels + 1;
+	int outputRate = (int)(player.sampleRate + 0.5);
+	int64_t outputSamples = player.numSamples;
 
-		// Metadata - [Comment "ICMT" WAV chunk] Data about this file representation
-		char comment[WAV_META_LENGTH] = { 0 };
-		sprintf(comment + strlen(comment), "Time: %s\n", TimeString(arrangement.startTime, NULL));
+	// Metadata - [Creation date "ICRD" WAV chunk] - Specify the time of the first sample (also in the comment for Matlab)
+	char timeString[MAX_TIME_STRING];
+	char datetime[WAV_META_LENGTH] = { 0 };
+	sprintf(datetime, "%s", TimeString(arrangement.startTime, timeString));
 
-		// Output scaling
-		float outputScale[MAX_CHANNELS] = { 0 };
+	// Metadata - [Comment "ICMT" WAV chunk] Data about this file representation
+	char comment[WAV_META_LENGTH] = { 0 };
+	sprintf(comment + strlen(comment), "Time: %s\n", TimeString(arrangement.startTime, timeString));
 
-		// Sensor output range scales
-		int outputAccelRange = player.maxAccelRange;
-		if (outputAccelRange < 8) { outputAccelRange = 8; }		// Minimum +/-8g (+/-2g, +/-4g, +/-8g all coded as +/-8g)
+	// Output scaling
+	float outputScale[MAX_CHANNELS] = { 0 };
 
-		// TODO: Max gyro range from input data
-		int outputGyroRange = 2000;
+	// Sensor output range scales
+	int outputAccelRange = player.maxAccelRange;
+	if (outputAccelRange < 8) { outputAccelRange = 8; }		// Minimum +/-8g (+/-2g, +/-4g, +/-8g all coded as +/-8g)
 
-		// TODO: Max mag range from input data
-		int outputMagRange = 3277;
+	// TODO: Max gyro range from input data
+	int outputGyroRange = 2000;
 
-		// Metadata - channel assignment and scale
-		int chan = 0;
-		int axis;
-		for (axis = 0; axis < arrangement.numChannels; axis++)
-		{
-			char label[32] = "";
-			int range = 1;
+	// TODO: Max mag range from input data
+	int outputMagRange = 3277;
 
-			if (arrangement.channelAssignment[axis].stream == 'a') { 
-				sprintf(label, "Accel-%c", 'X' + arrangement.channelAssignment[axis].subchannel); 
-				range = outputAccelRange; 
-			} else if (arrangement.channelAssignment[axis].stream == 'g') {
-				sprintf(label, "Gyro-%c", 'X' + arrangement.channelAssignment[axis].subchannel);
-				range = outputGyroRange;
-			} else if (arrangement.channelAssignment[axis].stream == 'm') {
-				sprintf(label, "Mag-%c", 'X' + arrangement.channelAssignment[axis].subchannel);
-				range = outputMagRange;
-			} else {
-				sprintf(label, "%c%d", arrangement.channelAssignment[axis].stream, arrangement.channelAssignment[axis].subchannel);
-			}
+	// Metadata - channel assignment and scale
+	int chan = 0;
+	int axis;
+	for (axis = 0; axis < arrangement.numChannels; axis++)
+	{
+		char label[32] = "";
+		int range = 1;
+
+		if (arrangement.channelAssignment[axis].stream == 'a') { 
+			sprintf(label, "Accel-%c", 'X' + arrangement.channelAssignment[axis].subchannel); 
+			range = outputAccelRange; 
+		} else if (arrangement.channelAssignment[axis].stream == 'g') {
+			sprintf(label, "Gyro-%c", 'X' + arrangement.channelAssignment[axis].subchannel);
+			range = outputGyroRange;
+		} else if (arrangement.channelAssignment[axis].stream == 'm') {
+			sprintf(label, "Mag-%c", 'X' + arrangement.channelAssignment[axis].subchannel);
+			range = outputMagRange;
+		} else {
+			sprintf(label, "%c%d", arrangement.channelAssignment[axis].stream, arrangement.channelAssignment[axis].subchannel);
+		}
 
-			sprintf(comment + strlen(comment), "Channel-%d: %s\nScale-%d: %d\n", chan + 1, label, chan + 1, range);
+		sprintf(comment + strlen(comment), "Channel-%d: %s\nScale-%d: %d\n", chan + 1, label, chan + 1, range);
 
-			outputScale[chan] = 65536.0f / (2 * range);
-			chan++;
-		}
+		outputScale[chan] = 65536.0f / (2 * range);
+		chan++;
+	}
 
-		// Other axes
+	// Other axes
 fprintf(stderr, "COMMENT: %s\n", comment);
 //		???
 //Accelerometer scaling...
 
-		// Create output WAV file
-		FILE *ofp = NULL;
-		if (settings->outFilename != NULL && strlen(settings->outFilename) > 0)
+	// Create output WAV file
+	FILE *ofp = NULL;
+	unsigned char *cache = NULL;
+	int cachePosition = 0;
+	long long dataOffset = 0;
+	if (settings->outFilename != NULL && strlen(settings->outFilename) > 0)
+	{
+		fprintf(stderr, "Generating WAV file: %s\n", settings->outFilename);
+		ofp = fopen(settings->outFilename, "wb");
+		cache = (unsigned char *)malloc(OMCONVERT_WAV_CACHE);
+		if (ofp == NULL || cache == NULL)
+		{
+			fprintf(stderr, "Cannot open output WAV file: %s\n", settings->outFilename);
+			retVal = EXIT_CANTCREAT;
+		}
+		else if ((uint64_t)outputSamples * outputChannels * sizeof(int16_t) > OMCONVERT_WAV_MAX_DATA)
+		{
+			fprintf(stderr, "ERROR: Output too large for a WAV file (%lld samples * %d channels).\n", (long long)outputSamples, outputChannels);
+			retVal = EXIT_CONFIG;
+		}
+		else
 		{
-			fprintf(stderr, "Generating WAV file: %s\n", settings->outFilename);
-			ofp = fopen(settings->outFilename, "wb");
-			if (ofp == NULL)
-			{
-				fprintf(stderr, "Cannot open output WAV file: %s\n", settings->outFilename);
-				retVal = EXIT_CANTCREAT;
-				break;
-			}
-
 			WavInfo wavInfo = { 0 };
 			wavInfo.bytesPerChannel = 2;
 			wavInfo.chans = outputChannels;
 			wavInfo.freq = outputRate;
 			wavInfo.numSamples = outputSamples;
-			wavInfo.infoArtist = artist;
-			wavInfo.infoName = name;
+			wavInfo.infoArtist = (char *)artist;
+			wavInfo.infoName = (char *)name;
 			wavInfo.infoDate = datetime;
 			wavInfo.infoComment = comment;
 
 			// Try to start the data at 1k offset (create a dummy 'JUNK' header)
 			wavInfo.offset = 1024;
 
-			if (WavWrite(&wavInfo, ofp) <= 0)
+			dataOffset = WavWrite(&wavInfo, ofp);
+			if (dataOffset <= 0)
 			{
 				fprintf(stderr, "ERROR: Problem writing WAV file.\n");
 				retVal = EXIT_IOERR;
-				break;
 			}
 		}
+	}
 
-
+	if (retVal == EXIT_OK)
+	{
 		int outputOk = CalcInit(calc, player.sampleRate, player.arrangement->startTime, arrangement.numChannels);		// Whether any processing outputs are used
 
 		// Calculate each output sample between the start/end time of session
@@ -1356,7 +2541,6 @@ fprintf(stderr, "COMMENT: %s\n", comment);
 		{
 			fprintf(stderr, "ERROR: No output.\n");
 			retVal = EXIT_CONFIG;
-			break;
 		}
 		else
 		{
@@ -1385,148 +2569,350 @@ fprintf(stderr, "COMMENT: %s\n", comment);
 				fprintf(infofp, "Output-rate: %d\n", outputRate);
 				fprintf(infofp, "Output-channels: %d\n", outputChannels);
 				fprintf(infofp, "Output-duration: %f\n", (float)outputSamples / outputRate);
-				fprintf(infofp, "Output-samples: %d\n", outputSamples);
+				fprintf(infofp, "Output-samples: %lld\n", (long long)outputSamples);
 				fprintf(infofp, "Output-duration-invalid: %f\n", (float)calc->countInvalid / outputRate);
-				fprintf(infofp, "Output-samples-invalid: %d\n", calc->countInvalid);
+				fprintf(infofp, "Output-samples-invalid: %lld\n", (long long)calc->countInvalid);
 				fprintf(infofp, "Output-duration-clipped: %f\n", (float)calc->countClipped / outputRate);
-				fprintf(infofp, "Output-samples-clipped: %d\n", calc->countClipped);
-				fprintf(infofp, "Output-samples-clipped-before-calibration: %d\n", calc->countClippedInput);
-				fprintf(infofp, "Output-samples-clipped-after-calibration: %d\n", calc->countClippedOutput);
+				fprintf(infofp, "Output-samples-clipped: %lld\n", (long long)calc->countClipped);
+				fprintf(infofp, "Output-samples-clipped-before-calibration: %lld\n", (long long)calc->countClippedInput);
+				fprintf(infofp, "Output-samples-clipped-after-calibration: %lld\n", (long long)calc->countClippedOutput);
 
 				fprintf(infofp, "#:\n");
 				fprintf(infofp, "#::: Data about this file representation\n");
 				fprintf(infofp, "%s", comment);
 			}
 
-			signed short values[OMDATA_MAX_CHANNELS + 1];
-			int sample;
-			for (sample = 0; sample < outputSamples; sample++)
+			if (settings->threads > 1 && outputSamples > OMCONVERT_CHUNK_BLOCKS * OMCONVERT_PLAYER_BLOCK)
+			{
+				// Generate chunks of the output on several workers
+				om_convert_chunks_t chunks = { 0 };
+				chunks.arrangement = &arrangement;
+				chunks.calibration = &calibration;
+				chunks.outputScale = outputScale;
+				chunks.sampleRate = player.sampleRate;
+				chunks.interpolate = settings->interpolate;
+				chunks.outputSamples = outputSamples;
+				chunks.outFilename = (ofp != NULL) ? settings->outFilename : NULL;
+				chunks.dataOffset = dataOffset;
+				chunks.feedCalc = (outputOk != 0);
+				if (ofp != NULL && fflush(ofp) != 0)
+				{
+					fprintf(stderr, "ERROR: Problem writing output.\n");
+					retVal = EXIT_IOERR;
+				}
+				else
+				{
+					fprintf(stderr, "Generating output with %d threads...\n", settings->threads);
+					retVal = OmConvertChunks(&chunks, omdata, calc, settings->threads);
+				}
+			}
+			else
 			{
-				int rawIndex = 0;
-				OmConvertPlayerSeek(&player, sample);
-				rawIndex = OmConvertPlayerRawIndexWithinSegment(&player, 'a');
-
-				// Convert to integers
-				int c;
-				double temp = player.temp;
-				char validity = 0;
-				if (!player.valid) { validity |= 0x01; }		// Invalid
-				if (player.clipped) { validity |= 0x02; }		// Input clipped
-
-				double accel[MAX_CHANNELS];
-				for (c = 0; c < player.arrangement->numChannels; c++)
+				om_convert_block_t block;
+				int64_t sample;
+				int frameBytes = sizeof(int16_t) * (arrangement.numChannels + 1);
+				for (sample = 0; sample < outputSamples; sample += block.count)
 				{
-					double interpVal = player.values[c];
-					double v = player.scale[c] * interpVal;
-					
+					if (OmConvertPlayerSeekBlock(&player, sample, &block) <= 0) { break; }
+
 					// Apply calibration
-					if (c < OMCALIBRATE_AXES)
+					OmConvertBlockOutput(&block, &calibration, outputScale, player.arrangement->numChannels);
+
+					if (!CalcAddBlock(calc, &block, player.arrangement->numChannels))
 					{
-						// Rescaling is:  v = (v + offset) * scale + (temp - referenceTemperature) * tempOffset
-						v = (v + calibration.offset[c]) * calibration.scale[c] + (temp - calibration.referenceTemperature) * calibration.tempOffset[c];
+						fprintf(stderr, "ERROR: Problem writing calculations.\n");
+						retVal = EXIT_IOERR;
+						break;
 					}
 
-					if (c < MAX_CHANNELS)
+					// Output
+					if (ofp != NULL)
 					{
-						accel[c] = v;
+						cachePosition += OmConvertBlockFrames(&block, outputScale, player.arrangement->numChannels, player.sampleRate, cache + cachePosition);
+						if (cachePosition + OMCONVERT_PLAYER_BLOCK * frameBytes > OMCONVERT_WAV_CACHE || block.start + block.count >= outputSamples)
+						{
+							if (fwrite(cache, 1, cachePosition, ofp) != cachePosition)
+							{
+								fprintf(stderr, "ERROR: Problem writing output.\n");
+								retVal = EXIT_IOERR;
+								break;
+							}
+							cachePosition = 0;
+							fprintf(stderr, ".");
+						}
 					}
+				}
+			}
 
-					// Output range scaled
-					double ov = v * outputScale[c];
+		}
 
-					// Saturate
-					if (ov <= -32768.0) { ov = -32768.0; validity |= 0x04; }	// Output clipped
-					if (ov >= 32767.0) { ov = 32767.0; validity |= 0x04; }	// Output clipped
+		CalcClose(calc);
+	}
 
-					// Save
-					values[c] = (signed short)(ov);
-				}
+	if (ofp != NULL) { fclose(ofp); }
+	free(cache);
+	OmConvertPlayerFree(&player);
+	OmConvertPlanFree(arrangement.plan);
 
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Finished.\n");
 
-				// Auxiliary channel
-				uint16_t aux = 0;
-				if (validity & 0x01) { aux |= WAV_AUX_UNAVAILABLE; }
-				if (validity & 0x06) { aux |= WAV_AUX_CLIPPING; }
+	if (infofp != NULL)
+	{
+		// Write other information to info file
+		OmConvertInfoExit(infofp, retVal);
+		fclose(infofp);
+	}
 
-				int cycle = sample % (int)player.sampleRate;
-				if (cycle == 0) { aux |= WAV_AUX_SENSOR_BATTERY | (player.aux[0] & 0x3ff); }
-				if (cycle == 1) { aux |= WAV_AUX_SENSOR_LIGHT | (player.aux[1] & 0x3ff); }
-				if (cycle == 2) { aux |= WAV_AUX_SENSOR_TEMPERATURE | (player.aux[2] & 0x3ff); }
+	return retVal;
+}
 
-				//player.settings.auxChannel
 
-				values[player.arrangement->numChannels] = aux;
+// Convert the next unclaimed session until there are none left
+static void *OmConvertSessionWorker(void *arg)
+{
+	om_convert_session_worker_t *worker = (om_convert_session_worker_t *)arg;
+	om_convert_sessions_t *sessions = worker->sessions;
+	for (;;)
+	{
+		pthread_mutex_lock(&sessions->mutex);
+		int index = sessions->nextSession++;
+		pthread_mutex_unlock(&sessions->mutex);
+		if (index >= sessions->sessionCount) { break; }
 
-				if (!CalcAddValue(calc, accel, temp, validity, rawIndex))
-				{
-					fprintf(stderr, "ERROR: Problem writing calculations.\n");
-					retVal = EXIT_IOERR;
-					break;
-				}
+		om_convert_session_t *convertSession = &sessions->sessions[index];
+		convertSession->result = OmConvertSession(convertSession, worker->data, sessions->artist, sessions->name);
+	}
+	return NULL;
+}
 
-#if 0
-				// TEMPORARY: Write SVM (before filtering) to fourth channel
-				double outSvm = svm * 4096.0;
-				if (outSvm < -32768.0) { outSvm = -32768.0; }
-				if (outSvm > 32767.0) { outSvm = 32767.0; }
-				values[player.arrangement->numChannels] = (signed short)outSvm;
-#endif
 
-				// Output
-				//for (c = 0; c < numChannels + 1; c++) { printf("%s%d", (c > 0) ? "," : "", values[c]); }
-				//printf("\n");
+int OmConvertRunConvert(omconvert_settings_t *settings)
+{
+	int retVal = EXIT_OK;
+	omdata_t omdata = { 0 };
 
-				if (ofp != NULL)
-				{
-					int bytesToWrite = sizeof(int16_t) * (arrangement.numChannels + 1);
-					static unsigned char cache[1024 * 1024];		// TODO: Don't do this - not thread safe
-					static int cachePosition = 0;					// ...or this...
+	if (!settings->calibrate && settings->stationaryFilename != NULL) { fprintf(stderr, "ERROR: Cannot output to stationary points file when not auto-calibrating.\n"); return EXIT_CONFIG; }
 
-					memcpy(cache + cachePosition, values, bytesToWrite);
-					cachePosition += bytesToWrite;
-					if (cachePosition + bytesToWrite >= sizeof(cache) || sample + 1 >= outputSamples)
-					{
-						if (fwrite(cache, 1, cachePosition, ofp) != cachePosition)
-						{
-							fprintf(stderr, "ERROR: Problem writing output.\n");
-							retVal = EXIT_IOERR;
-							break;
-						}
-						cachePosition = 0;
-						fprintf(stderr, ".");
-					}
-				}
-			}
+	// Load input data
+	omdata_config_t dataConfig;
+	OmDataConfigInit(&dataConfig);
+	dataConfig.threads = settings->threads;
+	dataConfig.index = settings->index;
+	dataConfig.io = (omdata_io_t)settings->io;
+	dataConfig.memoryBudget = (size_t)settings->memoryBudget * 1024 * 1024;
+	dataConfig.cacheBudget = (size_t)settings->cacheBudget * 1024 * 1024;
+	dataConfig.startTime = settings->startTime;
+	dataConfig.stopTime = settings->stopTime;
+	dataConfig.metadataOnly = settings->metadataOnly;
+	dataConfig.verify = (settings->verifyFilename != NULL);
+	if (!OmDataLoad(&omdata, settings->filename, &dataConfig))
+	{
+		const char *msg = "ERROR: Problem loading file.\n";
+		fprintf(stderr, "%s", msg);
+		fprintf(stdout, "%s", msg);
+		return EXIT_DATAERR;
+	}
+	fprintf(stderr, "Data loaded!\n");
 
+	// Only the integrity check report
+	if (omdata.verify != NULL)
+	{
+		const omdata_verify_t *verify = omdata.verify;
+		fprintf(stderr, "Verified: %d data sectors, %d bad sectors, %d issues.\n", verify->dataSectors, verify->badSectors, verify->issueCount);
+		if (verify->dataSectors <= 0) { fprintf(stderr, "ERROR: No data.\n"); retVal = EXIT_DATAERR; }
+		FILE *fp = fopen(settings->verifyFilename, "wt");
+		if (fp == NULL)
+		{
+			fprintf(stderr, "ERROR: Cannot open output verification file: %s\n", settings->verifyFilename);
+			retVal = EXIT_CANTCREAT;
 		}
+		else
+		{
+			OmConvertVerifyReport(fp, &omdata);
+			fclose(fp);
+		}
+		OmDataFree(&omdata);
+		return retVal;
+	}
 
-		if (ofp != NULL) { fclose(ofp); }
+	OmDataDump(&omdata);
 
-		CalcClose(calc);
+	// Metadata - [Artist "IART" WAV chunk] Data about the device that made the recording
+	char artist[WAV_META_LENGTH] = { 0 };
+	sprintf(artist + strlen(artist), "Id: %u\n", omdata.metadata.deviceId);
+	sprintf(artist + strlen(artist), "Device: %s\n", omdata.metadata.deviceTypeString);
+	sprintf(artist + strlen(artist), "Revision: %d\n", omdata.metadata.deviceVersion);
+	sprintf(artist + strlen(artist), "Firmware: %d\n", omdata.metadata.firmwareVer);
 
-		fprintf(stderr, "\n");
-		fprintf(stderr, "Finished.\n");
+	// Metadata - [Title "INAM" WAV chunk] Data about the recording configuration
+	char clearTime[MAX_TIME_STRING] = { 0 };	// 2000-01-01 20:00:00.000|
+	char changeTime[MAX_TIME_STRING] = { 0 };	// 2000-01-01 20:00:00.000|
+	char startTime[MAX_TIME_STRING] = { 0 };	// 2000-01-01 20:00:00.000|
+	char stopTime[MAX_TIME_STRING] = { 0 };		// 2000-01-01 20:00:00.000|
+	char name[WAV_META_LENGTH] = { 0 };
+	sprintf(name + strlen(name), "Session: %u\n", (unsigned int)omdata.metadata.sessionId);
+	sprintf(name + strlen(name), "ClearTime: %s\n", TimeString(omdata.metadata.clearTime, clearTime));
+	sprintf(name + strlen(name), "ChangeTime: %s\n", TimeString(omdata.metadata.changeTime, changeTime));
+	sprintf(name + strlen(name), "Start: %s\n", TimeString(omdata.metadata.recordingStart, startTime));
+	sprintf(name + strlen(name), "Stop: %s\n", TimeString(omdata.metadata.recordingStop, stopTime));
+	sprintf(name + strlen(name), "Config-A: %d,%d\n", omdata.metadata.configAccel.frequency, omdata.metadata.configAccel.sensitivity);
+	sprintf(name + strlen(name), "Metadata: %s\n", omdata.metadata.metadata);
 
+	// Only the metadata (to the information file, otherwise to stdout)
+	if (settings->metadataOnly)
+	{
+		FILE *infofp = stdout;
+		if (settings->infoFilename != NULL)
+		{
+			infofp = fopen(settings->infoFilename, "wt");
+			if (infofp == NULL)
+			{
+				fprintf(stderr, "ERROR: Cannot open output information file: %s\n", settings->infoFilename);
+				OmDataFree(&omdata);
+				return EXIT_CANTCREAT;
+			}
+		}
+		if (omdata.firstSampleTime <= 0) { fprintf(stderr, "ERROR: No data.\n"); retVal = EXIT_DATAERR; }
+		OmConvertInfoInput(infofp, settings, &omdata, artist, name);
+		if (omdata.firstSampleTime > 0)
+		{
+			char firstTime[MAX_TIME_STRING] = { 0 };
+			char lastTime[MAX_TIME_STRING] = { 0 };
+			fprintf(infofp, "#:\n");
+			fprintf(infofp, "#::: Data about the extent of the recording\n");
+			fprintf(infofp, "First-sample: %s\n", TimeString(omdata.firstSampleTime, firstTime));
+			fprintf(infofp, "Last-sample: %s\n", TimeString(omdata.lastSampleTime, lastTime));
+			fprintf(infofp, "Duration: %f\n", omdata.lastSampleTime - omdata.firstSampleTime);
+		}
+		OmConvertInfoExit(infofp, retVal);
+		if (infofp != stdout) { fclose(infofp); }
+		OmDataFree(&omdata);
+		return retVal;
 	}
 
-	OmDataFree(&omdata);
+	// Count sessions
+	omdata_session_t *session;
+	int sessionCount = 0;
+	for (session = omdata.firstSession; session != NULL; session = session->sessionNext) { sessionCount++; }
 
 	if (sessionCount < 1)
 	{
 		fprintf(stderr, "ERROR: No sessions to write.\n");
 		retVal = EXIT_DATAERR;
+
+		// Still write the information file
+		if (settings->infoFilename != NULL)
+		{
+			FILE *infofp = fopen(settings->infoFilename, "wt");
+			if (infofp == NULL)
+			{
+				fprintf(stderr, "ERROR: Cannot open output information file: %s\n", settings->infoFilename);
+				retVal = EXIT_CANTCREAT;
+			}
+			else
+			{
+				OmConvertInfoInput(infofp, settings, &omdata, artist, name);
+				OmConvertInfoExit(infofp, retVal);
+				fclose(infofp);
+			}
+		}
+		OmDataFree(&omdata);
+		return retVal;
 	}
 
-	if (infofp != NULL)
+	// Per-session settings (with the output file names for the session) and calculations
+	om_convert_sessions_t sessions = { 0 };
+	sessions.omdata = &omdata;
+	sessions.artist = artist;
+	sessions.name = name;
+	sessions.sessionCount = sessionCount;
+	sessions.sessions = (om_convert_session_t *)calloc(sessionCount, sizeof(om_convert_session_t));
+	if (sessions.sessions == NULL)
 	{
-		// Write other information to info file
-		fprintf(infofp, "#:\n");
-		fprintf(infofp, "#::: Data about the final state\n");
-		fprintf(infofp, "Exit: %d\n", retVal);
+		fprintf(stderr, "ERROR: Out of memory.\n");
+		OmDataFree(&omdata);
+		return EXIT_SOFTWARE;
+	}
+	int i = 0;
+	for (session = omdata.firstSession; session != NULL; session = session->sessionNext, i++)
+	{
+		om_convert_session_t *convertSession = &sessions.sessions[i];
+		convertSession->sessionNumber = i + 1;
+		convertSession->session = session;
+		convertSession->settings = *settings;
+
+		const char **filenames[OMCONVERT_SESSION_FILENAMES] = {
+			&convertSession->settings.outFilename, &convertSession->settings.infoFilename, &convertSession->settings.stationaryFilename,
+			&convertSession->settings.csvFilename, &convertSession->settings.svmFilename, &convertSession->settings.wtvFilename,
+			&convertSession->settings.paeeFilename, &convertSession->settings.sleepFilename, &convertSession->settings.agfilterFilename,
+			&convertSession->settings.stepFilename, &convertSession->settings.auxFilename,
+		};
+		int f;
+		for (f = 0; f < OMCONVERT_SESSION_FILENAMES; f++)
+		{
+			convertSession->filenames[f] = OmConvertSessionFilename(*filenames[f], convertSession->sessionNumber);
+			*filenames[f] = convertSession->filenames[f];
+		}
 
-		fclose(infofp);
-		infofp = NULL;
+		// Created here rather than on the workers (parsing the cut-points is not thread-safe)
+		CalcCreate(&convertSession->calc, &convertSession->settings);
+	}
+
+	// Workers (one per session up to the thread count), the first runs on this thread
+	int totalThreads = settings->threads;
+	if (totalThreads <= 0) { totalThreads = OmDataProcessorCount(); }
+	int threads = totalThreads;
+	if (threads > sessionCount) { threads = sessionCount; }
+	if (threads < 1) { threads = 1; }
+
+	// Each session generates its output with its share of the threads
+	for (i = 0; i < sessionCount; i++) { sessions.sessions[i].settings.threads = (totalThreads > threads) ? totalThreads / threads : 1; }
+
+	om_convert_session_worker_t *workers = (om_convert_session_worker_t *)calloc(threads, sizeof(om_convert_session_worker_t));
+	if (workers == NULL) { threads = 0; retVal = EXIT_SOFTWARE; }
+	pthread_mutex_init(&sessions.mutex, NULL);
+	if (threads > 1) { fprintf(stderr, "Converting %d sessions with %d threads...\n", sessionCount, threads); }
+	for (i = 0; i < threads; i++)
+	{
+		om_convert_session_worker_t *worker = &workers[i];
+		worker->sessions = &sessions;
+		worker->data = &omdata;
+		if (i > 0)
+		{
+			// Other workers have their own readers with a share of the budgets
+			if (!OmDataOpenReader(&worker->reader, &omdata, threads)) { continue; }
+			worker->data = &worker->reader;
+			worker->started = (pthread_create(&worker->thread, NULL, OmConvertSessionWorker, worker) == 0);
+			if (!worker->started) { OmDataCloseReader(&worker->reader); }
+		}
+	}
+	if (threads > 1)
+	{
+		// The first worker's share of the budgets
+		omdata.cacheBudget /= threads;
+		if (omdata.store != NULL) { OmStoreSetBudget(omdata.store, OmStoreBudget(omdata.store) / threads); }
 	}
+	if (threads > 0) { OmConvertSessionWorker(&workers[0]); }
+	for (i = 1; i < threads; i++)
+	{
+		if (!workers[i].started) { continue; }
+		pthread_join(workers[i].thread, NULL);
+		OmDataCloseReader(&workers[i].reader);
+	}
+	pthread_mutex_destroy(&sessions.mutex);
+	free(workers);
+
+	// The first failure is the overall result
+	for (i = 0; i < sessionCount; i++)
+	{
+		int f;
+		if (retVal == EXIT_OK) { retVal = sessions.sessions[i].result; }
+		for (f = 0; f < OMCONVERT_SESSION_FILENAMES; f++) { free(sessions.sessions[i].filenames[f]); }
+	}
+	free(sessions.sessions);
+
+	OmDataFree(&omdata);
 
 	return retVal;
 }
@@ -1534,9 +2920,6 @@ fprintf(stderr, "COMMENT: %s\n", comment);
 
 int OmConvertRun(omconvert_settings_t *settings)
 {
-	calc_t calc;
-	CalcCreate(&calc, settings);
-
 	// Check file exists and is readable
 	FILE *fp = fopen(settings->filename, "rb");
 	if (fp == NULL) { fprintf(stderr, "NOTE: Input file not found.\n\n"); return EXIT_NOINPUT; }
@@ -1545,6 +2928,8 @@ int OmConvertRun(omconvert_settings_t *settings)
 	// Check if it's a WAV file
 	if (WavCheckFile(settings->filename))
 	{
+		calc_t calc;
+		CalcCreate(&calc, settings);
 		fprintf(stderr, "NOTE: WAV file detected, loading...\n\n");
 		return OmConvertRunWav(settings, &calc);
 	}
@@ -1558,6 +2943,6 @@ int OmConvertRun(omconvert_settings_t *settings)
 		return EXIT_DATAERR;
 	}
 
-	return OmConvertRunConvert(settings, &calc);
+	return OmConvertRunConvert(settings);
 }
 
@@ -43,12 +43,21 @@ typedef struct
 {
 	const char *filename;
 	bool forceAccept;
+	int threads;						// 0=one per processor, 1=single-threaded
+	bool index;							// Use a sidecar index file (.omidx) to skip processing on later runs
+	int io;								// I/O backend (OMDATA_IO_*)
+	int memoryBudget;					// Windowed reading budget in MB (0 = map the whole file where supported)
+	int cacheBudget;					// Decoded sample cache budget in MB (0 = no cache)
+	double startTime;					// Only convert data from this time (0 = from the start)
+	double stopTime;					// Only convert data until this time (0 = to the end)
+	bool metadataOnly;					// Only read the header and the first and last data sectors for the information file (no conversion)
+	const char *verifyFilename;			// Only check the integrity of the sectors, with a report to this file (no conversion)
 
 	// Re-sample
 	const char *outFilename;
 	double sampleRate;
 	int auxChannel;
-	char interpolate;					// 1=nearest, 2=linear, 3=cubic
+	char interpolate;					// 1=nearest, 2=linear, 3=cubic, 4=anti-aliased (fixed-point low-pass where the rates have a small integer ratio, otherwise cubic)
 	const char *infoFilename;			// Information file name
 	const char *stationaryFilename;		// Stationary points file name
 	char headerCsv;						// 0=off, 1=on
@@ -95,6 +104,9 @@ typedef struct
 	const char *stepFilename;
 	int stepEpoch;
 
+	// Aux (light, temperature, battery and events at one value per sector)
+	const char *auxFilename;
+
 } omconvert_settings_t;
 
 
@@ -106,6 +118,37 @@ typedef struct
 } om_convert_channel_t;
 
 
+// Resampling plan entry: from this output sample, the interpolation is between the same two timestamps
+typedef struct
+{
+	int64_t firstSample;				// First output sample the entry applies to
+	omdata_segment_t *seg;				// Source segment
+	int64_t previousSegmentSamples;		// Samples in the stream's earlier segments
+	int timeIndex;						// Timestamp index (before the sample)
+	bool valid;							// Data available (the rest is only set if valid)
+	int i1, i2;							// Sample indices of the timestamps either side...
+	double t1, t2;						// ...and their times
+} om_convert_plan_entry_t;
+
+// Resampling plan for one stream (the entries are recorded by the first player to pass over the samples, later players replay them)
+typedef struct
+{
+	int64_t covered;					// Output samples covered by the entries (from the start)
+	int entryCount;
+	int entryCapacity;
+	om_convert_plan_entry_t *entries;
+	bool failed;						// Stopped recording (out of memory)
+} om_convert_plan_stream_t;
+
+// Resampling plan for an arrangement at an output rate (the time-to-index interpolation is computed once and reused by each pass)
+typedef struct
+{
+	double sampleRate;
+	double startTime;
+	om_convert_plan_stream_t stream[OMDATA_MAX_STREAM];
+	om_convert_plan_stream_t adc;
+} om_convert_plan_t;
+
 // Arrangement (channel configuration)
 typedef struct
 {
@@ -119,6 +162,7 @@ typedef struct
 	double startTime;
 	double endTime;
 	double duration;
+	om_convert_plan_t *plan;		// Resampling plan shared by the players of this arrangement (NULL if none)
 } om_convert_arrangement_t;
 
 
@@ -133,15 +177,27 @@ typedef struct
 
 	// Sample index for "v1"
 	int sampleIndex;
-	int previousSegmentSamples;
+	int64_t previousSegmentSamples;
 
 	// Values cached after seek
 	double prop;						// Proportion between v1-v2
 	int16_t values[4][OMDATA_MAX_CHANNELS];	// Cache seeked values, for each channel, at indices (-1, 0, 1, 2) -- enough for cubic interpolation
+	omdata_segment_t *cachedSeg;		// Segment and "v1" index of the cached values (only re-read when the position moves to another sample)
+	int cachedIndex;
+	bool cachedClipped;
 	bool clipped;
 	bool valid;
 	double scale;			// segment with the smallest scale will be ~1/range (range will be next largest integer)
 	int maxRange;			// segment with the largest range ~1/scale (will be next largest integer)
+	om_convert_plan_stream_t *plan;		// Resampling plan to record or replay (NULL if none)
+	int planCursor;						// Current plan entry
+	om_convert_plan_entry_t interval;	// Timestamps either side of the current time index (for interval.seg and interval.timeIndex)
+	double time;						// Time of the last seek (seeking to an earlier time searches again)
+	omdata_segment_t *segmentFirst;
+	int segmentCount;
+	omdata_segment_t **segments;		// The stream's segments in order, and the samples before each (NULL if not allocated, searches then restart from the first segment)
+	int64_t *segmentPreviousSamples;
+	struct om_convert_filter_tag *filter;	// Anti-aliased values at the output rate (interpolation mode 4, NULL if not used)
 } interpolator_t;
 
 
@@ -151,7 +207,7 @@ typedef struct om_convert_player_tag
 	om_convert_arrangement_t *arrangement;
 	double sampleRate;
 	char interpolate;
-	int numSamples;
+	int64_t numSamples;
 	interpolator_t segmentInterpolators[OMDATA_MAX_STREAM];
 	interpolator_t adcInterpolator;
 	double values[OMDATA_MAX_CHANNELS + 1];
@@ -165,8 +221,57 @@ typedef struct om_convert_player_tag
 
 
 
+// Precision of the player blocks and the processing of their values (build with OMCONVERT_FLOAT32 for single precision)
+#ifdef OMCONVERT_FLOAT32
+typedef float om_convert_value_t;
+#else
+typedef double om_convert_value_t;
+#endif
+
+// Block of consecutive player samples (structure-of-arrays, bit n of each mask is sample n of the block)
+#define OMCONVERT_PLAYER_BLOCK 64
+typedef struct
+{
+	int64_t start;													// Index of the first sample in the block
+	int count;														// Number of samples in the block
+	om_convert_value_t values[OMDATA_MAX_CHANNELS + 1][OMCONVERT_PLAYER_BLOCK];	// Each channel in units (player scale applied)
+	om_convert_value_t temp[OMCONVERT_PLAYER_BLOCK];							// Temperature
+	short aux[3][OMCONVERT_PLAYER_BLOCK];							// ADC values: battery, light, temperature
+	int64_t rawIndex[OMCONVERT_PLAYER_BLOCK];						// Index of the raw accelerometer sample
+	uint64_t invalid;												// Data not available on one or more channels
+	uint64_t clippedInput;											// Input clipped on one or more channels
+	uint64_t clippedOutput;											// Output clipped (set by the consumer, e.g. after calibration)
+} om_convert_block_t;
+
+// Create an empty resampling plan (attach to an arrangement before initializing its players)
+om_convert_plan_t *OmConvertPlanCreate(void);
+void OmConvertPlanFree(om_convert_plan_t *plan);
+
 void OmConvertPlayerInitialize(om_convert_player_t *player, om_convert_arrangement_t *arrangement, double sampleRate, char interpolate);
-void OmConvertPlayerSeek(om_convert_player_t *player, int sample);
+void OmConvertPlayerSeek(om_convert_player_t *player, int64_t sample);
+
+// Fill a block with up to OMCONVERT_PLAYER_BLOCK samples from the given sample (returns the number of samples)
+int OmConvertPlayerSeekBlock(om_convert_player_t *player, int64_t sample, om_convert_block_t *block);
+
+// Buffers for a range of player samples
+typedef struct
+{
+	int64_t capacity;											// Number of samples each buffer can hold
+	double *values[OMDATA_MAX_CHANNELS];						// Each channel in units (NULL to skip a channel)
+	double *temp;												// Temperature (may be NULL)
+	unsigned char *validity;									// 0x01 = invalid, 0x02 = input clipped (may be NULL)
+	const struct omcalibrate_calibration_tag *calibration;		// Calibration to apply to the values (NULL for none)
+	int64_t firstSample;										// Set to the index of the first sample read
+} om_convert_range_t;
+
+// Read the samples from time t0 (inclusive) to t1 (exclusive) in any order (returns the number of samples read, up to the buffer capacity)
+int64_t OmConvertPlayerReadRange(om_convert_player_t *player, double t0, double t1, om_convert_range_t *buffers);
+
+// Free any memory used by a player
+void OmConvertPlayerFree(om_convert_player_t *player);
+
+// Parse a "YYYY-MM-DD hh:mm:ss[.fff]" time (modifies the string, returns 0 if not valid)
+double ParseTime(char *tstr);
 
 int OmConvertRun(omconvert_settings_t *settings);
 
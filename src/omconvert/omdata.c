@@ -43,12 +43,16 @@
 	#define _DEFAULT_SOURCE // ...or this line...
 	#include <features.h>	// ...and this line, are needed for timegm() in time.h on Linux
 #endif
+#ifndef _WIN32
+	#define _FILE_OFFSET_BITS 64	// Files over 2 GB on 32-bit systems
+#endif
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <limits.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
@@ -66,6 +70,29 @@
 	#endif
 #endif
 
+#ifdef _WIN32
+	#include "pthread-win32.h"
+#else
+	#include <pthread.h>
+#endif
+
+#ifndef NO_SIMD
+	#if defined(__AVX2__)
+		#include <immintrin.h>
+		#define OMDATA_AVX2
+	#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+		#define OMDATA_SSE2
+	#elif defined(__aarch64__) && defined(__ARM_NEON)
+		#include <arm_neon.h>
+		#define OMDATA_NEON
+	#endif
+	#if defined(__SSSE3__)
+		#include <tmmintrin.h>
+		#define OMDATA_SSSE3
+	#endif
+#endif
+
 #ifndef _WIN32
 	#include <unistd.h>
 	#define _open open
@@ -76,10 +103,19 @@
 	#define _lseek lseek
 	#define _O_RDONLY O_RDONLY
 	#define _O_BINARY 0
+#else
+	// 64-bit file sizes
+	#define _stat _stati64
+	#define _fstat _fstati64
+	#define _lseek _lseeki64
 #endif
 
 
 #include "omdata.h"
+#include "omindex.h"
+#include "omstore.h"
+#include "omgzip.h"
+#include "omarena.h"
 
 // Packed date/time
 #define DATETIME_YEAR(_v)    ((unsigned char)(((_v) >> 26) & 0x3f))
@@ -296,38 +332,33 @@ static double OmDataSampleRate(const void *buffer, char streamIndex, double *out
 
 static uint32_t OmDataTimestamp(uint32_t timestamp)
 {
-	time_t tSec;								// Seconds since epoch
-
 	// Min
 	if (timestamp == 0) { return 0; }
 	// Max
 	if (timestamp >= 0xffffffff) { return (uint32_t)-1; }
 
-	// Check if it's a serial time value
-#if 0
-	if (timestamp & 0x80000000ul)
-	{
-		tSec = (timestamp & 0x7ffffffful) + (10957ul * 24 * 60 * 60);	// Adjust Y2K epoch to unix epoch
-	}
-	else
-#endif
-	{
-		struct tm tParts = { 0 };					// Time elements (YMDHMS)
-		tParts.tm_year = 2000 + DATETIME_YEAR(timestamp) - 1900;
-		tParts.tm_mon = DATETIME_MONTH(timestamp) - 1;
-		tParts.tm_mday = DATETIME_DAY(timestamp);
-		tParts.tm_hour = DATETIME_HOURS(timestamp);
-		tParts.tm_min = DATETIME_MINUTES(timestamp);
-		tParts.tm_sec = DATETIME_SECONDS(timestamp);
-		tSec = timegm(&tParts);						// Pack from YMDHMS
-	}
+	// Pack from YMDHMS (the same as timegm(), including normalizing out-of-range fields, but without the library call for every sector)
+	int year = 2000 + DATETIME_YEAR(timestamp);
+	int month = DATETIME_MONTH(timestamp) - 1;
+	if (month < 0) { year--; month += 12; }
+	else if (month >= 12) { year++; month -= 12; }
+
+	// Days since epoch (March-based year so that the leap day is at the end)
+	int y = year - (month < 2 ? 1 : 0);
+	int era = y / 400;
+	int yearOfEra = y - era * 400;
+	int dayOfYear = (153 * (month + (month >= 2 ? -2 : 10)) + 2) / 5 + DATETIME_DAY(timestamp) - 1;
+	int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	int64_t days = (int64_t)era * 146097 + dayOfEra - 719468;
+
+	int64_t tSec = days * 86400 + DATETIME_HOURS(timestamp) * 3600 + DATETIME_MINUTES(timestamp) * 60 + DATETIME_SECONDS(timestamp);
 	return (uint32_t)tSec;
 }
 
 
-double OmDataTimestampForSector(omdata_t *omdata, int sectorIndex, char streamIndex, int *sampleIndexOffset)
+// Parse the timestamp of a data sector (for the sector's own data stream)
+static void OmDataParseSectorTimestamp(const unsigned char *p, uint32_t *outTime, uint16_t *outFraction, int16_t *outOffset)
 {
-	const unsigned char *p = (const unsigned char *)omdata->buffer + (OMDATA_SECTOR_SIZE * sectorIndex);
 	uint32_t timestamp = 0;
 	uint16_t fractional = 0;
 	int16_t timestampOffset = 0;
@@ -337,11 +368,7 @@ double OmDataTimestampForSector(omdata_t *omdata, int sectorIndex, char streamIn
 		timestamp = ((int32_t)p[17] << 24) | ((int32_t)p[16] << 16) | ((int32_t)p[15] << 8) | p[14];
 		timestampOffset = ((int16_t)p[27] << 8) | p[26];
 
-		if (streamIndex == 'l')		// Fake stream for ADC values
-		{
-			sampleIndexOffset = 0;		// TODO: Need to represent underlying sample offset at aux channel rate (measured in actual, high-speed sample rate)
-		}
-		else if (p[24] == 0)		// sampleRate 0 indicates old format
+		if (p[24] == 0)		// sampleRate 0 indicates old format
 		{
 			// Timestamp offset in very old files is actually the frequency -- don't use it...
 			timestampOffset = 0;
@@ -352,7 +379,7 @@ double OmDataTimestampForSector(omdata_t *omdata, int sectorIndex, char streamIn
 			uint16_t deviceId = ((int16_t)p[5] << 8) | p[4];
 			if (deviceId & 0x8000)
 			{
-				double freq = OmDataSampleRate(p, streamIndex, NULL, NULL);
+				double freq = OmDataSampleRate(p, p[0] - 'A' + 'a', NULL, NULL);
 
 				// Need to undo backwards-compatible shim: Take into account how many whole samples the fractional part of timestamp accounts for:  relativeOffset = fifoLength - (short)(((unsigned long)timeFractional * AccelFrequency()) >> 16);
 				// relativeOffset = fifoLength - (short)(((unsigned long)timeFractional * AccelFrequency()) >> 16);
@@ -377,8 +404,38 @@ double OmDataTimestampForSector(omdata_t *omdata, int sectorIndex, char streamIn
 		timestampOffset = (short)((unsigned short)p[14] | ((unsigned short)p[15] << 8));
 	}
 
-	// Calculate block start time (seconds since epoch)
-	uint32_t tSec = OmDataTimestamp(timestamp);
+	// Block start time (seconds since epoch)
+	*outTime = OmDataTimestamp(timestamp);
+	*outFraction = fractional;
+	*outOffset = timestampOffset;
+}
+
+
+double OmDataTimestampForSector(omdata_t *omdata, int sectorIndex, char streamIndex, int *sampleIndexOffset)
+{
+	uint32_t tSec;
+	uint16_t fractional;
+	int16_t timestampOffset;
+
+	// From the sector header table, otherwise parse the sector
+	const omdata_headers_t *headers = &omdata->headers;
+	if (sectorIndex >= 0 && sectorIndex < headers->count && headers->sampleCount[sectorIndex] != 0)
+	{
+		tSec = headers->time[sectorIndex];
+		fractional = headers->fraction[sectorIndex];
+		timestampOffset = headers->timestampOffset[sectorIndex];
+	}
+	else
+	{
+		OmDataParseSectorTimestamp(OmDataSector(omdata, sectorIndex), &tSec, &fractional, &timestampOffset);
+	}
+
+	if (streamIndex == 'l')		// Fake stream for ADC values
+	{
+		// TODO: Need to represent underlying sample offset at aux channel rate (measured in actual, high-speed sample rate)
+		fractional = 0;
+		timestampOffset = 0;
+	}
 
 	// Return sample index offset
 	if (sampleIndexOffset != NULL) { *sampleIndexOffset = timestampOffset; }
@@ -431,6 +488,30 @@ double OmDataTimestampForSector(omdata_t *omdata, int sectorIndex, char streamIn
 */
 
 
+// Grow a segment's table to at least the required capacity (extended in place while it is the most recent allocation in the arena)
+static void *OmDataGrowTable(omarena_t *arena, void *table, int count, int *capacity, int required, size_t elementSize)
+{
+	int newCapacity = 15 * *capacity / 10 + 1;
+	if (newCapacity < required) { newCapacity = required; }
+	if (table != NULL)
+	{
+		int available = (int)(OmArenaAvailable(arena, table) / elementSize);
+		if (available >= required)
+		{
+			if (newCapacity > available) { newCapacity = available; }
+			OmArenaExtend(arena, table, (size_t)newCapacity * elementSize);
+			*capacity = newCapacity;
+			return table;
+		}
+	}
+	void *newTable = OmArenaAlloc(arena, (size_t)newCapacity * elementSize);
+	if (newTable == NULL) { return NULL; }
+	if (table != NULL && count > 0) { memcpy(newTable, table, (size_t)count * elementSize); }
+	*capacity = newCapacity;
+	return newTable;
+}
+
+
 static int OmDataAddSubSector(omdata_t *omdata, int sectorIndex, char streamIndex, uint32_t sequenceId, omdata_description_t *description)
 {
 	bool startNewSegment = false;
@@ -440,6 +521,7 @@ static int OmDataAddSubSector(omdata_t *omdata, int sectorIndex, char streamInde
 	if (!stream->inUse)
 	{
 		stream->inUse = true;
+		stream->firstSequenceId = sequenceId;
 		stream->lastSequenceId = (uint32_t)-1; // = 0xffffffff;
 		stream->segmentFirst = NULL;
 		stream->segmentLast = NULL;
@@ -450,7 +532,7 @@ static int OmDataAddSubSector(omdata_t *omdata, int sectorIndex, char streamInde
 	// If we don't have a previous segment, start a new one
 	if (stream->segmentLast == NULL)
 	{
-		fprintf(stderr, "OMDATA: Stream %c creating a new segment.\n", streamIndex);
+		if (!omdata->partial) { fprintf(stderr, "OMDATA: Stream %c creating a new segment.\n", streamIndex); }
 		startNewSegment = true;
 	}
 	else
@@ -475,7 +557,14 @@ static int OmDataAddSubSector(omdata_t *omdata, int sectorIndex, char streamInde
 	unsigned int delta = (uint32_t)(sequenceId - stream->lastSequenceId);
 	if (delta != 1)
 	{
-		fprintf(stderr, "OMDATA: Stream %c delta %d != 1 (%d -> %d)\n", streamIndex, delta, stream->lastSequenceId, sequenceId);
+		if (!omdata->partial || stream->segmentLast != NULL) { fprintf(stderr, "OMDATA: Stream %c delta %d != 1 (%d -> %d)\n", streamIndex, delta, stream->lastSequenceId, sequenceId); }
+		startNewSegment = true;
+	}
+
+	// Split very long segments
+	if (!startNewSegment && seg->description.numSamples > OMDATA_MAX_SEGMENT_SAMPLES - description->samplesPerSector)
+	{
+		fprintf(stderr, "OMDATA: Stream %c segment reached the sample limit (%d).\n", streamIndex, seg->description.numSamples);
 		startNewSegment = true;
 	}
 
@@ -492,7 +581,15 @@ static int OmDataAddSubSector(omdata_t *omdata, int sectorIndex, char streamInde
 		fprintf(stderr, "OMDATA: OmDataAddSector: Creating new segment...\n");
 #endif			
 
-		seg = (omdata_segment_t *)malloc(sizeof(omdata_segment_t));
+		// The previous segment's tables will not grow, return any unused capacity to the stream's arenas
+		if (stream->segmentLast != NULL)
+		{
+			omdata_segment_t *last = stream->segmentLast;
+			if (OmArenaExtend(&omdata->sectorArena[(int)streamIndex], last->sectorIndex, (size_t)last->sectorCount * sizeof(unsigned int))) { last->sectorCapacity = last->sectorCount; }
+			if (OmArenaExtend(&omdata->timestampArena[(int)streamIndex], last->timestamps, (size_t)last->timestampCount * sizeof(omdata_segment_timestamp_t))) { last->timestampCapacity = last->timestampCount; }
+		}
+
+		seg = (omdata_segment_t *)OmArenaAlloc(&omdata->segmentArena, sizeof(omdata_segment_t));
 		memset(seg, 0, sizeof(omdata_segment_t));
 		if (stream->segmentFirst == NULL) { stream->segmentFirst = seg; }
 		if (stream->segmentLast != NULL) { stream->segmentLast->segmentNext = seg; }
@@ -524,11 +621,10 @@ static int OmDataAddSubSector(omdata_t *omdata, int sectorIndex, char streamInde
 		// Continue the current segment - grow buffer if needed
 		if (seg->timestamps == NULL || seg->timestampCount >= seg->timestampCapacity)
 		{
-			seg->timestampCapacity = (15 * seg->timestampCapacity / 10 + 1);
+			seg->timestamps = (omdata_segment_timestamp_t *)OmDataGrowTable(&omdata->timestampArena[(int)streamIndex], seg->timestamps, seg->timestampCount, &seg->timestampCapacity, seg->timestampCount + 1, sizeof(omdata_segment_timestamp_t));
 #if DEBUG_OMDATA >= 1
-			fprintf(stderr, "OMDATA: OmDataAddSector: Extending timestamp capacity: %d, @%p\n", seg->timestampCapacity, seg->timestamps);
+			fprintf(stderr, "OMDATA: OmDataAddSector: Extended timestamp capacity: %d, @%p\n", seg->timestampCapacity, seg->timestamps);
 #endif			
-			seg->timestamps = (omdata_segment_timestamp_t *)realloc(seg->timestamps, seg->timestampCapacity * sizeof(omdata_segment_timestamp_t));
 		}
 		// Add element
 		seg->timestamps[seg->timestampCount].sample = segmentSampleIndex;
@@ -543,11 +639,10 @@ static int OmDataAddSubSector(omdata_t *omdata, int sectorIndex, char streamInde
 	// Continue the current segment - grow buffer if needed
 	if (seg->sectorIndex == NULL || seg->sectorCount >= seg->sectorCapacity)
 	{
-		seg->sectorCapacity = (15 * seg->sectorCapacity / 10 + 1);
+		seg->sectorIndex = (unsigned int *)OmDataGrowTable(&omdata->sectorArena[(int)streamIndex], seg->sectorIndex, seg->sectorCount, &seg->sectorCapacity, seg->sectorCount + 1, sizeof(unsigned int));
 #if DEBUG_OMDATA >= 1
-		fprintf(stderr, "OMDATA: OmDataAddSector: Extending sector capacity: %d, @%p\n", seg->sectorCapacity, seg->sectorIndex);
+		fprintf(stderr, "OMDATA: OmDataAddSector: Extended sector capacity: %d, @%p\n", seg->sectorCapacity, seg->sectorIndex);
 #endif			
-		seg->sectorIndex = (unsigned int *)realloc(seg->sectorIndex, seg->sectorCapacity * sizeof(unsigned int));
 	}
 	// Add element
 	seg->sectorIndex[seg->sectorCount] = sectorIndex;
@@ -559,9 +654,96 @@ static int OmDataAddSubSector(omdata_t *omdata, int sectorIndex, char streamInde
 }
 
 
+// Allocate the sector header table (all columns from a single allocation)
+static bool OmDataHeadersInit(omdata_headers_t *headers, int count)
+{
+	memset(headers, 0, sizeof(omdata_headers_t));
+	if (count <= 0) { return false; }
+	size_t perSector = 2 * sizeof(uint32_t) + 5 * sizeof(uint16_t) + 2 * sizeof(uint8_t);
+	unsigned char *buffer = (unsigned char *)calloc(count, perSector);
+	if (buffer == NULL) { fprintf(stderr, "OMDATA: WARNING: Cannot allocate the sector header table, sectors will be parsed instead.\n"); return false; }
+	headers->sequenceId = (uint32_t *)buffer; buffer += count * sizeof(uint32_t);
+	headers->time = (uint32_t *)buffer; buffer += count * sizeof(uint32_t);
+	headers->fraction = (uint16_t *)buffer; buffer += count * sizeof(uint16_t);
+	headers->timestampOffset = (int16_t *)buffer; buffer += count * sizeof(int16_t);
+	headers->light = (uint16_t *)buffer; buffer += count * sizeof(uint16_t);
+	headers->temperature = (uint16_t *)buffer; buffer += count * sizeof(uint16_t);
+	headers->sampleCount = (uint16_t *)buffer; buffer += count * sizeof(uint16_t);
+	headers->battery = (uint8_t *)buffer; buffer += count * sizeof(uint8_t);
+	headers->events = (uint8_t *)buffer;
+	headers->count = count;
+	return true;
+}
+
+static void OmDataHeadersFree(omdata_headers_t *headers)
+{
+	free(headers->sequenceId);		// First column is the start of the allocation
+	memset(headers, 0, sizeof(omdata_headers_t));
+}
+
+// Grow the sector header table (keeping the existing rows)
+static void OmDataHeadersGrow(omdata_headers_t *headers, int count)
+{
+	omdata_headers_t grown;
+	int n = headers->count;
+	if (n <= 0 || count <= n) { return; }
+	if (!OmDataHeadersInit(&grown, count)) { return; }
+	memcpy(grown.sequenceId, headers->sequenceId, n * sizeof(uint32_t));
+	memcpy(grown.time, headers->time, n * sizeof(uint32_t));
+	memcpy(grown.fraction, headers->fraction, n * sizeof(uint16_t));
+	memcpy(grown.timestampOffset, headers->timestampOffset, n * sizeof(int16_t));
+	memcpy(grown.light, headers->light, n * sizeof(uint16_t));
+	memcpy(grown.temperature, headers->temperature, n * sizeof(uint16_t));
+	memcpy(grown.sampleCount, headers->sampleCount, n * sizeof(uint16_t));
+	memcpy(grown.battery, headers->battery, n * sizeof(uint8_t));
+	memcpy(grown.events, headers->events, n * sizeof(uint8_t));
+	OmDataHeadersFree(headers);
+	*headers = grown;
+}
+
+// Extract the header fields of a data sector in to the table
+static void OmDataExtractHeader(omdata_t *omdata, int sectorIndex, const unsigned char *p, char format, uint32_t sequenceId, int samplesPerSector)
+{
+	omdata_headers_t *headers = &omdata->headers;
+	if (sectorIndex < 0 || sectorIndex >= headers->count) { return; }
+
+	OmDataParseSectorTimestamp(p, &headers->time[sectorIndex], &headers->fraction[sectorIndex], &headers->timestampOffset[sectorIndex]);
+	headers->sequenceId[sectorIndex] = sequenceId;
+	if (format == 0)	// CWA
+	{
+		headers->light[sectorIndex] = (uint16_t)(p[18] | ((uint16_t)p[19] << 8));		// @18 WORD Light
+		headers->temperature[sectorIndex] = (uint16_t)(p[20] | ((uint16_t)p[21] << 8));	// @20 WORD Temperature
+		headers->events[sectorIndex] = p[22];						// @22 BYTE eventsFlag
+		headers->battery[sectorIndex] = p[23];						// @23 BYTE Battery
+	}
+	headers->sampleCount[sectorIndex] = (uint16_t)samplesPerSector;
+}
+
+// Side-channel values in CWA sectors: [0]-batt, [1]-LDR, [2]-Temp
+void OmDataSectorAux(omdata_t *omdata, int sectorIndex, int16_t *values, unsigned char *events)
+{
+	const omdata_headers_t *headers = &omdata->headers;
+	if (sectorIndex >= 0 && sectorIndex < headers->count && headers->sampleCount[sectorIndex] != 0)
+	{
+		values[0] = ((int16_t)headers->battery[sectorIndex] << 1) + 512;	// Battery - expand compressed byte into range
+		values[1] = 0x03ff & headers->light[sectorIndex];					// Light
+		values[2] = (int16_t)headers->temperature[sectorIndex];			// Temperature
+		if (events != NULL) { *events = headers->events[sectorIndex]; }	// Events flag
+	}
+	else
+	{
+		const unsigned char *p = OmDataSector(omdata, sectorIndex);
+		values[0] = ((int16_t)p[23] << 1) + 512;		// @23 BYTE Battery - expand compressed byte into range
+		values[1] = 0x03ff & (p[18] | ((int16_t)p[19] << 8));		// @18 WORD Light
+		values[2] = p[20] | ((int16_t)p[21] << 8);		// @20 WORD Temperature
+		if (events != NULL) { *events = p[22]; }		// @22 BYTE eventsFlag
+	}
+}
+
+
 static int OmDataAddSector(omdata_t *omdata, int sectorIndex)
 {
-	const unsigned char *p = (const unsigned char *)omdata->buffer + (OMDATA_SECTOR_SIZE * sectorIndex);
+	const unsigned char *p = OmDataSector(omdata, sectorIndex);
 	omdata_description_t description = { 0 };
 // description.offset;
 // description.pitch;
@@ -642,6 +824,9 @@ static int OmDataAddSector(omdata_t *omdata, int sectorIndex)
 		return -3;
 	}
 
+	// Header table
+	OmDataExtractHeader(omdata, sectorIndex, p, format, sequenceId, description.samplesPerSector);
+
 	// Calculate pitch
 	int bytesPerSample = 0, numAxes = description.channels;
 	if (description.packing == FILESTREAM_PACKING_SPECIAL_DWORD3_10_2 && description.channels == 3)
@@ -725,13 +910,89 @@ static int OmDataAddSector(omdata_t *omdata, int sectorIndex)
 	return 0;
 }
 
+// 16-bit word-wise sum of a sector (zero for a valid sector)
+static uint16_t OmDataSectorChecksum(const unsigned char *p)
+{
+#if defined(OMDATA_AVX2)
+	__m256i sum = _mm256_setzero_si256();
+	int d;
+	for (d = 0; d < OMDATA_SECTOR_SIZE; d += 32)
+	{
+		sum = _mm256_add_epi16(sum, _mm256_loadu_si256((const __m256i *)(p + d)));
+	}
+	__m128i s = _mm_add_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	s = _mm_add_epi16(s, _mm_srli_si128(s, 8));
+	s = _mm_add_epi16(s, _mm_srli_si128(s, 4));
+	s = _mm_add_epi16(s, _mm_srli_si128(s, 2));
+	return (uint16_t)_mm_cvtsi128_si32(s);
+#elif defined(OMDATA_SSE2)
+	__m128i s = _mm_setzero_si128();
+	int d;
+	for (d = 0; d < OMDATA_SECTOR_SIZE; d += 16)
+	{
+		s = _mm_add_epi16(s, _mm_loadu_si128((const __m128i *)(p + d)));
+	}
+	s = _mm_add_epi16(s, _mm_srli_si128(s, 8));
+	s = _mm_add_epi16(s, _mm_srli_si128(s, 4));
+	s = _mm_add_epi16(s, _mm_srli_si128(s, 2));
+	return (uint16_t)_mm_cvtsi128_si32(s);
+#elif defined(OMDATA_NEON)
+	uint16x8_t s = vdupq_n_u16(0);
+	int d;
+	for (d = 0; d < OMDATA_SECTOR_SIZE; d += 16)
+	{
+		s = vaddq_u16(s, vld1q_u16((const uint16_t *)(p + d)));
+	}
+	return (uint16_t)vaddvq_u16(s);
+#else
+	unsigned int d;
+	unsigned short s = 0;
+	for (d = 0; d < (OMDATA_SECTOR_SIZE / 2); d++)
+	{
+		s += ((const unsigned short *)p)[d];
+	}
+	return s;
+#endif
+}
+
+
+const unsigned char *OmDataSector(omdata_t *omdata, int sectorIndex)
+{
+	if (omdata->buffer != NULL)
+	{
+		return omdata->buffer + (size_t)OMDATA_SECTOR_SIZE * sectorIndex;
+	}
+	return OmStoreSector(omdata->store, (unsigned int)sectorIndex);
+}
+
+
+// Validity bitmap pre-pass: checksum a range of sectors in bulk (ranges starting on a multiple of 32 sectors can be validated concurrently)
+int OmDataValidateSectors(omdata_t *omdata, int sectorStartIndex, int sectorCount)
+{
+	if (omdata->sectorValid == NULL) { return -1; }
+	int i;
+	for (i = sectorStartIndex; i < sectorStartIndex + sectorCount; i++)
+	{
+		const unsigned char *p = OmDataSector(omdata, i);
+		if (OmDataSectorChecksum(p) == 0)
+		{
+			omdata->sectorValid[i >> 5] |= (1u << (i & 31));
+		}
+		else
+		{
+			omdata->sectorValid[i >> 5] &= ~(1u << (i & 31));
+		}
+	}
+	return 0;
+}
+
+
 #define READ_UINT8(_p) (*((unsigned char *)(_p)))
 #define READ_UINT16(_p) (*((unsigned char *)(_p)) | ((unsigned short)*((unsigned char *)(_p) + 1) << 8))
 #define READ_UINT32(_p) (*((unsigned char *)(_p)) | ((unsigned int)*((unsigned char *)(_p) + 1) << 8) | ((unsigned int)*((unsigned char *)(_p) + 2) << 16) | ((unsigned int)*((unsigned char *)(_p) + 3) << 24))
 
 static int OmDataProcessSectors(omdata_t *omdata, int sectorStartIndex, int sectorCount)
 {
-	const unsigned char *buffer = omdata->buffer;
 	int i;
 
 #if DEBUG_OMDATA >= 1
@@ -741,7 +1002,7 @@ fprintf(stderr, "OMDATA: Load @%d, %d\n", sectorStartIndex, sectorCount);
 	// Go through each sector
 	for (i = sectorStartIndex; i < sectorStartIndex + sectorCount; i++)
 	{
-		const unsigned char *p = (const unsigned char *)buffer + (OMDATA_SECTOR_SIZE * i);
+		const unsigned char *p = OmDataSector(omdata, i);
 		int j;
 #if DEBUG_OMDATA >= 1
 if (i == 0 || i % 50 == 0 || i + 1 == sectorStartIndex + sectorCount) {
@@ -902,22 +1163,16 @@ fprintf(stderr, "OMDATA: Sector #%d...\n", i);
 fprintf(stderr, "OMDATA: Checksum...\n");
 #endif
 		
-		// Check checksum
-		unsigned int d;
-		unsigned short s = 0;
-		for (d = 0; d < (OMDATA_SECTOR_SIZE / 2); d++)
-		{
-			s += ((const unsigned short *)p)[d];
-		}
-		if (s != 0) 
+		// Check checksum (from the validity bitmap, if the pre-pass has been run)
+		if (omdata->sectorValid != NULL ? !OMDATA_SECTOR_VALID(omdata, i) : OmDataSectorChecksum(p) != 0)
 		{ 
 			omdata->statsBadSectors++;
-			fprintf(stderr, "OMDATA: Bad sector @%d checksum=0x%04x\n", i, s); 
+			fprintf(stderr, "OMDATA: Bad sector @%d checksum=0x%04x\n", i, OmDataSectorChecksum(p)); 
 			continue; 
 		}
 
 #if DEBUG_OMDATA >= 2
-fprintf(stderr, "OMDATA: ...OK (%d)\n", s);
+fprintf(stderr, "OMDATA: ...OK\n");
 #endif
 
 		// Data
@@ -986,422 +1241,1920 @@ fprintf(stderr, "OMDATA: Done (%d)\n", omdata->statsDataSectors);
 
 
 
-static int OmDataProcessSegments(omdata_t *omdata)
+// Size the table arenas for a number of sectors (each sector is in at most one segment's sector index and adds at most one timestamp)
+static void OmDataArenaInit(omdata_t *omdata, int sectorCount)
 {
-	// Check each stream
 	int streamIndex;
+	OmArenaInit(&omdata->segmentArena, 0);
 	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
 	{
-		omdata_stream_t *stream = &omdata->stream[streamIndex];
-		if (!stream->inUse) { continue; }
-		// Check each segment
-		omdata_segment_t *seg;
-		for (seg = stream->segmentFirst; seg != NULL; seg = seg->segmentNext)
-		{
-			if (seg->sectorCount > 0 && seg->timestampCount > 0 && seg->description.sampleRate > 0)
-			{
-				// Estimate segment start/stop time
-				// TODO: This estimate is from the configured sample rate (not observed rate)
+		OmArenaInit(&omdata->sectorArena[streamIndex], (size_t)sectorCount * sizeof(unsigned int));
+		OmArenaInit(&omdata->timestampArena[streamIndex], (size_t)sectorCount * sizeof(omdata_segment_timestamp_t));
+	}
+}
 
-				// Start time
-				{
-					int index = seg->timestamps[0].sample;				// seg->timestampCount
-					double timestamp = seg->timestamps[0].timestamp;	// seg->timestampCount
-					seg->startTime = timestamp - (index / seg->description.sampleRate);
-				}
+// Take ownership of the tables of a partial scan
+static void OmDataArenaAdopt(omdata_t *omdata, omdata_t *partial)
+{
+	int streamIndex;
+	OmArenaAdopt(&omdata->segmentArena, &partial->segmentArena);
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		OmArenaAdopt(&omdata->sectorArena[streamIndex], &partial->sectorArena[streamIndex]);
+		OmArenaAdopt(&omdata->timestampArena[streamIndex], &partial->timestampArena[streamIndex]);
+	}
+}
 
-				// End time
-				{
-					int index = seg->timestamps[seg->timestampCount - 1].sample;
-					double timestamp = seg->timestamps[seg->timestampCount - 1].timestamp;
-					seg->endTime = timestamp + ((seg->description.numSamples - index) / seg->description.sampleRate);
-				}
+// Free all segments, their tables and the sessions
+static void OmDataArenaFree(omdata_t *omdata)
+{
+	int streamIndex;
+	OmArenaFree(&omdata->segmentArena);
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		OmArenaFree(&omdata->sectorArena[streamIndex]);
+		OmArenaFree(&omdata->timestampArena[streamIndex]);
+	}
+}
 
-			}
-			else
-			{
-				seg->startTime = 0;
-				seg->endTime = 0;
-			}
+// Report the table allocations
+static void OmDataArenaStats(omdata_t *omdata)
+{
+	int allocations = omdata->segmentArena.allocations, extensions = omdata->segmentArena.extensions, blocks = omdata->segmentArena.blocks;
+	size_t used = omdata->segmentArena.used, reserved = omdata->segmentArena.reserved;
+	int streamIndex;
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		omarena_t *arenas[2] = { &omdata->sectorArena[streamIndex], &omdata->timestampArena[streamIndex] };
+		int i;
+		for (i = 0; i < 2; i++)
+		{
+			allocations += arenas[i]->allocations;
+			extensions += arenas[i]->extensions;
+			blocks += arenas[i]->blocks;
+			used += arenas[i]->used;
+			reserved += arenas[i]->reserved;
 		}
 	}
+	fprintf(stderr, "OMDATA: Tables: %d allocations (%d extended in place) from %d blocks, %u of %u bytes used.\n", allocations, extensions, blocks, (unsigned int)used, (unsigned int)reserved);
+}
 
-	return 0;
+
+// Whether the first segment of a partial scan continues the last segment of a stream (as a serial scan would have done)
+static bool OmDataSegmentContinues(omdata_stream_t *stream, omdata_stream_t *partialStream)
+{
+	omdata_segment_t *last = stream->segmentLast;
+	omdata_segment_t *first = partialStream->segmentFirst;
+	if (last == NULL || first == NULL) { return false; }
+	if ((uint32_t)(partialStream->firstSequenceId - stream->lastSequenceId) != 1) { return false; }
+	if (last->lastPacketShort) { return false; }
+	if (first->description.offset != last->description.offset || first->description.packing != last->description.packing || first->description.channels != last->description.channels || first->description.scaling != last->description.scaling || first->description.sampleRate != last->description.sampleRate) { return false; }
+	if (first->description.samplesPerSector > last->description.samplesPerSector) { return false; }
+	return true;
 }
 
 
-static int OmDataCalculateSessions(omdata_t *omdata, double sessionOverlap)
+// Check whether a partial scan can be stitched on to the chains exactly as a serial scan would have built them
+static bool OmDataCanStitch(omdata_t *omdata, omdata_t *partial)
 {
-	// Tracks segments within a stream
-	typedef struct 
+	int streamIndex;
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
 	{
-		bool trackerStarted;
-		bool segmentStarted;
-		omdata_segment_t *currentSegment;
-	} omdata_segment_tracker_t;
-	omdata_segment_tracker_t segmentTrackers[OMDATA_MAX_STREAM] = { { 0 } };
-	omdata_session_t *lastSession = NULL;
-	omdata_session_t *currentSession = NULL;
-	double currentTime = 0;
-	int pass;
+		omdata_stream_t *stream = &omdata->stream[streamIndex];
+		omdata_stream_t *partialStream = &partial->stream[streamIndex];
+		if (!stream->inUse || !partialStream->inUse) { continue; }
 
-	// Find the sessions from the streams
-	for (pass = 0;; pass++)
-	{
-		(void)pass; // unused
-		// Check each stream
-		int streamIndex;
-		int nextSmallestIndex = -1;
-		int numStarted = 0;
-		double nextSmallestTime = 0;
-//fprintf(stderr, "--- PASS %d ---\n", pass);
-		for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+		// A short packet at the boundary would have ended the previous segment -- the partial chain does not know this
+		if (OmDataSegmentContinues(stream, partialStream) && partialStream->segmentFirst->description.samplesPerSector != stream->segmentLast->description.samplesPerSector)
 		{
-			omdata_stream_t *stream = &omdata->stream[streamIndex];
-			if (!stream->inUse) { continue; }
+			return false;
+		}
 
-			omdata_segment_tracker_t *tracker = &segmentTrackers[streamIndex];
+		// The joined segment would need splitting where the serial scan would split it
+		if (OmDataSegmentContinues(stream, partialStream) && (int64_t)stream->segmentLast->description.numSamples + partialStream->segmentFirst->description.numSamples > OMDATA_MAX_SEGMENT_SAMPLES)
+		{
+			return false;
+		}
+	}
+	return true;
+}
 
-			// Check for initial condition
-			if (!tracker->trackerStarted)
-			{
-//fprintf(stderr, "(Stream %c reset to first segment @%p)\n", streamIndex, stream->segmentFirst);
-				tracker->currentSegment = stream->segmentFirst;
-				tracker->trackerStarted = true;
-			}
 
-//fprintf(stderr, "Stream %c: segmentStarted=%d, currentSegment.startTime=%f, currentSegment.endTime=%f\n", streamIndex, tracker->segmentStarted, tracker->currentSegment ? tracker->currentSegment->startTime : 0.0, tracker->currentSegment ? tracker->currentSegment->endTime : 0.0);
+// Stitch the segment chains of a partial scan (of the following range of sectors) on to the chains
+static void OmDataStitch(omdata_t *omdata, omdata_t *partial)
+{
+	int streamIndex;
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		omdata_stream_t *stream = &omdata->stream[streamIndex];
+		omdata_stream_t *partialStream = &partial->stream[streamIndex];
+		if (!partialStream->inUse) { continue; }
 
+		if (!stream->inUse)
+		{
+			// First sectors of the stream
+			fprintf(stderr, "OMDATA: Stream %c creating a new segment.\n", streamIndex);
+			*stream = *partialStream;
+		}
+		else if (OmDataSegmentContinues(stream, partialStream))
+		{
+			// Join the first partial segment on to the last segment
+			omdata_segment_t *last = stream->segmentLast;
+			omdata_segment_t *first = partialStream->segmentFirst;
+			int sampleOffset = last->sectorCount * last->description.samplesPerSector;
+			int i;
 
-			// Check for final condition
-			if (tracker->currentSegment == NULL)
-			{ 
-//fprintf(stderr, "(Stream %c finished - skipping)\n", streamIndex);
-				continue;
+			if (last->sectorCount + first->sectorCount > last->sectorCapacity)
+			{
+				last->sectorIndex = (unsigned int *)OmDataGrowTable(&omdata->sectorArena[streamIndex], last->sectorIndex, last->sectorCount, &last->sectorCapacity, last->sectorCount + first->sectorCount, sizeof(unsigned int));
 			}
-			
-			// If this is not started, should we start it?
-			if (!tracker->segmentStarted && currentTime >= tracker->currentSegment->startTime)
+			memcpy(last->sectorIndex + last->sectorCount, first->sectorIndex, first->sectorCount * sizeof(unsigned int));
+			last->sectorCount += first->sectorCount;
+
+			if (last->timestampCount + first->timestampCount > last->timestampCapacity)
 			{
-				tracker->segmentStarted = true;
+				last->timestamps = (omdata_segment_timestamp_t *)OmDataGrowTable(&omdata->timestampArena[streamIndex], last->timestamps, last->timestampCount, &last->timestampCapacity, last->timestampCount + first->timestampCount, sizeof(omdata_segment_timestamp_t));
+			}
+			for (i = 0; i < first->timestampCount; i++)
+			{
+				omdata_segment_timestamp_t ts = first->timestamps[i];
+				ts.sample += sampleOffset;
+				// The serial scan does not add a timestamp at the same sample index as the previous one
+				if (last->timestampCount > 0 && last->timestamps[last->timestampCount - 1].sample == ts.sample) { continue; }
+				last->timestamps[last->timestampCount++] = ts;
+			}
 
-//fprintf(stderr, "... segmentStarted! (currentSession=%f)\n", currentSession ? currentSession->startTime : -1);
+			last->description.numSamples += first->description.numSamples;
+			last->lastPacketShort = first->lastPacketShort;
 
-				// We're recording a new segment -- check we have a current session
-				if (currentSession == NULL)
-				{
-					// Need to make a new session
-					currentSession = (omdata_session_t *)malloc(sizeof(omdata_session_t));
-					memset(currentSession, 0, sizeof(omdata_session_t));
-//fprintf(stderr, "... new session!\n");
+			last->segmentNext = first->segmentNext;
+			if (partialStream->segmentLast != first) { stream->segmentLast = partialStream->segmentLast; }
+			stream->lastSequenceId = partialStream->lastSequenceId;
+			// (the joined segment is released with the partial scan's tables)
+		}
+		else
+		{
+			// A break in the stream at the boundary
+			fprintf(stderr, "OMDATA: Break in stream %c (sequence id %d -> %d)\n", streamIndex, stream->lastSequenceId, partialStream->firstSequenceId);
+			stream->segmentLast->segmentNext = partialStream->segmentFirst;
+			stream->segmentLast = partialStream->segmentLast;
+			stream->lastSequenceId = partialStream->lastSequenceId;
+		}
 
-					// If this is the first session one, set it
-					if (omdata->firstSession == NULL)
-					{
-						omdata->firstSession = currentSession;
-					}
+		// The chain now belongs to the main scan
+		partialStream->inUse = false;
+		partialStream->segmentFirst = NULL;
+		partialStream->segmentLast = NULL;
+	}
 
-					// This is the first segment in the session, set the start and end time
-					currentSession->startTime = tracker->currentSegment->startTime;
-					currentSession->endTime = tracker->currentSegment->endTime;
+	omdata->statsTotalSectors += partial->statsTotalSectors;
+	omdata->statsBadSectors += partial->statsBadSectors;
+	omdata->statsDataSectors += partial->statsDataSectors;
 
-					// If this is not the first session, continue the chain
-					if (lastSession != NULL)
-					{
-						lastSession->sessionNext = currentSession;
-					}
-					lastSession = currentSession;
-				}
+	OmDataArenaAdopt(omdata, partial);
+}
 
-				// We're recording a new segment -- add it to the chain
-				currentSession->stream[streamIndex].inUse = true;
-				if (currentSession->stream[streamIndex].segmentFirst == NULL)
-				{
-//fprintf(stderr, "... first segment in session's chain.\n");
-					currentSession->stream[streamIndex].segmentFirst = tracker->currentSegment;
-				}
-				// (if it's not the first, it will already be on the chain)
-				currentSession->stream[streamIndex].segmentLast = tracker->currentSegment;
 
+// Sector scan over a contiguous range of sectors, building partial segment chains
+typedef struct
+{
+	omdata_t *omdata;
+	int sectorStartIndex;
+	int sectorCount;
+	pthread_t thread;
+	bool started;
+} omdata_scan_worker_t;
 
-				// Update the start time if it's the earliest segment in the session
+#define OMDATA_SCAN_CHUNK_SECTORS 2048	// Sectors validated then processed together (so that they are still cached, or within the reader's window)
 
-				// If this segment started earlier than the earliest segment in the session, set the start time
-				if (tracker->currentSegment->startTime < currentSession->startTime)
-				{
-					currentSession->startTime = tracker->currentSegment->startTime;
-				}
+// Validate and process a range of sectors
+static int OmDataScanSectors(omdata_t *omdata, int sectorStartIndex, int sectorCount)
+{
+	int sectorEndIndex = sectorStartIndex + sectorCount;
+	int i;
+	for (i = sectorStartIndex; i < sectorEndIndex; i += OMDATA_SCAN_CHUNK_SECTORS)
+	{
+		int count = (sectorEndIndex - i < OMDATA_SCAN_CHUNK_SECTORS) ? (sectorEndIndex - i) : OMDATA_SCAN_CHUNK_SECTORS;
+		OmDataValidateSectors(omdata, i, count);
+		OmDataProcessSectors(omdata, i, count);
+	}
+	return 0;
+}
 
-				// If this segment ended later than the latest segment in the session, set the end time
-				if (tracker->currentSegment->endTime > currentSession->endTime)
-				{
-					currentSession->endTime = tracker->currentSegment->endTime;
-				}
+static void *OmDataScanWorker(void *arg)
+{
+	omdata_scan_worker_t *worker = (omdata_scan_worker_t *)arg;
+	OmDataScanSectors(worker->omdata, worker->sectorStartIndex, worker->sectorCount);
+	return NULL;
+}
 
-			}
-			else if (tracker->segmentStarted && currentTime >= tracker->currentSegment->endTime) // If this has started, should we end it and move to the next segment?
-			{
-//fprintf(stderr, "... end segment.\n");
-				tracker->segmentStarted = false;
-				tracker->currentSegment = tracker->currentSegment->segmentNext;
-//if (tracker->currentSegment == NULL) { fprintf(stderr, "... LAST SEGMENT!\n"); }
-			}
 
-			// Count the number of started segments
-			if (tracker->segmentStarted) { numStarted++; }
+// Number of processors available
+int OmDataProcessorCount(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return (int)systemInfo.dwNumberOfProcessors;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0) ? (int)count : 1;
+#endif
+}
 
-			// If there are more segments in the stream...
-			if (tracker->currentSegment != NULL)
+
+// Scan the sectors of a compressed file as they are decompressed (the decompressed buffer is then kept)
+static int OmDataScanGzip(omdata_t *omdata, omgzip_t *gzip)
+{
+	int tableSectors = (int)(omdata->length / OMDATA_SECTOR_SIZE);	// Tables were sized from the estimated length
+	size_t processed = 0;
+	for (;;)
+	{
+		const unsigned char *buffer;
+		size_t available = OmGzipWait(gzip, processed, &buffer);
+		if (available / OMDATA_SECTOR_SIZE > INT_MAX) { fprintf(stderr, "ERROR: Decompressed file too large.\n"); free(OmGzipFinish(gzip, NULL)); omdata->buffer = NULL; return 0; }
+		int first = (int)(processed / OMDATA_SECTOR_SIZE);
+		int last = (int)(available / OMDATA_SECTOR_SIZE);
+		if (last <= first) { break; }
+
+		// Grow the tables if the estimate was short
+		if (last > tableSectors)
+		{
+			int count = (last < INT_MAX / 3 * 2) ? last + last / 2 : INT_MAX;
+			if (omdata->sectorValid != NULL)
 			{
-				// Find the next time to jump to
-				double nextTime = tracker->segmentStarted ? tracker->currentSegment->endTime : tracker->currentSegment->startTime;
-				if (nextTime < tracker->currentSegment->startTime) { nextTime = tracker->currentSegment->startTime; }	// Cope with an invalid range
-				if (nextTime > currentTime && (nextSmallestIndex < 0 || nextTime <= nextSmallestTime))	// Ensure going forwards
-				{
-					nextSmallestTime = nextTime;
-					nextSmallestIndex = streamIndex;
-				}
+				size_t words = (tableSectors + 31) / 32 + 1;
+				size_t newWords = (count + 31) / 32 + 1;
+				uint32_t *sectorValid = (uint32_t *)realloc(omdata->sectorValid, newWords * sizeof(uint32_t));
+				if (sectorValid == NULL) { fprintf(stderr, "ERROR: Problem growing the validity table.\n"); free(OmGzipFinish(gzip, NULL)); omdata->buffer = NULL; return 0; }
+				memset(sectorValid + words, 0, (newWords - words) * sizeof(uint32_t));
+				omdata->sectorValid = sectorValid;
 			}
-
+			OmDataHeadersGrow(&omdata->headers, count);
+			tableSectors = count;
 		}
 
-//		fprintf(stderr, "==> %d active, current time %f, next time %f (%c)\n", numStarted, currentTime, nextSmallestTime, nextSmallestIndex);
+		omdata->buffer = buffer;
+		omdata->length = available;
+		OmDataScanSectors(omdata, first, last - first);
+		processed = (size_t)last * OMDATA_SECTOR_SIZE;
+	}
 
-		// Check if we're at the end of a session
-		if (numStarted <= 0 && currentSession != NULL)
-		{
-			// Allow small gaps between segments (e.g. around a small area of corruption)
-			if ((nextSmallestTime - currentTime) >= sessionOverlap)
-			{
-//fprintf(stderr, "! Gap too large: breaking segment chains and clearing the current session.\n");
+	size_t length = 0;
+	omdata->buffer = OmGzipFinish(gzip, &length);
+	omdata->length = length;
+	return (omdata->buffer != NULL);
+}
 
-				// Break the segment chains...
-				for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
-				{
-					omdata_segment_tracker_t *tracker = &segmentTrackers[streamIndex];
-					if (tracker->currentSegment != NULL)
-					{
-						tracker->currentSegment->segmentNext = NULL;
-						tracker->currentSegment = NULL;
-					}
-				}
 
-				// We're no longer in a session
-				currentSession = NULL;
-			}
+// Monotonic time in seconds (for throughput)
+static double OmDataTimeNow(void)
+{
+#ifdef _WIN32
+	return GetTickCount64() / 1000.0;
+#else
+	struct timespec tp;
+	if (clock_gettime(CLOCK_MONOTONIC, &tp) == -1) { return 0; }
+	return (double)tp.tv_sec + (tp.tv_nsec / 1000000000.0);
+#endif
+}
+
+
+#define OMDATA_SCAN_MIN_SECTORS 1024	// Minimum number of sectors for each scan thread
+
+// Process sectors using multiple threads (the first range is scanned directly in to the main chains, the partial chains of the other ranges are stitched on in order)
+static int OmDataProcessSectorsParallel(omdata_t *omdata, int sectorStartIndex, int sectorCount, int threads)
+{
+	if (threads > sectorCount / OMDATA_SCAN_MIN_SECTORS) { threads = sectorCount / OMDATA_SCAN_MIN_SECTORS; }
+	if (threads <= 1)
+	{
+		return OmDataScanSectors(omdata, sectorStartIndex, sectorCount);
+	}
+
+	omdata_scan_worker_t *workers = (omdata_scan_worker_t *)calloc(threads, sizeof(omdata_scan_worker_t));
+	if (workers == NULL)
+	{
+		return OmDataScanSectors(omdata, sectorStartIndex, sectorCount);
+	}
+
+	fprintf(stderr, "OMDATA: Scanning with %d threads...\n", threads);
+
+	// A windowed reader's budget is shared between the threads
+	size_t budget = OmStoreBudget(omdata->store);
+	OmStoreSetBudget(omdata->store, budget / threads);
+
+	int i;
+	for (i = 0; i < threads; i++)
+	{
+		omdata_scan_worker_t *worker = &workers[i];
+		// Ranges start on a whole word of the validity bitmap
+		worker->sectorStartIndex = (i == 0) ? sectorStartIndex : ((sectorStartIndex + (int)((long long)sectorCount * i / threads)) & ~31);
+		worker->sectorCount = ((i + 1 == threads) ? (sectorStartIndex + sectorCount) : ((sectorStartIndex + (int)((long long)sectorCount * (i + 1) / threads)) & ~31)) - worker->sectorStartIndex;
+		if (i == 0) { worker->omdata = omdata; continue; }
+
+		worker->omdata = (omdata_t *)calloc(1, sizeof(omdata_t));
+		if (worker->omdata == NULL) { continue; }
+		worker->omdata->buffer = omdata->buffer;
+		worker->omdata->length = omdata->length;
+		if (omdata->store != NULL)
+		{
+			worker->omdata->store = OmStoreReopen(omdata->store, budget / threads);
+			if (worker->omdata->store == NULL) { continue; }
 		}
+		worker->omdata->sectorValid = omdata->sectorValid;
+		worker->omdata->headers = omdata->headers;		// (the ranges fill separate rows)
+		worker->omdata->partial = true;
+		OmDataArenaInit(worker->omdata, worker->sectorCount);
+		worker->started = (pthread_create(&worker->thread, NULL, OmDataScanWorker, worker) == 0);
+	}
 
-		// Check for finished
-		if (nextSmallestIndex < 0) { break; }
+	// The first range is scanned on this thread
+	OmDataScanWorker(&workers[0]);
 
-		// Advance time
-		currentTime = nextSmallestTime;
-	};
+	for (i = 1; i < threads; i++)
+	{
+		omdata_scan_worker_t *worker = &workers[i];
+		if (worker->started)
+		{
+			pthread_join(worker->thread, NULL);
+		}
+
+		if (!worker->started)
+		{
+			// No thread for this range, scan it directly
+			OmDataScanSectors(omdata, worker->sectorStartIndex, worker->sectorCount);
+		}
+		else if (OmDataCanStitch(omdata, worker->omdata))
+		{
+			OmDataStitch(omdata, worker->omdata);
+		}
+		else
+		{
+			// Discard the partial chains and rescan the range on to the chains so far
+			fprintf(stderr, "OMDATA: Rescanning sectors @%d-%d as they cannot be stitched.\n", worker->sectorStartIndex, worker->sectorStartIndex + worker->sectorCount - 1);
+			OmDataArenaFree(worker->omdata);
+			OmDataProcessSectors(omdata, worker->sectorStartIndex, worker->sectorCount);
+		}
+		if (worker->omdata != NULL) { OmStoreClose(worker->omdata->store); }
+		free(worker->omdata);
+	}
 
+	OmStoreSetBudget(omdata->store, budget);
+	free(workers);
 	return 0;
 }
 
 
-int OmDataCanLoad(const char *filename)
-{
-	FILE *fp = fopen(filename, "rb");
-	if (fp == NULL) { return 0; }
-	//fseek(fp, 0, SEEK_END); long length = ftell(fp); fseek(fp, 0, SEEK_SET); buffer = (unsigned char *)malloc(length); if (buffer == NULL) { fclose(fp); return 0; }
 
-	char buffer[4] = { 0 };
-	if (fread(buffer, 1, sizeof(buffer), fp) != sizeof(buffer)) { fclose(fp); return 0; }
-	fclose(fp);
 
-	if (buffer[0] == 'M' && buffer[1] == 'D') { return 1; }
-	else if (buffer[0] == 'H' && buffer[1] == 'A') { return 1; }
-	else if (buffer[0] == 'd') { return 1; }
-	else if (buffer[1] == 'X') { return 1; }
 
-	return 0;
+
+
+// Residual of the given width
+static int64_t OmDataResidual(const unsigned char *p, int width, int index)
+{
+	switch (width)
+	{
+		case 1: return (int8_t)p[index];
+		case 2: { int16_t v; memcpy(&v, p + 2 * index, sizeof(v)); return v; }
+		case 4: { int32_t v; memcpy(&v, p + 4 * index, sizeof(v)); return v; }
+		default: return 0;
+	}
+}
+
+static void OmDataSetResidual(unsigned char *p, int width, int index, int64_t value)
+{
+	switch (width)
+	{
+		case 1: p[index] = (unsigned char)(int8_t)value; break;
+		case 2: { int16_t v = (int16_t)value; memcpy(p + 2 * index, &v, sizeof(v)); break; }
+		case 4: { int32_t v = (int32_t)value; memcpy(p + 4 * index, &v, sizeof(v)); break; }
+		default: break;
+	}
 }
 
+// Smallest residual width for a range of values
+static int OmDataResidualWidth(int64_t minimum, int64_t maximum)
+{
+	if (minimum == 0 && maximum == 0) { return 0; }
+	if (minimum >= INT8_MIN && maximum <= INT8_MAX) { return 1; }
+	if (minimum >= INT16_MIN && maximum <= INT16_MAX) { return 2; }
+	if (minimum >= INT32_MIN && maximum <= INT32_MAX) { return 4; }
+	return -1;
+}
 
 
-char OmDataAnalyzeTimestamps(omdata_t *omdata)
+unsigned int OmDataSegmentSector(const omdata_segment_t *seg, int sectorWithinSegment)
 {
-	if (omdata == NULL) { return -1; }
+	if (seg->sectorIndex != NULL) { return seg->sectorIndex[sectorWithinSegment]; }
 
-	int sectorCount = omdata->length / OMDATA_SECTOR_SIZE + 1;
-	omdata->timestampOffset = (double *)calloc(sectorCount + 1, sizeof(double));
+	// Find the run (only a few runs can start within each lookup entry)
+	int run = (seg->runLookup != NULL) ? (int)seg->runLookup[sectorWithinSegment >> OMDATA_RUN_LOOKUP_SHIFT] : 0;
+	while (run + 1 < seg->runCount && seg->runs[run + 1].first <= (unsigned int)sectorWithinSegment) { run++; }
+	return seg->runs[run].sector + (sectorWithinSegment - seg->runs[run].first);
+}
 
-	FILE *dfp = NULL;
-#if 0
-	dfp = fopen("/temp/times.csv", "wt");
-	fprintf(stderr, "NOTE: Writing timestamp log file...\n");
-#endif
-	//if (dfp == NULL) { return -1; }
 
-	// Step 1. Determine any oscillator non-uniformity by looking at sample period
-	int streamIndex;
-	double worstDifference = 0.0f;
-	double affectedT = 0;
-	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+omdata_segment_timestamp_t OmDataSegmentTimestamp(const omdata_segment_t *seg, int timestampIndex)
+{
+	if (seg->timestamps != NULL) { return seg->timestamps[timestampIndex]; }
+
+	const omdata_timestamp_block_t *block = &seg->timestampBlocks[timestampIndex >> OMDATA_TIMESTAMP_BLOCK_SHIFT];
+	int count = seg->timestampCount - (timestampIndex & ~(OMDATA_TIMESTAMP_BLOCK - 1));
+	int i = timestampIndex & (OMDATA_TIMESTAMP_BLOCK - 1);
+	const unsigned char *p = seg->residuals + block->residual;
+	omdata_segment_timestamp_t ts;
+
+	if (count > OMDATA_TIMESTAMP_BLOCK) { count = OMDATA_TIMESTAMP_BLOCK; }
+	if (block->timeWidth == OMDATA_TIMESTAMP_EXACT)
 	{
-		omdata_stream_t *stream = &omdata->stream[streamIndex];
-		if (!stream->inUse) { continue; }
-		if (streamIndex != 'a') { continue; }	// Only run on one channel of accel
+		memcpy(&ts.timestamp, p + i * sizeof(double), sizeof(double));
+	}
+	else
+	{
+		ts.timestamp = (double)(block->time + (((int64_t)i * block->timeStep + OmDataResidual(p, block->timeWidth, i)) * ((int64_t)1 << block->timeShift))) / OMDATA_TIMESTAMP_TICKS;
+	}
+	p += count * block->timeWidth;
+	ts.sample = (int)(block->sample + (int64_t)i * block->sampleStep + OmDataResidual(p, block->sampleWidth, i));
+	return ts;
+}
 
-		// Segment info
-		omdata_segment_t *seg;
-		for (seg = stream->segmentFirst; seg != NULL; seg = seg->segmentNext)
-		{
-			// Note seg->startTime and seg->endTime not yet valid
-			//fprintf(stderr, "Sectors: %d\n", seg->sectorCount);
-			//fprintf(stderr, "Samples: %d\n", seg->numSamples);
-//			fprintf(stderr, ">>> %d samples in %d sectors with %d timestamps.\n", seg->numSamples, seg->sectorCount, seg->timestampCount);
-			int i;
-			omdata_segment_timestamp_t *lts = NULL;
-			double startTime = 0;
-			double slidingAverage = 0.0f;
-			double lastPeriod = 0;
-			int stableSamples = 0;
-			for (i = 0; i < seg->timestampCount; i++)
-			{
-				omdata_segment_timestamp_t *ts = &seg->timestamps[i];
-				int sectorIndexOffset = ts->sample / seg->description.samplesPerSector;
-				if (sectorIndexOffset < 0 || sectorIndexOffset >= seg->sectorCount)
-				{
-					//fprintf(stderr, "WARNING: Sector index offset %d out of range (0-%d) for segment timestamp %d.\n", sectorIndexOffset, seg->sectorCount, i);
-					if (seg->sectorCount <= 0) continue;
-					sectorIndexOffset = seg->sectorCount - 1;
-				}
 
-				if (startTime == 0) { startTime = ts->timestamp; }
-				if (lts != NULL && ts->sample > lts->sample)
-				{
-					double relT = ts->timestamp - startTime;
-					int deltaI = ts->sample - lts->sample;
-					double deltaT = ts->timestamp - lts->timestamp;
-					double period = deltaT / deltaI;
-					double freq = deltaI / deltaT;
-					if (dfp != NULL) { fprintf(dfp, "%d,%f,%d,%f,%f\n", ts->sample, relT, deltaI, deltaT, freq); }
+// Model a block of timestamps, returns the number of residual bytes (the residuals are written if the buffer is not NULL)
+static unsigned int OmDataCompactTimestampBlock(const omdata_segment_timestamp_t *timestamps, int count, omdata_timestamp_block_t *block, unsigned char *residuals)
+{
+	int64_t ticks[OMDATA_TIMESTAMP_BLOCK] = { 0 };
+	int64_t minimum, maximum;
+	bool exact = false;
+	int i;
 
-					double allowance = 0.006 * slidingAverage;
-					double fade = 0.05 * deltaT;
-					double diff = slidingAverage - period;
+	memset(block, 0, sizeof(omdata_timestamp_block_t));
 
-if (diff / slidingAverage > worstDifference) { worstDifference = diff / slidingAverage; }
+	// Times as whole ticks (otherwise the times are stored exactly)
+	for (i = 0; i < count; i++)
+	{
+		double t = timestamps[i].timestamp * OMDATA_TIMESTAMP_TICKS;
+		if (!(fabs(t) < 9007199254740992.0) || t != floor(t)) { exact = true; break; }	// 2^53
+		ticks[i] = (int64_t)t;
+	}
+	if (!exact)
+	{
+		// Units common to all of the times (e.g. whole-second timestamps)
+		uint64_t common = 0;
+		int shift = 0;
+		for (i = 1; i < count; i++) { common |= (uint64_t)(ticks[i] - ticks[0]); }
+		while (common != 0 && !(common & 1) && shift < 32) { common >>= 1; shift++; }
+		for (i = count - 1; i >= 0; i--) { ticks[i] = (ticks[i] - ticks[0]) / ((int64_t)1 << shift); }	// (relative to the first time, in units)
+
+		int64_t step = (count > 1) ? ticks[count - 1] / (count - 1) : 0;
+		block->time = (int64_t)(timestamps[0].timestamp * OMDATA_TIMESTAMP_TICKS);
+		block->timeStep = (int32_t)step;
+		block->timeShift = (uint8_t)shift;
+		minimum = maximum = 0;
+		for (i = 0; i < count; i++)
+		{
+			int64_t residual = ticks[i] - (int64_t)i * block->timeStep;
+			if (residual < minimum) { minimum = residual; }
+			if (residual > maximum) { maximum = residual; }
+		}
+		if (step < INT32_MIN || step > INT32_MAX || OmDataResidualWidth(minimum, maximum) < 0) { exact = true; }
+		else { block->timeWidth = (uint8_t)OmDataResidualWidth(minimum, maximum); }
+	}
+	if (exact)
+	{
+		block->time = 0;
+		block->timeStep = 0;
+		block->timeShift = 0;
+		block->timeWidth = OMDATA_TIMESTAMP_EXACT;
+	}
 
-					if (i <= 1) { slidingAverage = period; }
-					else if (fabs(lastPeriod - period) < allowance) 
-					{
-						stableSamples += deltaI;
-					}
-					else 
-					{ 
-						stableSamples = 0;
-					}
+	// Sample indexes
+	block->sample = timestamps[0].sample;
+	block->sampleStep = (count > 1) ? (int32_t)(((int64_t)timestamps[count - 1].sample - timestamps[0].sample) / (count - 1)) : 0;
+	minimum = maximum = 0;
+	for (i = 0; i < count; i++)
+	{
+		int64_t residual = timestamps[i].sample - (block->sample + (int64_t)i * block->sampleStep);
+		if (residual < minimum) { minimum = residual; }
+		if (residual > maximum) { maximum = residual; }
+	}
+	block->sampleWidth = (uint8_t)OmDataResidualWidth(minimum, maximum);	// (within 32-bit)
 
-					if (fabs(diff) > allowance && relT > 90.0)
-					{
-						int sector = seg->sectorIndex[sectorIndexOffset];
-						double timeslip = diff * deltaI;
-						omdata->timestampOffset[sector] += timeslip;
-//						printf("%02d:%02d:%02d.%02d,%f,%f,%d,%f\n", (int)relT / 60 / 60, ((int)relT / 60) % 60, (int)relT % 60, (int)((relT - (int)relT) * 100), slidingAverage, period, sector, timeslip);
-						stableSamples = 0;
-						affectedT += deltaT;
-					}
+	if (residuals != NULL)
+	{
+		unsigned char *p = residuals;
+		for (i = 0; i < count; i++)
+		{
+			if (block->timeWidth == OMDATA_TIMESTAMP_EXACT) { memcpy(p + i * sizeof(double), &timestamps[i].timestamp, sizeof(double)); }
+			else { OmDataSetResidual(p, block->timeWidth, i, ticks[i] - (int64_t)i * block->timeStep); }
+		}
+		p += count * block->timeWidth;
+		for (i = 0; i < count; i++)
+		{
+			OmDataSetResidual(p, block->sampleWidth, i, timestamps[i].sample - (block->sample + (int64_t)i * block->sampleStep));
+		}
+	}
 
-					if (stableSamples > 10 * seg->description.sampleRate)
-					{
-						slidingAverage = ((1 - fade) * slidingAverage) + (fade * period);
-					}
+	return (unsigned int)(count * (block->timeWidth + block->sampleWidth));
+}
 
 
-					lastPeriod = period;
-				}
-				lts = ts;
-			}
+// Replace a segment's sector index and timestamps with the compact tables
+static size_t OmDataCompactSegment(omdata_t *omdata, omdata_segment_t *seg)
+{
+	omarena_t *arena = &omdata->segmentArena;
+	int blockCount = (seg->timestampCount + OMDATA_TIMESTAMP_BLOCK - 1) >> OMDATA_TIMESTAMP_BLOCK_SHIFT;
+	int i, run;
+
+	// Sector runs
+	seg->runCount = 0;
+	for (i = 0; i < seg->sectorCount; i++)
+	{
+		if (i == 0 || seg->sectorIndex[i] != seg->sectorIndex[i - 1] + 1) { seg->runCount++; }
+	}
+	seg->runs = (omdata_sector_run_t *)OmArenaAlloc(arena, (seg->runCount + 1) * sizeof(omdata_sector_run_t));
+	for (i = 0, run = -1; i < seg->sectorCount; i++)
+	{
+		if (i == 0 || seg->sectorIndex[i] != seg->sectorIndex[i - 1] + 1)
+		{
+			run++;
+			seg->runs[run].first = i;
+			seg->runs[run].sector = seg->sectorIndex[i];
+		}
+	}
+	seg->runLookup = NULL;
+	if (seg->runCount > 1)
+	{
+		int lookupCount = (seg->sectorCount >> OMDATA_RUN_LOOKUP_SHIFT) + 1;
+		seg->runLookup = (unsigned int *)OmArenaAlloc(arena, lookupCount * sizeof(unsigned int));
+		for (i = 0, run = 0; i < lookupCount; i++)
+		{
+			while (run + 1 < seg->runCount && seg->runs[run + 1].first <= ((unsigned int)i << OMDATA_RUN_LOOKUP_SHIFT)) { run++; }
+			seg->runLookup[i] = run;
 		}
 	}
 
+	// Timestamp blocks
+	seg->timestampBlocks = (omdata_timestamp_block_t *)OmArenaAlloc(arena, (blockCount + 1) * sizeof(omdata_timestamp_block_t));
+	seg->residualSize = 0;
+	for (i = 0; i < blockCount; i++)
+	{
+		int start = i << OMDATA_TIMESTAMP_BLOCK_SHIFT;
+		int count = (seg->timestampCount - start < OMDATA_TIMESTAMP_BLOCK) ? (seg->timestampCount - start) : OMDATA_TIMESTAMP_BLOCK;
+		unsigned int size = OmDataCompactTimestampBlock(seg->timestamps + start, count, &seg->timestampBlocks[i], NULL);
+		seg->timestampBlocks[i].residual = seg->residualSize;
+		seg->residualSize += size;
+	}
+	seg->residuals = (unsigned char *)OmArenaAlloc(arena, seg->residualSize + 1);
+	for (i = 0; i < blockCount; i++)
+	{
+		int start = i << OMDATA_TIMESTAMP_BLOCK_SHIFT;
+		int count = (seg->timestampCount - start < OMDATA_TIMESTAMP_BLOCK) ? (seg->timestampCount - start) : OMDATA_TIMESTAMP_BLOCK;
+		uint32_t residual = seg->timestampBlocks[i].residual;
+		OmDataCompactTimestampBlock(seg->timestamps + start, count, &seg->timestampBlocks[i], seg->residuals + residual);
+		seg->timestampBlocks[i].residual = residual;
+	}
+
+	// The full tables are released with their arenas
+	seg->sectorIndex = NULL;
+	seg->sectorCapacity = 0;
+	seg->timestamps = NULL;
+	seg->timestampCapacity = 0;
+
+	return (size_t)seg->runCount * sizeof(omdata_sector_run_t) + (seg->runLookup != NULL ? ((seg->sectorCount >> OMDATA_RUN_LOOKUP_SHIFT) + 1) * sizeof(unsigned int) : 0) + (size_t)blockCount * sizeof(omdata_timestamp_block_t) + seg->residualSize;
+}
+
 
-	// Step 2. Cumulative sum of any timestamp offsets
-	double cumulativeOffset = 0;
-	for (int i = 0; i < sectorCount; i++)
+// Replace all of the segments' sector indexes and timestamps with the compact tables
+static void OmDataCompactSegments(omdata_t *omdata)
+{
+	size_t before = 0, after = 0;
+	int streamIndex;
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
 	{
-		cumulativeOffset += omdata->timestampOffset[i];
-		omdata->timestampOffset[i] = cumulativeOffset;
-if (i + 1 >= sectorCount && cumulativeOffset > 0.0) { fprintf(stderr, "DEBUG: Cumulative offset %f over %f (worst prop diff %f)\n", cumulativeOffset, affectedT, worstDifference); }
+		omdata_stream_t *stream = &omdata->stream[streamIndex];
+		omdata_segment_t *seg;
+		if (!stream->inUse) { continue; }
+		for (seg = stream->segmentFirst; seg != NULL; seg = seg->segmentNext)
+		{
+			before += (size_t)seg->sectorCount * sizeof(unsigned int) + (size_t)seg->timestampCount * sizeof(omdata_segment_timestamp_t);
+			after += OmDataCompactSegment(omdata, seg);
+		}
+		OmArenaFree(&omdata->sectorArena[streamIndex]);
+		OmArenaFree(&omdata->timestampArena[streamIndex]);
 	}
+	fprintf(stderr, "OMDATA: Compacted segment index from %u to %u bytes.\n", (unsigned int)before, (unsigned int)after);
+}
 
 
-	// Step 3. Apply any offsets to all streams
+static int OmDataProcessSegments(omdata_t *omdata)
+{
+	// Check each stream
+	int streamIndex;
 	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
 	{
 		omdata_stream_t *stream = &omdata->stream[streamIndex];
 		if (!stream->inUse) { continue; }
-		for (omdata_segment_t *seg = stream->segmentFirst; seg != NULL; seg = seg->segmentNext)
+		// Check each segment
+		omdata_segment_t *seg;
+		for (seg = stream->segmentFirst; seg != NULL; seg = seg->segmentNext)
 		{
-			for (int i = 0; i < seg->timestampCount; i++)
+			if (seg->sectorCount > 0 && seg->timestampCount > 0 && seg->description.sampleRate > 0)
 			{
-				omdata_segment_timestamp_t *ts = &seg->timestamps[i];
-				int sectorIndexOffset = ts->sample / seg->description.samplesPerSector;
-				if (sectorIndexOffset < 0 || sectorIndexOffset >= seg->sectorCount)
+				// Estimate segment start/stop time
+				// TODO: This estimate is from the configured sample rate (not observed rate)
+
+				// Start time
+				{
+					omdata_segment_timestamp_t first = OmDataSegmentTimestamp(seg, 0);
+					int index = first.sample;
+					double timestamp = first.timestamp;
+					seg->startTime = timestamp - (index / seg->description.sampleRate);
+				}
+
+				// End time
 				{
-					//fprintf(stderr, "WARNING: Sector index offset %d out of range (0-%d) for segment timestamp %d.\n", sectorIndexOffset, seg->sectorCount, i);
-					if (seg->sectorCount <= 0) continue;
-					sectorIndexOffset = seg->sectorCount - 1;
+					omdata_segment_timestamp_t last = OmDataSegmentTimestamp(seg, seg->timestampCount - 1);
+					int index = last.sample;
+					double timestamp = last.timestamp;
+					seg->endTime = timestamp + ((seg->description.numSamples - index) / seg->description.sampleRate);
 				}
-				int sector = seg->sectorIndex[sectorIndexOffset];
-				ts->timestamp += omdata->timestampOffset[sector];
+
+			}
+			else
+			{
+				seg->startTime = 0;
+				seg->endTime = 0;
 			}
 		}
 	}
 
-
-	if (dfp != NULL) { fclose(dfp); }
 	return 0;
 }
 
 
-int OmDataLoad(omdata_t *omdata, const char *filename)
+static int OmDataCalculateSessions(omdata_t *omdata, double sessionOverlap)
 {
-	unsigned char *buffer = NULL;
+	// Tracks segments within a stream
+	typedef struct 
+	{
+		bool trackerStarted;
+		bool segmentStarted;
+		omdata_segment_t *currentSegment;
+	} omdata_segment_tracker_t;
+	omdata_segment_tracker_t segmentTrackers[OMDATA_MAX_STREAM] = { { 0 } };
+	omdata_session_t *lastSession = NULL;
+	omdata_session_t *currentSession = NULL;
+	double currentTime = 0;
+	int pass;
+
+	// Find the sessions from the streams
+	for (pass = 0;; pass++)
+	{
+		(void)pass; // unused
+		// Check each stream
+		int streamIndex;
+		int nextSmallestIndex = -1;
+		int numStarted = 0;
+		double nextSmallestTime = 0;
+//fprintf(stderr, "--- PASS %d ---\n", pass);
+		for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+		{
+			omdata_stream_t *stream = &omdata->stream[streamIndex];
+			if (!stream->inUse) { continue; }
+
+			omdata_segment_tracker_t *tracker = &segmentTrackers[streamIndex];
+
+			// Check for initial condition
+			if (!tracker->trackerStarted)
+			{
+//fprintf(stderr, "(Stream %c reset to first segment @%p)\n", streamIndex, stream->segmentFirst);
+				tracker->currentSegment = stream->segmentFirst;
+				tracker->trackerStarted = true;
+			}
+
+//fprintf(stderr, "Stream %c: segmentStarted=%d, currentSegment.startTime=%f, currentSegment.endTime=%f\n", streamIndex, tracker->segmentStarted, tracker->currentSegment ? tracker->currentSegment->startTime : 0.0, tracker->currentSegment ? tracker->currentSegment->endTime : 0.0);
+
+
+			// Check for final condition
+			if (tracker->currentSegment == NULL)
+			{ 
+//fprintf(stderr, "(Stream %c finished - skipping)\n", streamIndex);
+				continue;
+			}
+			
+			// If this is not started, should we start it?
+			if (!tracker->segmentStarted && currentTime >= tracker->currentSegment->startTime)
+			{
+				tracker->segmentStarted = true;
+
+//fprintf(stderr, "... segmentStarted! (currentSession=%f)\n", currentSession ? currentSession->startTime : -1);
+
+				// We're recording a new segment -- check we have a current session
+				if (currentSession == NULL)
+				{
+					// Need to make a new session
+					currentSession = (omdata_session_t *)OmArenaAlloc(&omdata->segmentArena, sizeof(omdata_session_t));
+					memset(currentSession, 0, sizeof(omdata_session_t));
+//fprintf(stderr, "... new session!\n");
+
+					// If this is the first session one, set it
+					if (omdata->firstSession == NULL)
+					{
+						omdata->firstSession = currentSession;
+					}
+
+					// This is the first segment in the session, set the start and end time
+					currentSession->startTime = tracker->currentSegment->startTime;
+					currentSession->endTime = tracker->currentSegment->endTime;
+
+					// If this is not the first session, continue the chain
+					if (lastSession != NULL)
+					{
+						lastSession->sessionNext = currentSession;
+					}
+					lastSession = currentSession;
+				}
+
+				// We're recording a new segment -- add it to the chain
+				currentSession->stream[streamIndex].inUse = true;
+				if (currentSession->stream[streamIndex].segmentFirst == NULL)
+				{
+//fprintf(stderr, "... first segment in session's chain.\n");
+					currentSession->stream[streamIndex].segmentFirst = tracker->currentSegment;
+				}
+				// (if it's not the first, it will already be on the chain)
+				currentSession->stream[streamIndex].segmentLast = tracker->currentSegment;
+
+
+				// Update the start time if it's the earliest segment in the session
+
+				// If this segment started earlier than the earliest segment in the session, set the start time
+				if (tracker->currentSegment->startTime < currentSession->startTime)
+				{
+					currentSession->startTime = tracker->currentSegment->startTime;
+				}
+
+				// If this segment ended later than the latest segment in the session, set the end time
+				if (tracker->currentSegment->endTime > currentSession->endTime)
+				{
+					currentSession->endTime = tracker->currentSegment->endTime;
+				}
+
+			}
+			else if (tracker->segmentStarted && currentTime >= tracker->currentSegment->endTime) // If this has started, should we end it and move to the next segment?
+			{
+//fprintf(stderr, "... end segment.\n");
+				tracker->segmentStarted = false;
+				tracker->currentSegment = tracker->currentSegment->segmentNext;
+//if (tracker->currentSegment == NULL) { fprintf(stderr, "... LAST SEGMENT!\n"); }
+			}
+
+			// Count the number of started segments
+			if (tracker->segmentStarted) { numStarted++; }
+
+			// If there are more segments in the stream...
+			if (tracker->currentSegment != NULL)
+			{
+				// Find the next time to jump to
+				double nextTime = tracker->segmentStarted ? tracker->currentSegment->endTime : tracker->currentSegment->startTime;
+				if (nextTime < tracker->currentSegment->startTime) { nextTime = tracker->currentSegment->startTime; }	// Cope with an invalid range
+				if (nextTime > currentTime && (nextSmallestIndex < 0 || nextTime <= nextSmallestTime))	// Ensure going forwards
+				{
+					nextSmallestTime = nextTime;
+					nextSmallestIndex = streamIndex;
+				}
+			}
+
+		}
+
+//		fprintf(stderr, "==> %d active, current time %f, next time %f (%c)\n", numStarted, currentTime, nextSmallestTime, nextSmallestIndex);
+
+		// Check if we're at the end of a session
+		if (numStarted <= 0 && currentSession != NULL)
+		{
+			// Allow small gaps between segments (e.g. around a small area of corruption)
+			if ((nextSmallestTime - currentTime) >= sessionOverlap)
+			{
+//fprintf(stderr, "! Gap too large: breaking segment chains and clearing the current session.\n");
+
+				// Break the segment chains after the session's last segments (the trackers continue from the next segments, which start the next session)
+				for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+				{
+					omdata_stream_t *sessionStream = &currentSession->stream[streamIndex];
+					if (sessionStream->segmentLast != NULL)
+					{
+						sessionStream->segmentLast->segmentNext = NULL;
+					}
+				}
+
+				// We're no longer in a session
+				currentSession = NULL;
+			}
+		}
+
+		// Check for finished
+		if (nextSmallestIndex < 0) { break; }
+
+		// Advance time
+		currentTime = nextSmallestTime;
+	};
+
+	return 0;
+}
+
+
+int OmDataCanLoad(const char *filename)
+{
+	FILE *fp = fopen(filename, "rb");
+	if (fp == NULL) { return 0; }
+	//fseek(fp, 0, SEEK_END); long length = ftell(fp); fseek(fp, 0, SEEK_SET); buffer = (unsigned char *)malloc(length); if (buffer == NULL) { fclose(fp); return 0; }
+
+	char buffer[4] = { 0 };
+	if (fread(buffer, 1, sizeof(buffer), fp) != sizeof(buffer)) { fclose(fp); return 0; }
+	fclose(fp);
+
+	// Compressed file
+	if (OmGzipCheck(filename) && OmGzipPeek(filename, buffer, sizeof(buffer)) != sizeof(buffer)) { return 0; }
+
+	if (buffer[0] == 'M' && buffer[1] == 'D') { return 1; }
+	else if (buffer[0] == 'H' && buffer[1] == 'A') { return 1; }
+	else if (buffer[0] == 'd') { return 1; }
+	else if (buffer[1] == 'X') { return 1; }
+
+	return 0;
+}
+
+
+
+// A time slip found at a sector by the timestamp analysis (after step 2, the cumulative offset from that sector onwards)
+typedef struct
+{
+	int sector;
+	int order;			// Order found within the segment (to sum the slips at the same sector in the same order)
+	double offset;
+} omdata_timestamp_correction_t;
+
+// Drift analysis state within a segment (carried on when a segment continues from the sectors before a loaded range)
+typedef struct
+{
+	int count;							// Timestamps so far in the segment
+	int sampleOffset;					// Sample index within the whole segment of the first sample of the part being analysed
+	bool hasLast;
+	omdata_segment_timestamp_t last;	// Previous timestamp (sample index within the whole segment)
+	double startTime;
+	double slidingAverage;
+	double lastPeriod;
+	int stableSamples;
+	int order;
+} omdata_timestamp_drift_t;
+
+// Timestamp analysis worker (claims whole segments in turn)
+typedef struct
+{
+	omdata_segment_t **segments;
+	int segmentCount;
+	int *nextSegment;
+	pthread_mutex_t *mutex;
+	FILE *dfp;
+
+	// Step 1 results
+	omdata_timestamp_correction_t *corrections;
+	int correctionCount;
+	int correctionCapacity;
+	double worstDifference;
+	double affectedT;
+
+	// Step 1 state for a segment that continues from before the loaded range (NULL if none)
+	const omdata_segment_t *continuedSegment;
+	const omdata_timestamp_drift_t *continuedDrift;
+
+	// Step 3 cumulative offsets (shared, in sector order)
+	const omdata_timestamp_correction_t *offsets;
+	int offsetCount;
+
+	pthread_t thread;
+	bool started;
+} omdata_timestamp_worker_t;
+
+// Next segment for a worker (NULL when there are none left)
+static omdata_segment_t *OmDataTimestampWorkerNext(omdata_timestamp_worker_t *worker)
+{
+	pthread_mutex_lock(worker->mutex);
+	int index = (*worker->nextSegment)++;
+	pthread_mutex_unlock(worker->mutex);
+	return (index < worker->segmentCount) ? worker->segments[index] : NULL;
+}
+
+// Sector of a segment timestamp (-1 if the segment has no sectors)
+static int OmDataTimestampSector(const omdata_segment_t *seg, const omdata_segment_timestamp_t *ts)
+{
+	int sectorIndexOffset = ts->sample / seg->description.samplesPerSector;
+	if (sectorIndexOffset < 0 || sectorIndexOffset >= seg->sectorCount)
+	{
+		//fprintf(stderr, "WARNING: Sector index offset %d out of range (0-%d) for segment timestamp.\n", sectorIndexOffset, seg->sectorCount);
+		if (seg->sectorCount <= 0) return -1;
+		sectorIndexOffset = seg->sectorCount - 1;
+	}
+	return seg->sectorIndex[sectorIndexOffset];
+}
+
+// Step 1 for the timestamps of a segment (or of a part of one, continuing the drift state)
+static void OmDataTimestampDrift(omdata_timestamp_worker_t *worker, omdata_segment_t *seg, omdata_timestamp_drift_t *drift)
+{
+	FILE *dfp = worker->dfp;
+	int i;
+	// Note seg->startTime and seg->endTime not yet valid
+//	fprintf(stderr, ">>> %d samples in %d sectors with %d timestamps.\n", seg->numSamples, seg->sectorCount, seg->timestampCount);
+	for (i = 0; i < seg->timestampCount; i++)
+	{
+		omdata_segment_timestamp_t *ts = &seg->timestamps[i];
+		if (seg->sectorCount <= 0) continue;
+
+		omdata_segment_timestamp_t current = *ts;
+		current.sample += drift->sampleOffset;
+		// A single scan does not add a timestamp at the same sample index as the previous one
+		if (drift->hasLast && current.sample == drift->last.sample) { continue; }
+
+		if (drift->startTime == 0) { drift->startTime = current.timestamp; }
+		if (drift->hasLast && current.sample > drift->last.sample)
+		{
+			double relT = current.timestamp - drift->startTime;
+			int deltaI = current.sample - drift->last.sample;
+			double deltaT = current.timestamp - drift->last.timestamp;
+			double period = deltaT / deltaI;
+			double freq = deltaI / deltaT;
+			if (dfp != NULL) { fprintf(dfp, "%d,%f,%d,%f,%f\n", current.sample, relT, deltaI, deltaT, freq); }
+
+			double allowance = 0.006 * drift->slidingAverage;
+			double fade = 0.05 * deltaT;
+			double diff = drift->slidingAverage - period;
+
+if (diff / drift->slidingAverage > worker->worstDifference) { worker->worstDifference = diff / drift->slidingAverage; }
+
+			if (drift->count <= 1) { drift->slidingAverage = period; }
+			else if (fabs(drift->lastPeriod - period) < allowance) 
+			{
+				drift->stableSamples += deltaI;
+			}
+			else 
+			{ 
+				drift->stableSamples = 0;
+			}
+
+			if (fabs(diff) > allowance && relT > 90.0)
+			{
+				double timeslip = diff * deltaI;
+				if (worker->correctionCount >= worker->correctionCapacity)
+				{
+					int capacity = 2 * worker->correctionCapacity + 64;
+					omdata_timestamp_correction_t *corrections = (omdata_timestamp_correction_t *)realloc(worker->corrections, capacity * sizeof(omdata_timestamp_correction_t));
+					if (corrections == NULL) { fprintf(stderr, "ERROR: Problem growing the timestamp corrections.\n"); drift->count++; continue; }
+					worker->corrections = corrections;
+					worker->correctionCapacity = capacity;
+				}
+				omdata_timestamp_correction_t *correction = &worker->corrections[worker->correctionCount++];
+				correction->sector = OmDataTimestampSector(seg, ts);
+				correction->order = drift->order++;
+				correction->offset = timeslip;
+//				printf("%02d:%02d:%02d.%02d,%f,%f,%d,%f\n", (int)relT / 60 / 60, ((int)relT / 60) % 60, (int)relT % 60, (int)((relT - (int)relT) * 100), drift->slidingAverage, period, correction->sector, timeslip);
+				drift->stableSamples = 0;
+				worker->affectedT += deltaT;
+			}
+
+			if (drift->stableSamples > 10 * seg->description.sampleRate)
+			{
+				drift->slidingAverage = ((1 - fade) * drift->slidingAverage) + (fade * period);
+			}
+
+
+			drift->lastPeriod = period;
+		}
+		drift->last = current;
+		drift->hasLast = true;
+		drift->count++;
+	}
+}
+
+// Step 1. Determine any oscillator non-uniformity by looking at sample period (for each segment)
+static void *OmDataTimestampDriftWorker(void *arg)
+{
+	omdata_timestamp_worker_t *worker = (omdata_timestamp_worker_t *)arg;
+	omdata_segment_t *seg;
+	while ((seg = OmDataTimestampWorkerNext(worker)) != NULL)
+	{
+		omdata_timestamp_drift_t drift = { 0 };
+		if (seg == worker->continuedSegment && worker->continuedDrift != NULL) { drift = *worker->continuedDrift; }
+		OmDataTimestampDrift(worker, seg, &drift);
+	}
+	return NULL;
+}
+
+#define OMDATA_LEAD_IN_CHUNK_SECTORS (16 * OMDATA_SCAN_CHUNK_SECTORS)	// Sectors before a loaded range that are scanned at a time for their timestamps
+
+// Step 1 for the accelerometer sectors before a loaded range (their corrections carry on in to the range): the sectors are scanned in chunks whose tables are discarded, keeping only the drift state of the last segment
+static void OmDataTimestampLeadIn(omdata_t *omdata, int sectorStartIndex, int sectorEndIndex, omdata_timestamp_worker_t *worker, omdata_timestamp_drift_t *drift, bool *continues)
+{
+	*continues = false;
+	if (sectorEndIndex <= sectorStartIndex) { return; }
+
+	omdata_t *scan = (omdata_t *)calloc(1, sizeof(omdata_t));
+	if (scan == NULL) { fprintf(stderr, "ERROR: Problem allocating the timestamp lead-in.\n"); return; }
+
+	// The stream and the last segment so far (only the fields needed to check whether the next chunk continues it)
+	omdata_stream_t stream = { 0 };
+	omdata_segment_t last;
+	memset(&last, 0, sizeof(last));
+
+	int i;
+	for (i = sectorStartIndex; i < sectorEndIndex; i += OMDATA_LEAD_IN_CHUNK_SECTORS)
+	{
+		int count = (sectorEndIndex - i < OMDATA_LEAD_IN_CHUNK_SECTORS) ? (sectorEndIndex - i) : OMDATA_LEAD_IN_CHUNK_SECTORS;
+		memset(scan->stream, 0, sizeof(scan->stream));
+		scan->buffer = omdata->buffer;
+		scan->length = omdata->length;
+		scan->store = omdata->store;
+		scan->partial = true;
+		OmDataArenaInit(scan, count);
+		OmDataProcessSectors(scan, i, count);
+
+		omdata_stream_t *scanStream = &scan->stream['a'];
+		if (scanStream->inUse)
+		{
+			omdata_segment_t *seg;
+			for (seg = scanStream->segmentFirst; seg != NULL; seg = seg->segmentNext)
+			{
+				if (seg == scanStream->segmentFirst && stream.inUse && OmDataSegmentContinues(&stream, scanStream) && (int64_t)last.description.numSamples + seg->description.numSamples <= OMDATA_MAX_SEGMENT_SAMPLES)
+				{
+					// Continue the last segment
+					drift->sampleOffset = last.sectorCount * last.description.samplesPerSector;
+					OmDataTimestampDrift(worker, seg, drift);
+					last.sectorCount += seg->sectorCount;
+					last.description.numSamples += seg->description.numSamples;
+					last.lastPacketShort = seg->lastPacketShort;
+				}
+				else
+				{
+					memset(drift, 0, sizeof(*drift));
+					OmDataTimestampDrift(worker, seg, drift);
+					last = *seg;
+				}
+			}
+			if (!stream.inUse) { stream.firstSequenceId = scanStream->firstSequenceId; }
+			stream.inUse = true;
+			stream.lastSequenceId = scanStream->lastSequenceId;
+			stream.segmentFirst = &last;
+			stream.segmentLast = &last;
+		}
+
+		OmDataArenaFree(scan);
+	}
+	free(scan);
+
+	// Whether the first accelerometer segment of the loaded range continues the last one
+	omdata_stream_t *loaded = &omdata->stream['a'];
+	if (stream.inUse && loaded->inUse && OmDataSegmentContinues(&stream, loaded) && (int64_t)last.description.numSamples + loaded->segmentFirst->description.numSamples <= OMDATA_MAX_SEGMENT_SAMPLES)
+	{
+		drift->sampleOffset = last.sectorCount * last.description.samplesPerSector;
+		*continues = true;
+	}
+}
+
+// Step 3. Apply the cumulative offsets to the timestamps (for each segment)
+static void *OmDataTimestampApplyWorker(void *arg)
+{
+	omdata_timestamp_worker_t *worker = (omdata_timestamp_worker_t *)arg;
+	omdata_segment_t *seg;
+	while ((seg = OmDataTimestampWorkerNext(worker)) != NULL)
+	{
+		for (int i = 0; i < seg->timestampCount; i++)
+		{
+			omdata_segment_timestamp_t *ts = &seg->timestamps[i];
+			int sector = OmDataTimestampSector(seg, ts);
+			if (sector < 0) continue;
+
+			// Last correction at or before the sector
+			int lo = 0, hi = worker->offsetCount;
+			while (lo < hi)
+			{
+				int mid = lo + (hi - lo) / 2;
+				if (worker->offsets[mid].sector <= sector) { lo = mid + 1; } else { hi = mid; }
+			}
+			if (lo > 0) { ts->timestamp += worker->offsets[lo - 1].offset; }
+		}
+	}
+	return NULL;
+}
+
+// Run the workers over the segments (the first on this thread, any that fail to start leave their segments to the others)
+static void OmDataTimestampWorkersRun(omdata_timestamp_worker_t *workers, int threads, void *(*function)(void *))
+{
+	int i;
+	for (i = 1; i < threads; i++)
+	{
+		workers[i].started = (pthread_create(&workers[i].thread, NULL, function, &workers[i]) == 0);
+	}
+	function(&workers[0]);
+	for (i = 1; i < threads; i++)
+	{
+		if (workers[i].started) { pthread_join(workers[i].thread, NULL); }
+		workers[i].started = false;
+	}
+}
+
+static int OmDataTimestampCorrectionCompare(const void *a, const void *b)
+{
+	const omdata_timestamp_correction_t *ca = (const omdata_timestamp_correction_t *)a;
+	const omdata_timestamp_correction_t *cb = (const omdata_timestamp_correction_t *)b;
+	if (ca->sector != cb->sector) { return (ca->sector < cb->sector) ? -1 : 1; }
+	return ca->order - cb->order;
+}
+
+
+// Correct the timestamps for any oscillator drift (sectors from leadInStartIndex to leadInEndIndex, before the loaded range, are only analysed so that their corrections carry on)
+char OmDataAnalyzeTimestamps(omdata_t *omdata, int leadInStartIndex, int leadInEndIndex, int threads)
+{
+	if (omdata == NULL) { return -1; }
+
+	FILE *dfp = NULL;
+#if 0
+	dfp = fopen("/temp/times.csv", "wt");
+	fprintf(stderr, "NOTE: Writing timestamp log file...\n");
+	threads = 1;
+#endif
+	//if (dfp == NULL) { return -1; }
+
+	// Segments of all streams (those of the accelerometer stream first)
+	int streamIndex;
+	int segmentCount = 0, accelSegmentCount = 0;
+	omdata_segment_t *seg;
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		if (!omdata->stream[streamIndex].inUse) { continue; }
+		for (seg = omdata->stream[streamIndex].segmentFirst; seg != NULL; seg = seg->segmentNext) { segmentCount++; }
+	}
+	if (segmentCount <= 0) { return 0; }
+	omdata_segment_t **segments = (omdata_segment_t **)malloc(segmentCount * sizeof(omdata_segment_t *));
+	if (segments == NULL) { return -1; }
+	int count = 0;
+	if (omdata->stream['a'].inUse)
+	{
+		for (seg = omdata->stream['a'].segmentFirst; seg != NULL; seg = seg->segmentNext) { segments[count++] = seg; }
+	}
+	accelSegmentCount = count;
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		if (!omdata->stream[streamIndex].inUse || streamIndex == 'a') { continue; }
+		for (seg = omdata->stream[streamIndex].segmentFirst; seg != NULL; seg = seg->segmentNext) { segments[count++] = seg; }
+	}
+
+	if (threads > segmentCount) { threads = segmentCount; }
+	if (threads < 1) { threads = 1; }
+	omdata_timestamp_worker_t *workers = (omdata_timestamp_worker_t *)calloc(threads, sizeof(omdata_timestamp_worker_t));
+	if (workers == NULL) { free(segments); return -1; }
+	int nextSegment = 0;
+	pthread_mutex_t mutex;
+	pthread_mutex_init(&mutex, NULL);
+	int i;
+	for (i = 0; i < threads; i++)
+	{
+		workers[i].segments = segments;
+		workers[i].segmentCount = accelSegmentCount;	// Only run on one channel of accel
+		workers[i].nextSegment = &nextSegment;
+		workers[i].mutex = &mutex;
+		workers[i].dfp = dfp;
+	}
+
+	// Step 1 for the sectors before the loaded range (on the first worker), and whether the first accelerometer segment carries on from them
+	omdata_timestamp_drift_t leadInDrift = { 0 };
+	bool continues = false;
+	OmDataTimestampLeadIn(omdata, leadInStartIndex, leadInEndIndex, &workers[0], &leadInDrift, &continues);
+	if (continues)
+	{
+		for (i = 0; i < threads; i++)
+		{
+			workers[i].continuedSegment = omdata->stream['a'].segmentFirst;
+			workers[i].continuedDrift = &leadInDrift;
+		}
+	}
+
+	// Step 1. Determine any oscillator non-uniformity by looking at sample period (segments in parallel)
+	OmDataTimestampWorkersRun(workers, (accelSegmentCount < threads) ? accelSegmentCount : threads, OmDataTimestampDriftWorker);
+
+	// Step 2. Cumulative sum of any timestamp offsets (a sparse list of the sectors with corrections, rather than every sector)
+	int correctionCount = 0;
+	double worstDifference = 0.0f;
+	double affectedT = 0;
+	for (i = 0; i < threads; i++)
+	{
+		correctionCount += workers[i].correctionCount;
+		if (workers[i].worstDifference > worstDifference) { worstDifference = workers[i].worstDifference; }
+		affectedT += workers[i].affectedT;
+	}
+	omdata_timestamp_correction_t *offsets = NULL;
+	int offsetCount = 0;
+	if (correctionCount > 0)
+	{
+		offsets = (omdata_timestamp_correction_t *)malloc(correctionCount * sizeof(omdata_timestamp_correction_t));
+		if (offsets != NULL)
+		{
+			for (i = 0; i < threads; i++)
+			{
+				if (workers[i].correctionCount > 0) { memcpy(offsets + offsetCount, workers[i].corrections, workers[i].correctionCount * sizeof(omdata_timestamp_correction_t)); }
+				offsetCount += workers[i].correctionCount;
+			}
+			qsort(offsets, offsetCount, sizeof(omdata_timestamp_correction_t), OmDataTimestampCorrectionCompare);
+
+			// Total the slips at each sector, then the cumulative sum
+			double cumulativeOffset = 0;
+			int n = 0;
+			for (i = 0; i < offsetCount; i++)
+			{
+				double sectorOffset = 0;
+				int sector = offsets[i].sector;
+				for (; i < offsetCount && offsets[i].sector == sector; i++) { sectorOffset += offsets[i].offset; }
+				i--;
+				cumulativeOffset += sectorOffset;
+				offsets[n].sector = sector;
+				offsets[n].offset = cumulativeOffset;
+				n++;
+			}
+			offsetCount = n;
+#if DEBUG_OMDATA >= 1
+			if (cumulativeOffset > 0.0) { fprintf(stderr, "DEBUG: Cumulative offset %f over %f (worst prop diff %f)\n", cumulativeOffset, affectedT, worstDifference); }
+#endif
+		}
+		else
+		{
+			fprintf(stderr, "ERROR: Problem allocating the timestamp corrections.\n");
+		}
+	}
+	for (i = 0; i < threads; i++) { free(workers[i].corrections); }
+
+	// Step 3. Apply any offsets to all streams (segments in parallel)
+	if (offsetCount > 0)
+	{
+		nextSegment = 0;
+		for (i = 0; i < threads; i++)
+		{
+			workers[i].segmentCount = segmentCount;
+			workers[i].offsets = offsets;
+			workers[i].offsetCount = offsetCount;
+		}
+		OmDataTimestampWorkersRun(workers, threads, OmDataTimestampApplyWorker);
+	}
+
+	pthread_mutex_destroy(&mutex);
+	free(offsets);
+	free(workers);
+	free(segments);
+
+	if (dfp != NULL) { fclose(dfp); }
+	return 0;
+}
+
+
+// Stream of a data sector with a good checksum (0 if not a good data sector)
+static char OmDataGoodDataSector(const unsigned char *p)
+{
+	char streamIndex;
+	if ((p[0] == 'A' || p[0] == 'G' || p[0] == 'M') && p[1] == 'X') { streamIndex = p[0] - 'A' + 'a'; }		// CWA Data
+	else if (p[0] == 'd') { streamIndex = p[1]; }															// OMX Data
+	else { return 0; }
+	if (OmDataSectorChecksum(p) != 0) { return 0; }
+	return streamIndex;
+}
+
+// Time of the first data sector with a good checksum at or after a sector (-1 if none before the end index)
+static double OmDataNextSectorTime(omdata_t *omdata, int sectorIndex, int sectorEndIndex)
+{
+	int i;
+	for (i = sectorIndex; i < sectorEndIndex; i++)
+	{
+		char streamIndex = OmDataGoodDataSector(OmDataSector(omdata, i));
+		if (streamIndex == 0) { continue; }
+		double t = OmDataTimestampForSector(omdata, i, streamIndex, NULL);
+		if (t <= 0) { continue; }
+		return t;
+	}
+	return -1;
+}
+
+// Binary search for the first sector from which all data sectors are at or after a time (data sectors are written in time order)
+static int OmDataFindSectorForTime(omdata_t *omdata, int sectorStartIndex, int sectorEndIndex, double t)
+{
+	int lo = sectorStartIndex, hi = sectorEndIndex;
+	while (lo < hi)
+	{
+		int mid = lo + (hi - lo) / 2;
+		double sectorTime = OmDataNextSectorTime(omdata, mid, sectorEndIndex);
+		if (sectorTime >= 0 && sectorTime < t) { lo = mid + 1; } else { hi = mid; }
+	}
+	return lo;
+}
+
+#define OMDATA_WINDOW_MARGIN 60.0			// Seconds of data loaded either side of a time window (so that the edges can be interpolated and have whole timestamps)
+#define OMDATA_WINDOW_MARGIN_SECTORS 2		// Sectors loaded either side of the window's search results (sector timestamps may be part-way through a sector)
+
+// Number of sectors in the file header (0 if none)
+static int OmDataHeaderSectors(omdata_t *omdata, int sectorCount)
+{
+	int headerSectors = 0;
+	if (sectorCount > 0)
+	{
+		const unsigned char *p = OmDataSector(omdata, 0);
+		if ((p[0] == 'M' && p[1] == 'D') || (p[0] == 'H' && p[1] == 'A'))
+		{
+			headerSectors = ((((uint16_t)p[3] << 8) | (uint16_t)p[2]) + 4 + OMDATA_SECTOR_SIZE - 1) / OMDATA_SECTOR_SIZE;
+			if (headerSectors > sectorCount) { headerSectors = sectorCount; }
+		}
+	}
+	return headerSectors;
+}
+
+// Find the range of sectors to load for a time window (excluding the file header)
+static void OmDataFindWindow(omdata_t *omdata, int sectorCount, double startTime, double stopTime, int *headerCount, int *firstSector, int *lastSector)
+{
+	// Skip the file header
+	int headerSectors = OmDataHeaderSectors(omdata, sectorCount);
+
+	int first = headerSectors, last = sectorCount;
+	if (startTime > 0)
+	{
+		first = OmDataFindSectorForTime(omdata, headerSectors, sectorCount, startTime - OMDATA_WINDOW_MARGIN) - OMDATA_WINDOW_MARGIN_SECTORS;
+		if (first < headerSectors) { first = headerSectors; }
+	}
+	if (stopTime > 0)
+	{
+		last = OmDataFindSectorForTime(omdata, first, sectorCount, stopTime + OMDATA_WINDOW_MARGIN) + OMDATA_WINDOW_MARGIN_SECTORS;
+		if (last > sectorCount) { last = sectorCount; }
+	}
+	*headerCount = headerSectors;
+	*firstSector = first;
+	*lastSector = last;
+}
+
+
+#define OMDATA_METADATA_SCAN_SECTORS 1024		// Sectors checked back from the end of the file for the last data sector (before searching for it)
+#define OMDATA_METADATA_BUDGET (256 * 1024)		// Windowed reading budget when only loading the metadata
+
+// Last good data sector in a range, checked back from the end of the range (-1 if none)
+static int OmDataPreviousDataSector(omdata_t *omdata, int sectorStartIndex, int sectorEndIndex)
+{
+	int i;
+	for (i = sectorEndIndex - 1; i >= sectorStartIndex; i--)
+	{
+		if (OmDataGoodDataSector(OmDataSector(omdata, i)) != 0) { return i; }
+	}
+	return -1;
+}
+
+// First good data sector in a range (-1 if none)
+static int OmDataNextDataSector(omdata_t *omdata, int sectorStartIndex, int sectorEndIndex)
+{
+	int i;
+	for (i = sectorStartIndex; i < sectorEndIndex; i++)
+	{
+		if (OmDataGoodDataSector(OmDataSector(omdata, i)) != 0) { return i; }
+	}
+	return -1;
+}
+
+// Times of the first and last samples in a data sector (returns the sample rate)
+static double OmDataSectorSampleTimes(omdata_t *omdata, int sectorIndex, char streamIndex, double *firstTime, double *lastTime)
+{
+	const unsigned char *p = OmDataSector(omdata, sectorIndex);
+	int sampleCount = (p[1] == 'X') ? READ_UINT16(p + 28) : READ_UINT16(p + 22);	// CWA@28 / OMX@22 sampleCount
+	double freq = OmDataSampleRate(p, streamIndex, NULL, NULL);
+	if (freq <= 0) { freq = 1; }
+	int timestampOffset = 0;
+	double t = OmDataTimestampForSector(omdata, sectorIndex, streamIndex, &timestampOffset);
+	*firstTime = t - timestampOffset / freq;
+	*lastTime = t + (sampleCount - 1 - timestampOffset) / freq;
+	return freq;
+}
+
+double OmDataSectorStartTime(omdata_t *omdata, int sectorIndex)
+{
+	const unsigned char *p = OmDataSector(omdata, sectorIndex);
+	char streamIndex = (p[1] == 'X') ? (p[0] - 'A' + 'a') : p[1];	// CWA / OMX
+	double firstTime, lastTime;
+	OmDataSectorSampleTimes(omdata, sectorIndex, streamIndex, &firstTime, &lastTime);
+	return firstTime;
+}
+
+// Load only the header and the times of the first and last samples (without scanning the data sectors between)
+static void OmDataLoadMetadata(omdata_t *omdata, int sectorCount)
+{
+	int headerSectors = OmDataHeaderSectors(omdata, sectorCount);
+	if (headerSectors > 0)
+	{
+		OmDataProcessSectors(omdata, 0, headerSectors);
+	}
+	omdata->statsTotalSectors = sectorCount;
+
+	// The data is normally directly after the header
+	int first = OmDataNextDataSector(omdata, headerSectors, sectorCount);
+	if (first < 0) { fprintf(stderr, "OMDATA: No data sectors.\n"); return; }
+
+	// Check back from the end, otherwise search for the end of the data (where there are no more data sectors within the scan distance)
+	int end = (sectorCount - first > OMDATA_METADATA_SCAN_SECTORS) ? sectorCount - OMDATA_METADATA_SCAN_SECTORS : first;
+	int last = OmDataPreviousDataSector(omdata, end, sectorCount);
+	if (last < 0)
+	{
+		int lo = first, hi = end;
+		while (lo < hi)
+		{
+			int mid = lo + (hi - lo + 1) / 2;
+			int midEnd = (sectorCount - mid > OMDATA_METADATA_SCAN_SECTORS) ? mid + OMDATA_METADATA_SCAN_SECTORS : sectorCount;
+			if (OmDataNextDataSector(omdata, mid, midEnd) >= 0) { lo = mid; } else { hi = mid - 1; }
+		}
+		last = OmDataPreviousDataSector(omdata, lo, (sectorCount - lo > OMDATA_METADATA_SCAN_SECTORS) ? lo + OMDATA_METADATA_SCAN_SECTORS : sectorCount);
+	}
+	fprintf(stderr, "OMDATA: Data sectors @%d-%d.\n", first, last);
+
+	double unused;
+	OmDataSectorSampleTimes(omdata, first, OmDataGoodDataSector(OmDataSector(omdata, first)), &omdata->firstSampleTime, &unused);
+	OmDataSectorSampleTimes(omdata, last, OmDataGoodDataSector(OmDataSector(omdata, last)), &unused, &omdata->lastSampleTime);
+}
+
+
+#define OMDATA_VERIFY_GAP 1.5		// Seconds of unexpected time between a stream's consecutive sectors that is reported as a gap (timestamps may only have whole seconds)
+
+// Create empty integrity check results
+static omdata_verify_t *OmDataVerifyCreate(void)
+{
+	omdata_verify_t *verify = (omdata_verify_t *)calloc(1, sizeof(omdata_verify_t));
+	if (verify == NULL) { return NULL; }
+	int s;
+	for (s = 0; s < OMDATA_MAX_STREAM; s++) { verify->stream[s].firstSector = -1; }
+	return verify;
+}
+
+static void OmDataVerifyFree(omdata_verify_t *verify)
+{
+	if (verify == NULL) { return; }
+	free(verify->issues);
+	free(verify);
+}
+
+// Add an integrity check issue (a bad sector directly after a run of bad sectors extends the run)
+static void OmDataVerifyIssue(omdata_verify_t *verify, char type, char stream, int sector, int count, double time, double value)
+{
+	if (type == 'b' && verify->issueCount > 0)
+	{
+		omdata_issue_t *last = &verify->issues[verify->issueCount - 1];
+		if (last->type == 'b' && last->sector + last->count == sector) { last->count += count; return; }
+	}
+	if (verify->issueCount >= verify->issueCapacity)
+	{
+		int capacity = 2 * verify->issueCapacity + 64;
+		omdata_issue_t *issues = (omdata_issue_t *)realloc(verify->issues, capacity * sizeof(omdata_issue_t));
+		if (issues == NULL) { fprintf(stderr, "ERROR: Problem growing the issue list.\n"); return; }
+		verify->issues = issues;
+		verify->issueCapacity = capacity;
+	}
+	omdata_issue_t *issue = &verify->issues[verify->issueCount++];
+	issue->type = type;
+	issue->stream = stream;
+	issue->sector = sector;
+	issue->count = count;
+	issue->time = time;
+	issue->value = value;
+}
+
+// Check that a sector follows on from the stream's previous sector
+static void OmDataVerifyContinuity(omdata_verify_t *verify, const omdata_verify_stream_t *state, char stream, int sector, uint32_t sequenceId, uint32_t config, double time, double rate)
+{
+	if (sequenceId != state->lastSequenceId + 1)
+	{
+		OmDataVerifyIssue(verify, 's', stream, sector, 1, time, (double)(int32_t)(sequenceId - state->lastSequenceId - 1));
+	}
+	double gap = time - state->expectedTime;
+	if (gap > OMDATA_VERIFY_GAP || gap < -OMDATA_VERIFY_GAP)
+	{
+		OmDataVerifyIssue(verify, 'g', stream, sector, 1, time, gap);
+	}
+	if (config != state->lastConfig)
+	{
+		OmDataVerifyIssue(verify, 'c', stream, sector, 1, time, rate);
+	}
+}
+
+// Check the integrity of a range of sectors (in to the data's results)
+static void OmDataVerifySectors(omdata_t *omdata, int sectorStartIndex, int sectorCount)
+{
+	omdata_verify_t *verify = omdata->verify;
+	int i;
+	for (i = sectorStartIndex; i < sectorStartIndex + sectorCount; i++)
+	{
+		const unsigned char *p = OmDataSector(omdata, i);
+		char streamIndex = OmDataGoodDataSector(p);
+		if (streamIndex <= 0)
+		{
+			// Other sectors (e.g. strings) only need a valid header and checksum
+			if (p[0] >= 32 && p[0] < 128 && p[1] >= 32 && p[1] < 128 && p[1] != 'X' && p[0] != 'd' && OmDataSectorChecksum(p) == 0) { continue; }
+			verify->badSectors++;
+			OmDataVerifyIssue(verify, 'b', 0, i, 1, 0, 0);
+			continue;
+		}
+		verify->dataSectors++;
+
+		uint32_t sequenceId, config;
+		if (p[1] == 'X')	// CWA
+		{
+			sequenceId = READ_UINT32(p + 10);						// CWA@10 sequenceId
+			config = READ_UINT16(p + 24);							// CWA@24 sampleRate, @25 numAxesBPS
+		}
+		else				// OMX
+		{
+			sequenceId = READ_UINT32(p + 4);						// OMX@4 sequenceId
+			config = READ_UINT16(p + 16) | ((uint32_t)p[18] << 16) | ((uint32_t)p[21] << 24);	// OMX@16 sampleRate, @18 sampleRateModifier, @21 channelPacking
+		}
+		double firstTime, lastTime;
+		double rate = OmDataSectorSampleTimes(omdata, i, streamIndex, &firstTime, &lastTime);
+
+		omdata_verify_stream_t *state = &verify->stream[(int)streamIndex];
+		if (state->firstSector < 0)
+		{
+			state->firstSector = i;
+			state->firstTime = firstTime;
+			state->firstSequenceId = sequenceId;
+			state->firstConfig = config;
+			state->firstRate = rate;
+		}
+		else
+		{
+			OmDataVerifyContinuity(verify, state, streamIndex, i, sequenceId, config, firstTime, rate);
+		}
+		state->sectorCount++;
+		state->lastSequenceId = sequenceId;
+		state->lastConfig = config;
+		state->expectedTime = lastTime + 1 / rate;
+	}
+}
+
+static void *OmDataVerifyWorker(void *arg)
+{
+	omdata_scan_worker_t *worker = (omdata_scan_worker_t *)arg;
+	OmDataVerifySectors(worker->omdata, worker->sectorStartIndex, worker->sectorCount);
+	return NULL;
+}
+
+// Append the results of the following range of sectors
+static void OmDataVerifyAppend(omdata_verify_t *verify, const omdata_verify_t *next)
+{
+	int i;
+	for (i = 0; i < next->issueCount; i++)
+	{
+		const omdata_issue_t *issue = &next->issues[i];
+		OmDataVerifyIssue(verify, issue->type, issue->stream, issue->sector, issue->count, issue->time, issue->value);
+	}
+	verify->badSectors += next->badSectors;
+	verify->dataSectors += next->dataSectors;
+
+	// Continuity of each stream across the boundary
+	int s;
+	for (s = 0; s < OMDATA_MAX_STREAM; s++)
+	{
+		omdata_verify_stream_t *state = &verify->stream[s];
+		const omdata_verify_stream_t *nextState = &next->stream[s];
+		if (nextState->firstSector < 0) { continue; }
+		if (state->firstSector < 0) { *state = *nextState; continue; }
+		OmDataVerifyContinuity(verify, state, (char)s, nextState->firstSector, nextState->firstSequenceId, nextState->firstConfig, nextState->firstTime, nextState->firstRate);
+		state->sectorCount += nextState->sectorCount;
+		state->lastSequenceId = nextState->lastSequenceId;
+		state->lastConfig = nextState->lastConfig;
+		state->expectedTime = nextState->expectedTime;
+	}
+}
+
+static int OmDataVerifyIssueCompare(const void *a, const void *b)
+{
+	const omdata_issue_t *ia = (const omdata_issue_t *)a;
+	const omdata_issue_t *ib = (const omdata_issue_t *)b;
+	if (ia->sector != ib->sector) { return (ia->sector < ib->sector) ? -1 : 1; }
+	// At the same sector, in the order they are checked
+	static const char order[] = "bsgc";
+	return (int)(strchr(order, ia->type) - order) - (int)(strchr(order, ib->type) - order);
+}
+
+// Check the integrity of sectors using multiple threads (each range is checked separately, then the results are appended in order)
+static int OmDataVerifyParallel(omdata_t *omdata, int sectorStartIndex, int sectorCount, int threads)
+{
+	if (threads > sectorCount / OMDATA_SCAN_MIN_SECTORS) { threads = sectorCount / OMDATA_SCAN_MIN_SECTORS; }
+	if (threads < 1) { threads = 1; }
+	omdata_scan_worker_t *workers = (threads > 1) ? (omdata_scan_worker_t *)calloc(threads, sizeof(omdata_scan_worker_t)) : NULL;
+	if (workers == NULL)
+	{
+		OmDataVerifySectors(omdata, sectorStartIndex, sectorCount);
+		return 0;
+	}
+
+	fprintf(stderr, "OMDATA: Verifying with %d threads...\n", threads);
+
+	// A windowed reader's budget is shared between the threads
+	size_t budget = OmStoreBudget(omdata->store);
+	OmStoreSetBudget(omdata->store, budget / threads);
+
+	int i;
+	for (i = 0; i < threads; i++)
+	{
+		omdata_scan_worker_t *worker = &workers[i];
+		worker->sectorStartIndex = sectorStartIndex + (int)((long long)sectorCount * i / threads);
+		worker->sectorCount = sectorStartIndex + (int)((long long)sectorCount * (i + 1) / threads) - worker->sectorStartIndex;
+		if (i == 0) { worker->omdata = omdata; continue; }
+
+		worker->omdata = (omdata_t *)calloc(1, sizeof(omdata_t));
+		if (worker->omdata == NULL) { continue; }
+		worker->omdata->buffer = omdata->buffer;
+		worker->omdata->length = omdata->length;
+		if (omdata->store != NULL)
+		{
+			worker->omdata->store = OmStoreReopen(omdata->store, budget / threads);
+			if (worker->omdata->store == NULL) { continue; }
+		}
+		worker->omdata->verify = OmDataVerifyCreate();
+		if (worker->omdata->verify == NULL) { continue; }
+		worker->started = (pthread_create(&worker->thread, NULL, OmDataVerifyWorker, worker) == 0);
+	}
+
+	// The first range is checked on this thread
+	OmDataVerifyWorker(&workers[0]);
+
+	for (i = 1; i < threads; i++)
+	{
+		omdata_scan_worker_t *worker = &workers[i];
+		if (worker->started)
+		{
+			pthread_join(worker->thread, NULL);
+			OmDataVerifyAppend(omdata->verify, worker->omdata->verify);
+		}
+		else
+		{
+			// No thread for this range, check it directly
+			omdata_verify_t *verify = omdata->verify;
+			omdata->verify = OmDataVerifyCreate();
+			if (omdata->verify != NULL)
+			{
+				OmDataVerifySectors(omdata, worker->sectorStartIndex, worker->sectorCount);
+				OmDataVerifyAppend(verify, omdata->verify);
+				OmDataVerifyFree(omdata->verify);
+			}
+			omdata->verify = verify;
+		}
+		if (worker->omdata != NULL)
+		{
+			OmDataVerifyFree(worker->omdata->verify);
+			OmStoreClose(worker->omdata->store);
+		}
+		free(worker->omdata);
+	}
+
+	OmStoreSetBudget(omdata->store, budget);
+	free(workers);
+
+	// Issues at the boundaries were appended after the following range's own issues
+	omdata_verify_t *verify = omdata->verify;
+	qsort(verify->issues, verify->issueCount, sizeof(omdata_issue_t), OmDataVerifyIssueCompare);
+
+	// Join runs of bad sectors that were split between the ranges
+	int count = 0;
+	for (i = 0; i < verify->issueCount; i++)
+	{
+		omdata_issue_t *issue = &verify->issues[i];
+		omdata_issue_t *last = (count > 0) ? &verify->issues[count - 1] : NULL;
+		if (last != NULL && issue->type == 'b' && last->type == 'b' && last->sector + last->count == issue->sector) { last->count += issue->count; continue; }
+		verify->issues[count++] = *issue;
+	}
+	verify->issueCount = count;
+	return 0;
+}
+
+
+void OmDataConfigInit(omdata_config_t *config)
+{
+	memset(config, 0, sizeof(omdata_config_t));
+	config->threads = 0;
+	config->index = false;
+	config->memoryBudget = 0;
+	config->cacheBudget = OMDATA_CACHE_DEFAULT_BUDGET;
+	config->startTime = 0;
+	config->stopTime = 0;
+	config->metadataOnly = false;
+	config->verify = false;
+}
+
+
+int OmDataLoad(omdata_t *omdata, const char *filename, const omdata_config_t *config)
+{
+	unsigned char *buffer = NULL;
+	omdata_config_t defaultConfig;
+
+	if (config == NULL)
+	{
+		OmDataConfigInit(&defaultConfig);
+		config = &defaultConfig;
+	}
 
 	fprintf(stderr, "OMDATA: Loading file: %s\n", filename);
 	if (omdata == NULL) { return 0; }
 	memset(omdata, 0, sizeof(omdata_t));
+	omdata->cacheBudget = config->cacheBudget;
 	if (filename == NULL || filename[0] == '\0') { return 0; }
 
+	// An index covers the whole file, so is not used when loading a time window
+	bool window = (config->startTime > 0 || config->stopTime > 0);
+	bool useIndex = config->index && !window;
+	if (config->index && window) { fprintf(stderr, "OMDATA: Not using the index file when loading a time window.\n"); }
+
+	// A compressed file is decompressed in to memory
+	omgzip_t *gzip = NULL;
+	if (OmGzipCheck(filename))
+	{
+		gzip = OmGzipOpen(filename);
+		if (gzip == NULL) { fprintf(stderr, "ERROR: Problem opening compressed file.\n"); return 0; }
+	}
+
 	// Open the file
 	int fd = _open(filename, _O_RDONLY | _O_BINARY);
 	struct _stat sb = { 0 };
-	if (fd == -1) { fprintf(stderr, "ERROR: Problem opening file for reading.\n"); return 0; }
+	if (fd == -1) { fprintf(stderr, "ERROR: Problem opening file for reading.\n"); free(OmGzipFinish(gzip, NULL)); return 0; }
 	if (_fstat(fd, &sb) == -1) 
 	{ 
 		// Fix for Windows XP with newer run time library
 		sb.st_size = _lseek(fd, 0, SEEK_END);
 		_lseek(fd, 0, SEEK_SET);
 	}
-	long length = sb.st_size;
+	size_t length = (size_t)sb.st_size;
 
+	// I/O backend: by default, map the whole file (where supported) unless there is a memory budget
+	int io = config->io;
+	// (only a few sectors are needed for the metadata, so those are read through a small window)
+#ifdef USE_MMAP
+	if (io == OMDATA_IO_DEFAULT) { io = (config->memoryBudget == 0 && !config->metadataOnly) ? OMDATA_IO_MMAP : OMDATA_IO_READ; }
+#else
+	if (io == OMDATA_IO_DEFAULT) { io = OMDATA_IO_READ; }
+#endif
+	const char *ioName = OmStoreIoName(io);
+	if (gzip != NULL)
+	{
+		_close(fd);
+		ioName = "gzip";
+		omdata->bufferAllocated = true;
+		if (useIndex || window || config->metadataOnly || config->verify)
+		{
+			// The whole file is needed before scanning
+			fprintf(stderr, "OMDATA: Decompressing...\n");
+			size_t decompressed = 0;
+			buffer = OmGzipFinish(gzip, &decompressed);
+			gzip = NULL;
+			if (buffer == NULL) { fprintf(stderr, "ERROR: Problem decompressing file.\n"); return 0; }
+			length = decompressed;
+		}
+		else
+		{
+			// Scanned while decompressing (the tables are sized from the estimated length)
+			length = OmGzipEstimate(gzip);
+			fprintf(stderr, "OMDATA: Decompressing and processing (estimated %llu bytes)...\n", (unsigned long long)length);
+		}
+	}
+	else
 #ifdef USE_MMAP
-	fprintf(stderr, "OMDATA: Mapping %d bytes...\n", (int)length);
-	buffer = (unsigned char *)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
-	if (buffer == MAP_FAILED || buffer == NULL) { fprintf(stderr, "ERROR: Problem mapping %d bytes.\n", (int)length); _close(fd); return 0; }
-	_close(fd);	// We can close the underlying file here
+	if (io == OMDATA_IO_MMAP)
+	{
+		if (config->memoryBudget != 0) { fprintf(stderr, "NOTE: Memory budget not used when mapping the whole file.\n"); }
+		fprintf(stderr, "OMDATA: Mapping %llu bytes...\n", (unsigned long long)length);
+		buffer = (unsigned char *)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (buffer == MAP_FAILED || buffer == NULL) { fprintf(stderr, "ERROR: Problem mapping %llu bytes.\n", (unsigned long long)length); _close(fd); return 0; }
+		_close(fd);	// We can close the underlying file here
+#ifndef _WIN32
+		// Hint that the mapping is read in order and will be needed soon (so is read ahead), and that huge pages could be used
+		if (!config->metadataOnly)
+		{
+			madvise(buffer, length, MADV_SEQUENTIAL);
+			madvise(buffer, length, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+			madvise(buffer, length, MADV_HUGEPAGE);
+#endif
+		}
+#endif
+	}
+	else
 #else
-	fprintf(stderr, "OMDATA: Allocating and reading %d bytes...\n", (int)length);
-	buffer = (unsigned char *)malloc(length);
-	if (buffer == NULL) { _close(fd); fprintf(stderr, "ERROR: Problem allocating %d bytes.\n", (int)length); return 0; }
-	if (_read(fd, buffer, length) != length) { fprintf(stderr, "ERROR: Problem reading %d bytes.\n", (int)length); free(buffer); _close(fd); return 0; }
-	_close(fd);
+	if (io == OMDATA_IO_MMAP) { fprintf(stderr, "NOTE: Mapping not supported, using windowed reads.\n"); io = OMDATA_IO_READ; }
 #endif
+	{
+		// Windowed reading within a memory budget
+		_close(fd);
+		size_t budget = (config->metadataOnly && config->memoryBudget == 0) ? OMDATA_METADATA_BUDGET : config->memoryBudget;
+		omdata->store = OmStoreOpen(filename, budget, io);
+		if (omdata->store == NULL) { fprintf(stderr, "ERROR: Problem opening file for windowed reading.\n"); return 0; }
+		ioName = OmStoreIoName(OmStoreIo(omdata->store));
+		fprintf(stderr, "OMDATA: Reading %llu bytes through a %d byte window (%s)...\n", (unsigned long long)length, (int)OmStoreBudget(omdata->store), ioName);
+	}
 		
 	omdata->buffer = buffer;
 	omdata->length = length;
-	int sectorCount = omdata->length / OMDATA_SECTOR_SIZE;
+
+	// Sector indexes are 32-bit (up to 1 TB of data)
+	if (length / OMDATA_SECTOR_SIZE > INT_MAX)
+	{
+		fprintf(stderr, "ERROR: File too large (%llu bytes).\n", (unsigned long long)length);
+		free(OmGzipFinish(gzip, NULL));
+		OmDataFree(omdata);
+		return 0;
+	}
+
+	// Only the header and an integrity check of the sectors
+	if (config->verify)
+	{
+		int sectorCount = (int)(omdata->length / OMDATA_SECTOR_SIZE);
+		int headerSectors = OmDataHeaderSectors(omdata, sectorCount);
+		if (headerSectors > 0)
+		{
+			OmDataProcessSectors(omdata, 0, headerSectors);
+		}
+		omdata->statsTotalSectors = sectorCount;
+		omdata->verify = OmDataVerifyCreate();
+		if (omdata->verify == NULL) { fprintf(stderr, "ERROR: Out of memory.\n"); OmDataFree(omdata); return 0; }
+		fprintf(stderr, "OMDATA: Verifying sectors (%d)...\n", sectorCount - headerSectors);
+		double verifyStart = OmDataTimeNow();
+		OmDataVerifyParallel(omdata, headerSectors, sectorCount - headerSectors, (config->threads > 0) ? config->threads : OmDataProcessorCount());
+		double verifyTime = OmDataTimeNow() - verifyStart;
+		double verifyBytes = (double)(sectorCount - headerSectors) * OMDATA_SECTOR_SIZE;
+		fprintf(stderr, "OMDATA: Verified %.1f MB in %.3f s (%.1f MB/s, %s).\n", verifyBytes / 1048576, verifyTime, (verifyTime > 0) ? verifyBytes / 1048576 / verifyTime : 0.0, ioName);
+		return 1;
+	}
+
+	// Only the header and the extent of the data
+	if (config->metadataOnly)
+	{
+		OmDataLoadMetadata(omdata, (int)(omdata->length / OMDATA_SECTOR_SIZE));
+		fprintf(stderr, "OMDATA: Metadata loaded.\n");
+		return 1;
+	}
+
+	// Use an up-to-date index instead of processing
+	if (useIndex && OmIndexLoad(omdata, filename, (int64_t)sb.st_mtime))
+	{
+		fprintf(stderr, "OMDATA: Processed.\n");
+		return 1;
+	}
+
+	int sectorCount = (int)(omdata->length / OMDATA_SECTOR_SIZE);
+	OmDataArenaInit(omdata, sectorCount);
+	omdata->sectorValid = (uint32_t *)calloc((sectorCount + 31) / 32 + 1, sizeof(uint32_t));
+	OmDataHeadersInit(&omdata->headers, sectorCount);
 	fprintf(stderr, "OMDATA: Processing sectors (%d)...\n", sectorCount);
-	OmDataProcessSectors(omdata, 0, sectorCount);
+	int threads = (config->threads > 0) ? config->threads : OmDataProcessorCount();
+	double scanStart = OmDataTimeNow();
+	double scanBytes;
+	int leadInStartIndex = 0, leadInEndIndex = 0;
+	if (gzip != NULL)
+	{
+		if (!OmDataScanGzip(omdata, gzip))
+		{
+			fprintf(stderr, "ERROR: Problem decompressing file.\n");
+			OmDataFree(omdata);
+			return 0;
+		}
+		scanBytes = (double)omdata->length;
+	}
+	else if (window)
+	{
+		int headerCount, firstSector, lastSector;
+		OmDataFindWindow(omdata, sectorCount, config->startTime, config->stopTime, &headerCount, &firstSector, &lastSector);
+		leadInStartIndex = headerCount;		// The timestamp corrections before the window carry on in to it
+		leadInEndIndex = firstSector;
+		fprintf(stderr, "OMDATA: Time window is sectors @%d-%d.\n", firstSector, lastSector - 1);
+		if (headerCount > 0)
+		{
+			OmDataProcessSectors(omdata, 0, headerCount);
+		}
+		if (lastSector > firstSector)
+		{
+			OmDataProcessSectorsParallel(omdata, firstSector, lastSector - firstSector, threads);
+		}
+		scanBytes = (double)(headerCount + (lastSector > firstSector ? lastSector - firstSector : 0)) * OMDATA_SECTOR_SIZE;
+	}
+	else
+	{
+		OmDataProcessSectorsParallel(omdata, 0, sectorCount, threads);
+		scanBytes = (double)sectorCount * OMDATA_SECTOR_SIZE;
+	}
+
+	// Throughput of the I/O backend
+	double scanTime = OmDataTimeNow() - scanStart;
+	fprintf(stderr, "OMDATA: Scanned %.1f MB in %.3f s (%.1f MB/s, %s).\n", scanBytes / 1048576, scanTime, (scanTime > 0) ? scanBytes / 1048576 / scanTime : 0.0, ioName);
 
 	fprintf(stderr, "OMDATA: Analysing timestamps...\n");
-	OmDataAnalyzeTimestamps(omdata);
+	OmDataAnalyzeTimestamps(omdata, leadInStartIndex, leadInEndIndex, threads);
+
+	OmDataArenaStats(omdata);
+
+	fprintf(stderr, "OMDATA: Compacting segment index...\n");
+	OmDataCompactSegments(omdata);
 
 	fprintf(stderr, "OMDATA: Processing segments...\n");
 	OmDataProcessSegments(omdata);
@@ -1409,6 +3162,12 @@ int OmDataLoad(omdata_t *omdata, const char *filename)
 	fprintf(stderr, "OMDATA: Determining sessions...\n");
 	OmDataCalculateSessions(omdata, 7 * 24 * 60.0 * 60.0);	// Allow up to one week between sessions
 
+
+	if (useIndex)
+	{
+		OmIndexSave(omdata, filename, (int64_t)sb.st_mtime);
+	}
+
 	fprintf(stderr, "OMDATA: Processed.\n");
 	return 1;
 }
@@ -1457,46 +3216,57 @@ int OmDataDump(omdata_t *omdata)
 
 
 
+static void OmDataCacheFree(omdata_t *data);
+
 int OmDataFree(omdata_t *omdata)
 {
 	if (omdata != NULL)
 	{
-		// For each stream
-		int streamIndex;
-		for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
-		{
-			omdata_stream_t *stream = &omdata->stream[streamIndex];
+		// Decoded sample cache
+		OmDataCacheFree(omdata);
 
-			if (!stream->inUse) { continue; }
+		// Segments loaded from an index are not individually allocated
+		OmIndexFree(omdata);
 
-			// Free segment info
-			omdata_segment_t *seg, *nextSeg;
-			for (seg = stream->segmentFirst; seg != NULL; seg = nextSeg)
-			{
-				nextSeg = seg->segmentNext;
-				free(seg);
-			}
-			stream->segmentFirst = NULL;
-			stream->segmentLast = NULL;
-		}
+		// Segments, their tables and the sessions
+		OmDataArenaFree(omdata);
 
 		// Free large buffer
 		if (omdata->buffer != NULL)
 		{
+			if (omdata->bufferAllocated)
+			{
+				free((void *)omdata->buffer);
+			}
+			else
+			{
 #ifdef USE_MMAP
-			munmap((void *)omdata->buffer, (size_t)omdata->length);
-#else
-			free((void *)omdata->buffer);
+				munmap((void *)omdata->buffer, (size_t)omdata->length);
 #endif
+			}
 			omdata->buffer = NULL;
 		}
+
+		// Close windowed reader
+		if (omdata->store != NULL)
+		{
+			OmStoreClose(omdata->store);
+			omdata->store = NULL;
+		}
 		omdata->length = 0;
 
-		if (omdata->timestampOffset != NULL)
+		if (omdata->sectorValid != NULL)
 		{
-			free(omdata->timestampOffset);
+			free(omdata->sectorValid);
 		}
 
+		// Integrity check results
+		OmDataVerifyFree(omdata->verify);
+		omdata->verify = NULL;
+
+		// Sector header table
+		OmDataHeadersFree(&omdata->headers);
+
 		// Clear everything
 		memset(omdata, 0, sizeof(omdata_t));
 	}
@@ -1512,22 +3282,20 @@ char OmDataGetValues(omdata_t *data, omdata_segment_t *seg, int sampleIndex, int
 
 		if (sampleIndex >= 0 && sampleIndex < seg->description.numSamples && sectorWithinSegmentIndex < seg->sectorCount)
 		{
-			int sectorIndex = seg->sectorIndex[sectorWithinSegmentIndex];
-			const unsigned char *p = (const unsigned char *)data->buffer + (OMDATA_SECTOR_SIZE * sectorIndex);
-
-			int sampleWithinSector = (sampleIndex % seg->description.samplesPerSector);
+			int sectorIndex = OmDataSegmentSector(seg, sectorWithinSegmentIndex);
 
 			if (seg->description.packing == 0 && seg->description.channels == 3)	// Side-channel samples in CWA sectors (battery, light, temperature)
 			{
-				// Create virtual segments for CWA temperature, battery, light (embedded in normal accelerometer sectors) -- create a function to encapsulate below...
-				//unsigned short values[3];  // [0]-batt, [1]-LDR, [2]-Temp
-				values[0] = ((int16_t)p[23] << 1) + 512;		// @23 BYTE Battery - expand compressed byte into range
-				values[1] = 0x03ff & (p[18] | ((int16_t)p[19] << 8));		// @18 WORD Light
-				values[2] = p[20] | ((int16_t)p[21] << 8);		// @20 WORD Temperature
-				//values[3] = p[22];								// @22 BYTE eventsFlag
+				// Virtual segments for CWA temperature, battery, light (embedded in normal accelerometer sectors, read from the sector header table)
+				OmDataSectorAux(data, sectorIndex, values, NULL);
 				return 0;
 			}
-			else if (seg->description.packing == FILESTREAM_PACKING_SPECIAL_DWORD3_10_2 && seg->description.channels == 3)
+
+			const unsigned char *p = OmDataSector(data, sectorIndex);
+
+			int sampleWithinSector = (sampleIndex % seg->description.samplesPerSector);
+
+			if (seg->description.packing == FILESTREAM_PACKING_SPECIAL_DWORD3_10_2 && seg->description.channels == 3)
 			{
 				//int bytesPerSample = 4;
 				const uint32_t *pp = (const uint32_t *)(p + seg->description.offset + (seg->description.pitch * sampleWithinSector));
@@ -1572,3 +3340,502 @@ char OmDataGetValues(omdata_t *data, omdata_segment_t *seg, int sampleIndex, int
 }
 
 
+// Block decoding: unpack runs of samples from a sector in to per-channel arrays
+
+// Packed 3-axis 10-bit values with a 2-bit exponent: eezzzzzz zzzzyyyy yyyyyyxx xxxxxxxx
+static int OmDataUnpackDword3(const unsigned char *src, int count, int16_t *x, int16_t *y, int16_t *z, unsigned char *clipped)
+{
+	int numClipped = 0;
+	int i = 0;
+
+#if defined(OMDATA_AVX2) || defined(OMDATA_SSE2)
+	const __m128i bias = _mm_set1_epi32(127);
+	const __m128i clipBase = _mm_set1_epi16(-512);
+	const __m128i one16 = _mm_set1_epi16(1);
+	const __m128i allOnes = _mm_set1_epi16(-1);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i v0 = _mm_loadu_si128((const __m128i *)(src + 4 * i));
+		__m128i v1 = _mm_loadu_si128((const __m128i *)(src + 4 * i + 16));
+
+		// Exponent multiplier (2^e) for each sample, made from float exponent bits as SSE2 has no per-lane shift
+		__m128i m0 = _mm_cvttps_epi32(_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_srli_epi32(v0, 30), bias), 23)));
+		__m128i m1 = _mm_cvttps_epi32(_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_srli_epi32(v1, 30), bias), 23)));
+		__m128i m = _mm_packs_epi32(m0, m1);
+
+		// Sign-extend each 10-bit value, adjust for exponent
+		__m128i vx = _mm_mullo_epi16(_mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(v0, 22), 22), _mm_srai_epi32(_mm_slli_epi32(v1, 22), 22)), m);
+		__m128i vy = _mm_mullo_epi16(_mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(v0, 12), 22), _mm_srai_epi32(_mm_slli_epi32(v1, 12), 22)), m);
+		__m128i vz = _mm_mullo_epi16(_mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(v0, 2), 22), _mm_srai_epi32(_mm_slli_epi32(v1, 2), 22)), m);
+		_mm_storeu_si128((__m128i *)(x + i), vx);
+		_mm_storeu_si128((__m128i *)(y + i), vy);
+		_mm_storeu_si128((__m128i *)(z + i), vz);
+
+		// Clipped at or beyond (-512 * 2^e) or (512 * 2^e - 1)
+		__m128i clipMin = _mm_mullo_epi16(clipBase, m);
+		__m128i belowMin = _mm_add_epi16(clipMin, one16);
+		__m128i aboveMax = _mm_sub_epi16(_mm_xor_si128(clipMin, allOnes), one16);
+		__m128i c = _mm_or_si128(_mm_cmpgt_epi16(belowMin, vx), _mm_cmpgt_epi16(vx, aboveMax));
+		c = _mm_or_si128(c, _mm_or_si128(_mm_cmpgt_epi16(belowMin, vy), _mm_cmpgt_epi16(vy, aboveMax)));
+		c = _mm_or_si128(c, _mm_or_si128(_mm_cmpgt_epi16(belowMin, vz), _mm_cmpgt_epi16(vz, aboveMax)));
+		int mask = _mm_movemask_epi8(_mm_packs_epi16(c, c)) & 0xff;
+		if (clipped != NULL) { _mm_storel_epi64((__m128i *)(clipped + i), _mm_and_si128(_mm_packs_epi16(c, c), _mm_set1_epi8(1))); }
+		while (mask) { numClipped++; mask &= mask - 1; }
+	}
+#elif defined(OMDATA_NEON)
+	for (; i + 4 <= count; i += 4)
+	{
+		int32x4_t v = vreinterpretq_s32_u8(vld1q_u8(src + 4 * i));
+		int32x4_t e = vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(v), 30));
+
+		// Sign-extend each 10-bit value, adjust for exponent
+		int32x4_t vx = vshlq_s32(vshrq_n_s32(vshlq_n_s32(v, 22), 22), e);
+		int32x4_t vy = vshlq_s32(vshrq_n_s32(vshlq_n_s32(v, 12), 22), e);
+		int32x4_t vz = vshlq_s32(vshrq_n_s32(vshlq_n_s32(v, 2), 22), e);
+		vst1_s16(x + i, vmovn_s32(vx));
+		vst1_s16(y + i, vmovn_s32(vy));
+		vst1_s16(z + i, vmovn_s32(vz));
+
+		// Clipped at or beyond (-512 * 2^e) or (512 * 2^e - 1)
+		int32x4_t clipMin = vnegq_s32(vshlq_s32(vdupq_n_s32(512), e));
+		int32x4_t clipMax = vmvnq_s32(clipMin);
+		uint32x4_t c = vorrq_u32(vcleq_s32(vx, clipMin), vcgeq_s32(vx, clipMax));
+		c = vorrq_u32(c, vorrq_u32(vcleq_s32(vy, clipMin), vcgeq_s32(vy, clipMax)));
+		c = vorrq_u32(c, vorrq_u32(vcleq_s32(vz, clipMin), vcgeq_s32(vz, clipMax)));
+		uint32_t flags[4];
+		int j;
+		vst1q_u32(flags, vandq_u32(c, vdupq_n_u32(1)));
+		for (j = 0; j < 4; j++)
+		{
+			if (clipped != NULL) { clipped[i + j] = (unsigned char)flags[j]; }
+			numClipped += flags[j];
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		uint32_t value = READ_UINT32(src + 4 * i);
+		unsigned char e = (unsigned char)(value >> 30);		// 3=16g, 2=8g, 1=4g, 0=2g
+		x[i] = (signed short)((unsigned short)(value << 6) & (unsigned short)0xffc0) >> (6 - e);		// Sign-extend 10-bit value, adjust for exponent
+		y[i] = (signed short)((unsigned short)(value >> 4) & (unsigned short)0xffc0) >> (6 - e);		// Sign-extend 10-bit value, adjust for exponent
+		z[i] = (signed short)((unsigned short)(value >> 14) & (unsigned short)0xffc0) >> (6 - e);		// Sign-extend 10-bit value, adjust for exponent
+
+		// e: 3=16g (-4096 to 4095), 2=8g (-2048 to 2047), 1=4g (-1024 to 1023), 0=2g (-512 to 511).
+		int clipMin = -(1 << (9 + e));
+		int clipMax = -clipMin - 1;
+		unsigned char c = (x[i] <= clipMin || x[i] >= clipMax || y[i] <= clipMin || y[i] >= clipMax || z[i] <= clipMin || z[i] >= clipMax);
+		if (clipped != NULL) { clipped[i] = c; }
+		numClipped += c;
+	}
+
+	return numClipped;
+}
+
+
+#ifdef OMDATA_SSSE3
+// 8 samples of 3 channels: output register per channel (x[0..7], y[0..7], z[0..7])
+static const unsigned char omdataShuffle3[3][3][16] =
+{
+	{
+		{ 0x00, 0x01, 0x06, 0x07, 0x0c, 0x0d, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x02, 0x03, 0x08, 0x09, 0x0e, 0x0f, 0x80, 0x80, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x04, 0x05, 0x0a, 0x0b },
+	},
+	{
+		{ 0x02, 0x03, 0x08, 0x09, 0x0e, 0x0f, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x04, 0x05, 0x0a, 0x0b, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x01, 0x06, 0x07, 0x0c, 0x0d },
+	},
+	{
+		{ 0x04, 0x05, 0x0a, 0x0b, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x80, 0x80, 0x00, 0x01, 0x06, 0x07, 0x0c, 0x0d, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x02, 0x03, 0x08, 0x09, 0x0e, 0x0f },
+	},
+};
+// 4 samples of 6 channels: output register per channel pair (c0[0..3] c1[0..3], c2.. c3.., c4.. c5..)
+static const unsigned char omdataShuffle6[3][3][16] =
+{
+	{
+		{ 0x00, 0x01, 0x0c, 0x0d, 0x80, 0x80, 0x80, 0x80, 0x02, 0x03, 0x0e, 0x0f, 0x80, 0x80, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x80, 0x80, 0x08, 0x09, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0a, 0x0b, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x04, 0x05, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x06, 0x07 },
+	},
+	{
+		{ 0x04, 0x05, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x00, 0x01, 0x0c, 0x0d, 0x80, 0x80, 0x80, 0x80, 0x02, 0x03, 0x0e, 0x0f, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x08, 0x09, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0a, 0x0b },
+	},
+	{
+		{ 0x08, 0x09, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0a, 0x0b, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x04, 0x05, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80 },
+		{ 0x80, 0x80, 0x80, 0x80, 0x00, 0x01, 0x0c, 0x0d, 0x80, 0x80, 0x80, 0x80, 0x02, 0x03, 0x0e, 0x0f },
+	},
+};
+#endif
+
+// Interleaved 16-bit samples (clipping is checked on the first three channels)
+static int OmDataUnpackInt16(const unsigned char *src, int pitch, int channels, int count, int16_t **values, int offset, unsigned char *clipped)
+{
+	const int clipMin = -32768, clipMax = 32767;	// TODO: Correct limits need to come from segment format/type
+	int clipChannels = (channels < 3) ? channels : 3;
+	int numClipped = 0;
+	int i = 0;
+
+#ifdef OMDATA_SSSE3
+	const __m128i minValue = _mm_set1_epi16(-32768);
+	const __m128i maxValue = _mm_set1_epi16(32767);
+	if (channels == 3 && pitch == 6)
+	{
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i *)(src + 6 * i));
+			__m128i b = _mm_loadu_si128((const __m128i *)(src + 6 * i + 16));
+			__m128i c = _mm_loadu_si128((const __m128i *)(src + 6 * i + 32));
+			__m128i v[3];
+			int q;
+			for (q = 0; q < 3; q++)
+			{
+				v[q] = _mm_or_si128(_mm_or_si128(
+					_mm_shuffle_epi8(a, _mm_loadu_si128((const __m128i *)omdataShuffle3[q][0])),
+					_mm_shuffle_epi8(b, _mm_loadu_si128((const __m128i *)omdataShuffle3[q][1]))),
+					_mm_shuffle_epi8(c, _mm_loadu_si128((const __m128i *)omdataShuffle3[q][2])));
+				_mm_storeu_si128((__m128i *)(values[q] + offset + i), v[q]);
+			}
+			__m128i clip = _mm_setzero_si128();
+			for (q = 0; q < 3; q++)
+			{
+				clip = _mm_or_si128(clip, _mm_or_si128(_mm_cmpeq_epi16(v[q], minValue), _mm_cmpeq_epi16(v[q], maxValue)));
+			}
+			clip = _mm_packs_epi16(clip, clip);
+			if (clipped != NULL) { _mm_storel_epi64((__m128i *)(clipped + i), _mm_and_si128(clip, _mm_set1_epi8(1))); }
+			int mask = _mm_movemask_epi8(clip) & 0xff;
+			while (mask) { numClipped++; mask &= mask - 1; }
+		}
+	}
+	else if (channels == 6 && pitch == 12)
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i *)(src + 12 * i));
+			__m128i b = _mm_loadu_si128((const __m128i *)(src + 12 * i + 16));
+			__m128i c = _mm_loadu_si128((const __m128i *)(src + 12 * i + 32));
+			__m128i v[3];
+			int q;
+			for (q = 0; q < 3; q++)
+			{
+				v[q] = _mm_or_si128(_mm_or_si128(
+					_mm_shuffle_epi8(a, _mm_loadu_si128((const __m128i *)omdataShuffle6[q][0])),
+					_mm_shuffle_epi8(b, _mm_loadu_si128((const __m128i *)omdataShuffle6[q][1]))),
+					_mm_shuffle_epi8(c, _mm_loadu_si128((const __m128i *)omdataShuffle6[q][2])));
+				_mm_storel_epi64((__m128i *)(values[2 * q] + offset + i), v[q]);
+				_mm_storel_epi64((__m128i *)(values[2 * q + 1] + offset + i), _mm_srli_si128(v[q], 8));
+			}
+			// Channels 0 & 1 (low/high half of the first register), channel 2 (low half of the second)
+			__m128i clip01 = _mm_or_si128(_mm_cmpeq_epi16(v[0], minValue), _mm_cmpeq_epi16(v[0], maxValue));
+			__m128i clip2 = _mm_or_si128(_mm_cmpeq_epi16(v[1], minValue), _mm_cmpeq_epi16(v[1], maxValue));
+			__m128i clip = _mm_or_si128(_mm_or_si128(clip01, _mm_srli_si128(clip01, 8)), clip2);
+			clip = _mm_packs_epi16(clip, clip);
+			int mask = _mm_movemask_epi8(clip) & 0x0f;
+			if (clipped != NULL)
+			{
+				int j;
+				for (j = 0; j < 4; j++) { clipped[i + j] = (mask >> j) & 1; }
+			}
+			while (mask) { numClipped++; mask &= mask - 1; }
+		}
+	}
+#elif defined(OMDATA_NEON)
+	if (channels == 3 && pitch == 6)
+	{
+		for (; i + 8 <= count; i += 8)
+		{
+			int16x8x3_t v = vld3q_s16((const int16_t *)(src + 6 * i));
+			int q;
+			uint16x8_t clip = vdupq_n_u16(0);
+			for (q = 0; q < 3; q++)
+			{
+				vst1q_s16(values[q] + offset + i, v.val[q]);
+				clip = vorrq_u16(clip, vorrq_u16(vceqq_s16(v.val[q], vdupq_n_s16(-32768)), vceqq_s16(v.val[q], vdupq_n_s16(32767))));
+			}
+			uint16_t flags[8];
+			int j;
+			vst1q_u16(flags, vandq_u16(clip, vdupq_n_u16(1)));
+			for (j = 0; j < 8; j++)
+			{
+				if (clipped != NULL) { clipped[i + j] = (unsigned char)flags[j]; }
+				numClipped += flags[j];
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		const unsigned char *p = src + pitch * i;
+		unsigned char c = 0;
+		int ch;
+		for (ch = 0; ch < channels; ch++)
+		{
+			int16_t value = (int16_t)READ_UINT16(p + 2 * ch);
+			values[ch][offset + i] = value;
+			if (ch < clipChannels && (value <= clipMin || value >= clipMax)) { c = 1; }
+		}
+		if (clipped != NULL) { clipped[i] = c; }
+		numClipped += c;
+	}
+
+	return numClipped;
+}
+
+
+int OmDataGetValuesBlock(omdata_t *data, omdata_segment_t *seg, int sampleIndex, int count, int16_t **values, unsigned char *clipped)
+{
+	const omdata_description_t *description = &seg->description;
+	int numClipped = 0;
+	int done = 0;
+	int c;
+
+	while (done < count)
+	{
+		int index = sampleIndex + done;
+		int n = count - done;
+		int sectorWithinSegmentIndex = (description->samplesPerSector > 0 && index >= 0) ? (index / description->samplesPerSector) : -1;
+
+		if (description->samplesPerSector <= 0 || description->channels <= 0 || index < 0 || index >= description->numSamples || sectorWithinSegmentIndex >= seg->sectorCount)
+		{
+			// Invalid samples (before the start, or after the end of the segment)
+			if (index < 0 && n > -index) { n = -index; }
+			for (c = 0; c < description->channels && c < OMDATA_MAX_CHANNELS; c++)
+			{
+				memset(values[c] + done, 0, n * sizeof(int16_t));
+			}
+			if (clipped != NULL) { memset(clipped + done, 1, n); }
+			numClipped += n;
+			done += n;
+			continue;
+		}
+
+		// Samples from this sector
+		int sampleWithinSector = index - sectorWithinSegmentIndex * description->samplesPerSector;
+		if (n > description->samplesPerSector - sampleWithinSector) { n = description->samplesPerSector - sampleWithinSector; }
+		if (n > description->numSamples - index) { n = description->numSamples - index; }
+		int sectorIndex = OmDataSegmentSector(seg, sectorWithinSegmentIndex);
+		unsigned char *clippedRun = (clipped != NULL) ? (clipped + done) : NULL;
+
+		if (description->packing == 0 && description->channels == 3)	// Side-channel samples in CWA sectors (battery, light, temperature)
+		{
+			int16_t aux[3];
+			OmDataSectorAux(data, sectorIndex, aux, NULL);
+			int i;
+			for (i = 0; i < n; i++)
+			{
+				values[0][done + i] = aux[0];
+				values[1][done + i] = aux[1];
+				values[2][done + i] = aux[2];
+			}
+			if (clippedRun != NULL) { memset(clippedRun, 0, n); }
+			done += n;
+			continue;
+		}
+
+		const unsigned char *p = OmDataSector(data, sectorIndex);
+		const unsigned char *src = p + description->offset + (description->pitch * sampleWithinSector);
+
+		if (description->packing == FILESTREAM_PACKING_SPECIAL_DWORD3_10_2 && description->channels == 3)
+		{
+			numClipped += OmDataUnpackDword3(src, n, values[0] + done, values[1] + done, values[2] + done, clippedRun);
+		}
+		else if ((description->packing & FILESTREAM_PACKING_FORMAT_MASK) == FILESTREAM_PACKING_SINT16 || (description->packing & FILESTREAM_PACKING_FORMAT_MASK) == FILESTREAM_PACKING_UINT16)
+		{
+			numClipped += OmDataUnpackInt16(src, description->pitch, description->channels, n, values, done, clippedRun);
+		}
+		else
+		{
+			// TODO: Fix API to work with variable width return types (currently 16-bit)
+			fprintf(stderr, "!");
+			for (c = 0; c < description->channels && c < OMDATA_MAX_CHANNELS; c++)
+			{
+				memset(values[c] + done, 0, n * sizeof(int16_t));
+			}
+			if (clippedRun != NULL) { memset(clippedRun, 1, n); }
+			numClipped += n;
+		}
+
+		done += n;
+	}
+
+	return numClipped;
+}
+
+
+// Decoded sample cache
+
+static void OmDataCacheUnlink(omdata_t *data, omdata_cache_block_t *block)
+{
+	if (block->prev != NULL) { block->prev->next = block->next; } else { data->cacheFirst = block->next; }
+	if (block->next != NULL) { block->next->prev = block->prev; } else { data->cacheLast = block->prev; }
+	block->prev = NULL;
+	block->next = NULL;
+}
+
+static void OmDataCacheDiscard(omdata_t *data, omdata_cache_block_t *block)
+{
+	OmDataCacheUnlink(data, block);
+	block->seg->cacheBlocks[block->blockIndex] = NULL;
+	data->cacheUsed -= block->size;
+	free(block);
+}
+
+static omdata_cache_block_t *OmDataCacheBlock(omdata_t *data, omdata_segment_t *seg, int blockIndex)
+{
+	omdata_cache_block_t *block;
+	int c;
+
+	// Block table for the segment
+	if (seg->cacheBlocks == NULL)
+	{
+		seg->cacheBlockCount = (seg->description.numSamples + OMDATA_CACHE_BLOCK_SAMPLES - 1) / OMDATA_CACHE_BLOCK_SAMPLES;
+		seg->cacheBlocks = (omdata_cache_block_t **)calloc(seg->cacheBlockCount + 1, sizeof(omdata_cache_block_t *));
+		if (seg->cacheBlocks == NULL) { seg->cacheBlockCount = 0; return NULL; }
+	}
+	if (blockIndex < 0 || blockIndex >= seg->cacheBlockCount) { return NULL; }
+
+	// Existing block becomes the most recently used
+	block = seg->cacheBlocks[blockIndex];
+	if (block != NULL)
+	{
+		if (block != data->cacheFirst)
+		{
+			OmDataCacheUnlink(data, block);
+			block->next = data->cacheFirst;
+			if (data->cacheFirst != NULL) { data->cacheFirst->prev = block; }
+			data->cacheFirst = block;
+			if (data->cacheLast == NULL) { data->cacheLast = block; }
+		}
+		return block;
+	}
+
+	// Make space for a new block
+	int channels = (seg->description.channels < OMDATA_MAX_CHANNELS) ? seg->description.channels : OMDATA_MAX_CHANNELS;
+	size_t size = sizeof(omdata_cache_block_t) + (size_t)OMDATA_CACHE_BLOCK_SAMPLES * (channels * sizeof(int16_t) + 1);
+	while (data->cacheLast != NULL && data->cacheUsed + size > data->cacheBudget)
+	{
+		OmDataCacheDiscard(data, data->cacheLast);
+	}
+
+	// Decode the block
+	block = (omdata_cache_block_t *)malloc(size);
+	if (block == NULL) { return NULL; }
+	memset(block, 0, sizeof(omdata_cache_block_t));
+	block->seg = seg;
+	block->blockIndex = blockIndex;
+	block->size = size;
+	for (c = 0; c < channels; c++)
+	{
+		block->values[c] = (int16_t *)(block + 1) + (size_t)c * OMDATA_CACHE_BLOCK_SAMPLES;
+	}
+	block->clipped = (unsigned char *)((int16_t *)(block + 1) + (size_t)channels * OMDATA_CACHE_BLOCK_SAMPLES);
+	OmDataGetValuesBlock(data, seg, blockIndex * OMDATA_CACHE_BLOCK_SAMPLES, OMDATA_CACHE_BLOCK_SAMPLES, block->values, block->clipped);
+
+	seg->cacheBlocks[blockIndex] = block;
+	block->next = data->cacheFirst;
+	if (data->cacheFirst != NULL) { data->cacheFirst->prev = block; }
+	data->cacheFirst = block;
+	if (data->cacheLast == NULL) { data->cacheLast = block; }
+	data->cacheUsed += size;
+
+	return block;
+}
+
+char OmDataGetValuesCached(omdata_t *data, omdata_segment_t *seg, int sampleIndex, int16_t *values)
+{
+	omdata_cache_block_t *block;
+
+	if (data->cacheBudget == 0 || sampleIndex < 0 || sampleIndex >= seg->description.numSamples || seg->description.channels <= 0)
+	{
+		return OmDataGetValues(data, seg, sampleIndex, values);
+	}
+
+	block = OmDataCacheBlock(data, seg, sampleIndex / OMDATA_CACHE_BLOCK_SAMPLES);
+	if (block == NULL)
+	{
+		return OmDataGetValues(data, seg, sampleIndex, values);
+	}
+
+	int offset = sampleIndex % OMDATA_CACHE_BLOCK_SAMPLES;
+	int c;
+	for (c = 0; c < seg->description.channels && c < OMDATA_MAX_CHANNELS; c++)
+	{
+		values[c] = block->values[c][offset];
+	}
+	return block->clipped[offset];
+}
+
+static void OmDataCacheFreeChain(omdata_segment_t *seg)
+{
+	for (; seg != NULL; seg = seg->segmentNext)
+	{
+		free(seg->cacheBlocks);
+		seg->cacheBlocks = NULL;
+		seg->cacheBlockCount = 0;
+	}
+}
+
+static void OmDataCacheFree(omdata_t *data)
+{
+	omdata_session_t *session;
+	int streamIndex;
+	while (data->cacheFirst != NULL)
+	{
+		OmDataCacheDiscard(data, data->cacheFirst);
+	}
+	// (the stream chains are broken between sessions)
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		OmDataCacheFreeChain(data->stream[streamIndex].segmentFirst);
+	}
+	for (session = data->firstSession; session != NULL; session = session->sessionNext)
+	{
+		for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+		{
+			OmDataCacheFreeChain(session->stream[streamIndex].segmentFirst);
+		}
+	}
+}
+
+
+// Reader for another thread over the loaded data
+int OmDataOpenReader(omdata_t *reader, const omdata_t *omdata, int shares)
+{
+	if (shares < 1) { shares = 1; }
+	*reader = *omdata;
+
+	// Own decoded sample cache
+	reader->cacheBudget = omdata->cacheBudget / shares;
+	reader->cacheUsed = 0;
+	reader->cacheFirst = NULL;
+	reader->cacheLast = NULL;
+
+	// Own windowed reader
+	if (omdata->store != NULL)
+	{
+		reader->store = OmStoreReopen(omdata->store, OmStoreBudget(omdata->store) / shares);
+		if (reader->store == NULL) { memset(reader, 0, sizeof(omdata_t)); return 0; }
+	}
+	return 1;
+}
+
+void OmDataCloseReader(omdata_t *reader)
+{
+	// Discard the cached blocks (the segments' block tables are freed with the data)
+	while (reader->cacheFirst != NULL)
+	{
+		OmDataCacheDiscard(reader, reader->cacheFirst);
+	}
+	if (reader->store != NULL)
+	{
+		OmStoreClose(reader->store);
+	}
+	memset(reader, 0, sizeof(omdata_t));
+}
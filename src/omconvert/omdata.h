@@ -32,6 +32,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "omarena.h"
 //#include <stdlib.h>
 
 
@@ -41,6 +42,8 @@
 
 #define OMDATA_MAX_CHANNELS 16
 
+#define OMDATA_MAX_SEGMENT_SAMPLES 0x7fff0000	// Longer runs are split in to further segments (sample indexes within a segment are 32-bit)
+
 
 // Timestamp for a sample number within a segment
 typedef struct
@@ -50,6 +53,34 @@ typedef struct
 } omdata_segment_timestamp_t;
 
 
+// Compact sector index: a run of consecutive sectors
+typedef struct
+{
+	unsigned int first;		// Index within the segment of the first sector in the run
+	unsigned int sector;	// Sector index of the first sector in the run
+} omdata_sector_run_t;
+
+#define OMDATA_RUN_LOOKUP_SHIFT 8			// Run lookup entry for every 256 sectors within a segment
+
+// Compact timestamps: a linear model for each block of timestamps, plus residuals of the smallest width that reproduces them exactly
+#define OMDATA_TIMESTAMP_BLOCK_SHIFT 6
+#define OMDATA_TIMESTAMP_BLOCK (1 << OMDATA_TIMESTAMP_BLOCK_SHIFT)
+#define OMDATA_TIMESTAMP_TICKS 65536.0		// Modelled times are in 1/65536 second ticks
+#define OMDATA_TIMESTAMP_EXACT 8			// Time residual width for a block with times that are not whole ticks (the times are stored directly)
+typedef struct
+{
+	int64_t time;			// Ticks of the first timestamp in the block
+	int32_t timeStep;		// Units between timestamps
+	int32_t sample;			// Sample index of the first timestamp in the block
+	int32_t sampleStep;		// Samples between timestamps
+	uint32_t residual;		// Offset in to the segment's residuals (the block's time residuals, then the sample residuals)
+	uint8_t timeWidth;		// Bytes for each time residual (0, 1, 2, 4 or OMDATA_TIMESTAMP_EXACT)
+	uint8_t sampleWidth;	// Bytes for each sample residual (0, 1, 2 or 4)
+	uint8_t timeShift;		// Time step and residuals are in units of (1 << timeShift) ticks (e.g. whole-second timestamps)
+	uint8_t reserved[5];
+} omdata_timestamp_block_t;
+
+
 // Data description
 typedef struct omdata_description_tag_t
 {
@@ -67,6 +98,7 @@ typedef struct omdata_description_tag_t
 
 // Data 'segment' (contiguous sectors) for a stream, forms a chain of segments
 struct omdata_segment_tag_t;
+struct omdata_cache_block_tag_t;
 typedef struct omdata_segment_tag_t
 {
 	struct omdata_segment_tag_t *segmentNext;
@@ -83,19 +115,47 @@ typedef struct omdata_segment_tag_t
 	int timestampCapacity;
 	int timestampCount;
 
+	// Compact tables, once loaded these replace the sector index and timestamps (which are then NULL) -- use OmDataSegmentSector() and OmDataSegmentTimestamp()
+	omdata_sector_run_t *runs;
+	int runCount;
+	unsigned int *runLookup;				// Run containing every (1 << OMDATA_RUN_LOOKUP_SHIFT)-th sector (NULL if only one run)
+	omdata_timestamp_block_t *timestampBlocks;	// ((timestampCount + OMDATA_TIMESTAMP_BLOCK - 1) >> OMDATA_TIMESTAMP_BLOCK_SHIFT) blocks
+	unsigned char *residuals;
+	unsigned int residualSize;
+
 	char lastPacketShort;	// Whether the last packet is short
 
 	// Data description (this will be constant along an entire segment)
 	omdata_description_t description;
+
+	// Decoded sample cache blocks (allocated on first use, NULL entries are not decoded)
+	struct omdata_cache_block_tag_t **cacheBlocks;
+	int cacheBlockCount;
 } omdata_segment_t;
 
 
+// Decoded sample cache block (planar values for a fixed-size run of samples within a segment)
+#define OMDATA_CACHE_BLOCK_SAMPLES 1024
+#define OMDATA_CACHE_DEFAULT_BUDGET (16 * 1024 * 1024)
+typedef struct omdata_cache_block_tag_t
+{
+	struct omdata_cache_block_tag_t *prev;		// More recently used
+	struct omdata_cache_block_tag_t *next;		// Less recently used
+	omdata_segment_t *seg;
+	int blockIndex;
+	size_t size;
+	int16_t *values[OMDATA_MAX_CHANNELS];
+	unsigned char *clipped;
+} omdata_cache_block_t;
+
+
 // Data stream information
 typedef struct
 {
 	bool inUse;
 	omdata_segment_t *segmentFirst;
 	omdata_segment_t *segmentLast;
+	uint32_t firstSequenceId;
 	uint32_t lastSequenceId;
 } omdata_stream_t;
 
@@ -214,12 +274,69 @@ typedef struct
 	unsigned char metadata[448 + 1];		// OMX@318/CWA@64 Metadata (6x32=192 in OMX, 14x32=448 in CWA)
 } omdata_metadata_t;
 
+// Sector header table (a column for each field, indexed by sector, filled in as the data sectors are scanned)
+typedef struct
+{
+	int count;					// Number of sectors
+	uint32_t *sequenceId;		// Sequence id
+	uint32_t *time;				// Timestamp (seconds since epoch)
+	uint16_t *fraction;			// Fractional part of the timestamp (1/65536 seconds)
+	int16_t *timestampOffset;	// Sample index within the sector that the timestamp is for
+	uint16_t *light;			// CWA light (least significant 10 bits, the upper bits are the sensor scaling)
+	uint16_t *temperature;		// CWA temperature
+	uint8_t *battery;			// CWA battery (compressed byte)
+	uint8_t *events;			// CWA events flag
+	uint16_t *sampleCount;		// Samples in the sector (0 = not a scanned data sector, the sector must be parsed instead)
+} omdata_headers_t;
+
+// An integrity check issue (from a verify load)
+typedef struct
+{
+	char type;					// 'b' = bad sectors, 's' = sequence break, 'g' = time gap, 'c' = configuration change
+	char stream;				// Data stream (0 for bad sectors)
+	int sector;					// First sector
+	int count;					// Number of sectors
+	double time;				// Time of the first sample of the sector (0 for bad sectors)
+	double value;				// Sequence id jump (break), unexpected seconds (gap), new sample rate (configuration change)
+} omdata_issue_t;
+
+// Integrity check state of a stream
+typedef struct
+{
+	int firstSector;			// First data sector (-1 if none)
+	int sectorCount;			// Number of data sectors
+	double firstTime;			// Time of the first sample
+	uint32_t firstSequenceId;	// Sequence id of the first sector
+	uint32_t firstConfig;		// Configuration of the first sector (rate and packing)
+	double firstRate;			// Sample rate of the first sector
+	uint32_t lastSequenceId;	// Sequence id of the last sector
+	uint32_t lastConfig;		// Configuration of the last sector
+	double expectedTime;		// Expected time of the next sample after the last sector
+} omdata_verify_stream_t;
+
+// Integrity check results (a verify load only checks the sectors, without building streams, segments or sessions)
+typedef struct
+{
+	int issueCount;
+	int issueCapacity;
+	omdata_issue_t *issues;		// In sector order
+	int badSectors;				// Sectors with a bad checksum or header
+	int dataSectors;			// Good data sectors
+	omdata_verify_stream_t stream[OMDATA_MAX_STREAM];
+} omdata_verify_t;
+
+// Windowed reader (see omstore.h)
+struct omstore_tag_t;
+
 // Data type
 typedef struct
 {
-	const unsigned char *buffer;
+	const unsigned char *buffer;	// Whole file (if mapped or decompressed), otherwise NULL and sectors are read through the store
+	bool bufferAllocated;			// The buffer was decompressed in to memory (rather than mapped)
+	struct omstore_tag_t *store;
 	size_t length;
-	double *timestampOffset;
+	uint32_t *sectorValid;		// Validity bitmap (a set bit is a sector with a good checksum)
+	omdata_headers_t headers;	// Sector header table
 	omdata_stream_t stream[OMDATA_MAX_STREAM];
 	omdata_session_t *firstSession;
 	omdata_metadata_t metadata;
@@ -227,14 +344,85 @@ typedef struct
 	int statsTotalSectors;		// Total number of input sectors (including non-data sectors)
 	int statsBadSectors;		// Total number of bad sectors
 	int statsDataSectors;		// Total number of data sectors
+
+	double firstSampleTime;		// Time of the first sample (only when loading the metadata only, 0 if no data)
+	double lastSampleTime;		// Time of the last sample (only when loading the metadata only, 0 if no data)
+	omdata_verify_t *verify;	// Integrity check results (only from a verify load)
+
+	bool partial;				// Partial scan of a range of sectors (segment chains are stitched on to the main scan)
+
+	// Tables built while loading (released all together)
+	// (the sector index and timestamp tables are allocated separately for each stream so that the last segment's tables can grow in place)
+	omarena_t segmentArena;							// Segments and sessions
+	omarena_t sectorArena[OMDATA_MAX_STREAM];		// Segment sector indexes
+	omarena_t timestampArena[OMDATA_MAX_STREAM];	// Segment timestamps
+
+	// Decoded sample cache (the least-recently used blocks are discarded to stay within the budget)
+	size_t cacheBudget;
+	size_t cacheUsed;
+	omdata_cache_block_t *cacheFirst;
+	omdata_cache_block_t *cacheLast;
+
+	// Loaded from a sidecar index (the segment arrays refer in to the index buffer)
+	const void *indexBuffer;
+	size_t indexLength;
+	omdata_segment_t *indexSegments;
+	omdata_session_t *indexSessions;
 } omdata_t;
 
 
+// I/O backends for reading the file
+typedef enum
+{
+	OMDATA_IO_DEFAULT = 0,		// Map the whole file where supported without a memory budget, otherwise windowed reads
+	OMDATA_IO_MMAP,				// Map the whole file (with sequential read-ahead hints)
+	OMDATA_IO_READ,				// Windowed reads (pread, with a read-ahead thread)
+	OMDATA_IO_DIRECT,			// Windowed reads bypassing the page cache (O_DIRECT, aligned buffers)
+	OMDATA_IO_URING,			// Windowed reads, each window as a batch of io_uring reads
+} omdata_io_t;
+
+// Loading configuration
+typedef struct
+{
+	omdata_io_t io;				// I/O backend
+	int threads;				// Number of threads for the sector scan (0 = one per processor, 1 = single-threaded)
+	bool index;					// Use a sidecar index file (loaded if up-to-date, otherwise written after processing)
+	size_t memoryBudget;		// Windowed reading memory budget in bytes (0 = map the whole file where supported, otherwise the default budget)
+	size_t cacheBudget;			// Decoded sample cache budget in bytes (0 = no cache)
+	double startTime;			// Only load sectors from this time (0 = from the start)
+	double stopTime;			// Only load sectors until this time (0 = to the end)
+	bool metadataOnly;			// Only load the header and the times of the first and last samples (no streams, segments or sessions)
+	bool verify;				// Only load the header and check the integrity of the sectors (no streams, segments or sessions)
+} omdata_config_t;
+
+
+// Create a default loading configuration
+void OmDataConfigInit(omdata_config_t *config);
+
+// Number of processors available (for the default number of threads)
+int OmDataProcessorCount(void);
+
+
 // Check whether can load data
 int OmDataCanLoad(const char *filename);
 
-// Load data
-int OmDataLoad(omdata_t *omdata, const char *filename);
+// Load data (configuration may be NULL for the defaults)
+int OmDataLoad(omdata_t *omdata, const char *filename, const omdata_config_t *config);
+
+// Checksum a range of sectors in to the validity bitmap
+int OmDataValidateSectors(omdata_t *omdata, int sectorStartIndex, int sectorCount);
+
+// Sector index of a sector within a segment
+unsigned int OmDataSegmentSector(const omdata_segment_t *seg, int sectorWithinSegment);
+
+// Timestamp of a segment
+omdata_segment_timestamp_t OmDataSegmentTimestamp(const omdata_segment_t *seg, int timestampIndex);
+
+// Whether a sector has a good checksum (after validation)
+#define OMDATA_SECTOR_VALID(_omdata, _i) (((_omdata)->sectorValid[(_i) >> 5] >> ((_i) & 31)) & 1)
+
+// Contents of a sector (from a windowed reader, the pointer is valid until a sector elsewhere in the file is requested)
+const unsigned char *OmDataSector(omdata_t *omdata, int sectorIndex);
 
 // Debug dump data summary
 int OmDataDump(omdata_t *omdata);
@@ -242,9 +430,27 @@ int OmDataDump(omdata_t *omdata);
 // Retrieve values from a segment-offset (returns if clipped)
 char OmDataGetValues(omdata_t *data, omdata_segment_t *seg, int sampleIndex, int16_t *values);
 
+// Decode a run of samples from a segment-offset in to per-channel arrays (values[channel][i], one array for each of the segment's channels), optionally with per-sample clip flags (samples outside the segment are zero and flagged), returns the number of clipped samples
+int OmDataGetValuesBlock(omdata_t *data, omdata_segment_t *seg, int sampleIndex, int count, int16_t **values, unsigned char *clipped);
+
+// Retrieve values from a segment-offset through the decoded sample cache (as OmDataGetValues, not thread-safe)
+char OmDataGetValuesCached(omdata_t *data, omdata_segment_t *seg, int sampleIndex, int16_t *values);
+
 // Get the timestamp and sample offset for a specific sector
 double OmDataTimestampForSector(omdata_t *omdata, int sectorIndex, char streamIndex, int *sampleIndexOffset);
 
+// Time of the first sample of a data sector (from the sector's own timestamp)
+double OmDataSectorStartTime(omdata_t *omdata, int sectorIndex);
+
+// Side-channel values of a CWA data sector ([0]-battery, [1]-light, [2]-temperature, raw), and optionally the events flag
+void OmDataSectorAux(omdata_t *omdata, int sectorIndex, int16_t *values, unsigned char *events);
+
+// Open a reader over loaded data for use on another thread: it has its own windowed reader and decoded sample cache (each with a share of the loaded data's budgets), and shares the loaded tables (threads must only read separate sessions)
+int OmDataOpenReader(omdata_t *reader, const omdata_t *omdata, int shares);
+
+// Close a reader opened with OmDataOpenReader() (before the loaded data is freed)
+void OmDataCloseReader(omdata_t *reader);
+
 // Free data resources
 int OmDataFree(omdata_t *omdata);
 
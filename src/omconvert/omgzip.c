@@ -0,0 +1,292 @@
+/*
+* Copyright (c) 2026, Open Movement contributors.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Open Movement Data Gzip - decompression of gzip-compressed data files
+// Open Movement contributors, 2026
+
+#ifdef _WIN32
+	#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+	#include "pthread-win32.h"
+#else
+	#include <pthread.h>
+#endif
+
+#if !defined(NO_ZLIB) && !defined(_WIN32)
+	#define USE_ZLIB
+	#include <zlib.h>
+#endif
+
+#include "omgzip.h"
+
+
+#define OMGZIP_INPUT (256 * 1024)				// Compressed bytes read at a time
+#define OMGZIP_SECTOR 512						// Batches are whole sectors
+
+
+struct omgzip_tag_t
+{
+	FILE *fp;
+	size_t estimate;
+
+	// Decompressed buffer
+	unsigned char *buffer;
+	size_t capacity;
+	size_t length;						// Decompressed so far (only the decompression thread)
+
+	// Shared with the reader
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	size_t available;					// Bytes available to the reader
+	bool held;							// The reader is using the buffer (it must not move)
+	bool done;
+	bool error;
+};
+
+
+bool OmGzipCheck(const char *filename)
+{
+	unsigned char magic[2] = { 0 };
+	FILE *fp = fopen(filename, "rb");
+	if (fp == NULL) { return false; }
+	size_t len = fread(magic, 1, sizeof(magic), fp);
+	fclose(fp);
+	return (len == sizeof(magic) && magic[0] == 0x1f && magic[1] == 0x8b);
+}
+
+
+size_t OmGzipPeek(const char *filename, void *buffer, size_t length)
+{
+#ifdef USE_ZLIB
+	gzFile gz = gzopen(filename, "rb");
+	if (gz == NULL) { return 0; }
+	int len = gzread(gz, buffer, (unsigned int)length);
+	gzclose(gz);
+	return (len > 0) ? (size_t)len : 0;
+#else
+	(void)filename; (void)buffer; (void)length;
+	return 0;
+#endif
+}
+
+
+#ifdef USE_ZLIB
+
+// Make more bytes available to the reader
+static void OmGzipPublish(omgzip_t *gzip, size_t available, bool done, bool error)
+{
+	pthread_mutex_lock(&gzip->mutex);
+	gzip->available = available;
+	gzip->done = done;
+	gzip->error = error;
+	pthread_cond_broadcast(&gzip->cond);
+	pthread_mutex_unlock(&gzip->mutex);
+}
+
+
+// Grow the buffer (once the reader is not holding it)
+static bool OmGzipGrow(omgzip_t *gzip)
+{
+	size_t capacity = gzip->capacity + gzip->capacity / 2 + OMGZIP_BATCH;
+	pthread_mutex_lock(&gzip->mutex);
+	while (gzip->held)
+	{
+		pthread_cond_wait(&gzip->cond, &gzip->mutex);
+	}
+	unsigned char *buffer = (unsigned char *)realloc(gzip->buffer, capacity);
+	if (buffer != NULL)
+	{
+		gzip->buffer = buffer;
+		gzip->capacity = capacity;
+	}
+	pthread_mutex_unlock(&gzip->mutex);
+	return (buffer != NULL);
+}
+
+
+static void *OmGzipThread(void *arg)
+{
+	omgzip_t *gzip = (omgzip_t *)arg;
+	unsigned char *input = (unsigned char *)malloc(OMGZIP_INPUT);
+	z_stream stream;
+	bool error = false;
+	bool end = false;
+	size_t published = 0;
+
+	memset(&stream, 0, sizeof(stream));
+	if (input == NULL || inflateInit2(&stream, 15 + 32) != Z_OK)		// Automatic gzip/zlib header detection
+	{
+		free(input);
+		OmGzipPublish(gzip, 0, true, true);
+		return NULL;
+	}
+
+	while (!end && !error)
+	{
+		// More input
+		if (stream.avail_in == 0)
+		{
+			stream.avail_in = (uInt)fread(input, 1, OMGZIP_INPUT, gzip->fp);
+			stream.next_in = input;
+			if (stream.avail_in == 0) { error = (ferror(gzip->fp) != 0); if (!error) { fprintf(stderr, "WARNING: Compressed data is truncated.\n"); } break; }
+		}
+
+		// Decompress in to the end of the buffer (not yet visible to the reader)
+		if (gzip->length >= gzip->capacity && !OmGzipGrow(gzip)) { error = true; break; }
+		stream.next_out = gzip->buffer + gzip->length;
+		stream.avail_out = (uInt)(gzip->capacity - gzip->length);
+		int ret = inflate(&stream, Z_NO_FLUSH);
+		gzip->length = (size_t)(stream.next_out - gzip->buffer);
+		if (ret == Z_STREAM_END)
+		{
+			// Concatenated members
+			if (stream.avail_in == 0)
+			{
+				stream.avail_in = (uInt)fread(input, 1, OMGZIP_INPUT, gzip->fp);
+				stream.next_in = input;
+			}
+			if (stream.avail_in == 0 || inflateReset(&stream) != Z_OK) { end = true; }
+		}
+		else if (ret != Z_OK && ret != Z_BUF_ERROR)
+		{
+			fprintf(stderr, "ERROR: Problem decompressing data (%d).\n", ret);
+			error = true;
+		}
+
+		// Make the next batch of whole sectors available
+		if (gzip->length - published >= OMGZIP_BATCH)
+		{
+			published = gzip->length - (gzip->length % OMGZIP_SECTOR);
+			OmGzipPublish(gzip, published, false, false);
+		}
+	}
+
+	inflateEnd(&stream);
+	free(input);
+	OmGzipPublish(gzip, gzip->length, true, error);
+	return NULL;
+}
+
+#endif
+
+
+omgzip_t *OmGzipOpen(const char *filename)
+{
+#ifdef USE_ZLIB
+	omgzip_t *gzip = (omgzip_t *)calloc(1, sizeof(omgzip_t));
+	if (gzip == NULL) { return NULL; }
+	gzip->fp = fopen(filename, "rb");
+	if (gzip->fp == NULL) { free(gzip); return NULL; }
+
+	// Estimate the decompressed length from the trailer (length modulo 2^32 of the last member)
+	unsigned char trailer[4] = { 0 };
+	fseek(gzip->fp, 0, SEEK_END);
+	long compressed = ftell(gzip->fp);
+	if (compressed > (long)sizeof(trailer) && fseek(gzip->fp, -(long)sizeof(trailer), SEEK_END) == 0 && fread(trailer, 1, sizeof(trailer), gzip->fp) == sizeof(trailer))
+	{
+		gzip->estimate = trailer[0] | ((uint32_t)trailer[1] << 8) | ((uint32_t)trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+	}
+	if (gzip->estimate < (size_t)compressed) { gzip->estimate = (size_t)compressed * 4; }	// Wrapped, or multiple members
+	fseek(gzip->fp, 0, SEEK_SET);
+
+	gzip->capacity = gzip->estimate + OMGZIP_SECTOR;
+	gzip->buffer = (unsigned char *)malloc(gzip->capacity);
+	if (gzip->buffer == NULL) { fclose(gzip->fp); free(gzip); return NULL; }
+
+	pthread_mutex_init(&gzip->mutex, NULL);
+	pthread_cond_init(&gzip->cond, NULL);
+	if (pthread_create(&gzip->thread, NULL, OmGzipThread, gzip) != 0)
+	{
+		pthread_cond_destroy(&gzip->cond);
+		pthread_mutex_destroy(&gzip->mutex);
+		free(gzip->buffer);
+		fclose(gzip->fp);
+		free(gzip);
+		return NULL;
+	}
+	return gzip;
+#else
+	(void)filename;
+	fprintf(stderr, "ERROR: Compressed files are not supported (built without zlib).\n");
+	return NULL;
+#endif
+}
+
+
+size_t OmGzipEstimate(omgzip_t *gzip)
+{
+	return (gzip != NULL) ? gzip->estimate : 0;
+}
+
+
+size_t OmGzipWait(omgzip_t *gzip, size_t processed, const unsigned char **buffer)
+{
+	size_t available;
+	pthread_mutex_lock(&gzip->mutex);
+	gzip->held = false;
+	pthread_cond_broadcast(&gzip->cond);
+	while (gzip->available <= processed && !gzip->done)
+	{
+		pthread_cond_wait(&gzip->cond, &gzip->mutex);
+	}
+	available = gzip->available;
+	gzip->held = true;
+	*buffer = gzip->buffer;
+	pthread_mutex_unlock(&gzip->mutex);
+	return available;
+}
+
+
+unsigned char *OmGzipFinish(omgzip_t *gzip, size_t *length)
+{
+	if (gzip == NULL) { return NULL; }
+	pthread_mutex_lock(&gzip->mutex);
+	gzip->held = false;
+	pthread_cond_broadcast(&gzip->cond);
+	pthread_mutex_unlock(&gzip->mutex);
+	pthread_join(gzip->thread, NULL);
+
+	unsigned char *buffer = gzip->buffer;
+	if (gzip->error)
+	{
+		free(buffer);
+		buffer = NULL;
+	}
+	if (length != NULL) { *length = (buffer != NULL) ? gzip->length : 0; }
+
+	pthread_cond_destroy(&gzip->cond);
+	pthread_mutex_destroy(&gzip->mutex);
+	fclose(gzip->fp);
+	free(gzip);
+	return buffer;
+}
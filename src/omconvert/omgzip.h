@@ -0,0 +1,62 @@
+/*
+* Copyright (c) 2026, Open Movement contributors.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Open Movement Data Gzip - decompression of gzip-compressed data files
+// Open Movement contributors, 2026
+
+// A compressed file is decompressed in to memory on a background thread, in fixed-size batches of
+// whole sectors, so that the sectors can be scanned while the rest of the file is still being decompressed.
+// The decompressed buffer may move while it grows, but not while the reader is holding it (between
+// OmGzipWait() calls).
+
+#ifndef OMGZIP_H
+#define OMGZIP_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define OMGZIP_BATCH (1024 * 1024)		// Decompressed bytes made available at a time
+
+typedef struct omgzip_tag_t omgzip_t;
+
+// Whether a file is gzip-compressed
+bool OmGzipCheck(const char *filename);
+
+// Read the first decompressed bytes of a file, returns the number of bytes read (0 if not supported)
+size_t OmGzipPeek(const char *filename, void *buffer, size_t length);
+
+// Start decompressing a file, returns NULL if not supported (built without zlib) or the file cannot be opened
+omgzip_t *OmGzipOpen(const char *filename);
+
+// Estimated decompressed length (from the gzip trailer)
+size_t OmGzipEstimate(omgzip_t *gzip);
+
+// Release the buffer held since the last call, wait until more than 'processed' bytes are available (or decompression has finished), and hold the buffer; returns the number of bytes available
+size_t OmGzipWait(omgzip_t *gzip, size_t processed, const unsigned char **buffer);
+
+// Wait for decompression to finish and close, returns the decompressed buffer (which the caller must free) or NULL on an error
+unsigned char *OmGzipFinish(omgzip_t *gzip, size_t *length);
+
+#endif
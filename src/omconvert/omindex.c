@@ -0,0 +1,772 @@
+/*
+* Copyright (c) 2026, Open Movement contributors.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Open Movement Data Index (.omidx sidecar file)
+// Open Movement contributors, 2026
+
+// File layout (native byte order, each table starts on an 8-byte boundary):
+//   omindex_header_t                   -- magic, version, layout check, source file size/time/hash, counts and table offsets
+//   omdata_metadata_t                  -- file metadata
+//   omindex_stream_t[OMDATA_MAX_STREAM]-- stream chains (segment numbers, -1 = none)
+//   omindex_segment_t[numSegments]     -- segments (next segment number, times, description, ranges within the arrays below)
+//   omindex_session_t[numSessions]     -- sessions (next session number, times, stream chains)
+//   omdata_sector_run_t[runCount]      -- sector runs for all segments
+//   unsigned int[runLookupCount]       -- sector run lookups for all segments
+//   omdata_timestamp_block_t[timestampBlockCount] -- corrected timestamp blocks for all segments
+//   unsigned char[residualSize]        -- timestamp residuals for all segments
+//   uint32_t[validWords]               -- sector validity bitmap
+// The index is only used if the data file size, modification time and a hash of its first and last sectors match.
+
+#ifdef _WIN32
+	#define _CRT_SECURE_NO_WARNINGS
+	#include <io.h>
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#ifndef NO_MMAP
+#define USE_MMAP
+#endif
+
+#ifdef USE_MMAP
+	#ifdef _WIN32
+		// Windows implementation
+		#include "mmap-win32.h"
+	#else
+		#include <sys/mman.h>
+	#endif
+#endif
+
+#ifndef _WIN32
+	#include <unistd.h>
+	#define _open open
+	#define _close close
+	#define _read read
+	#define _stat stat
+	#define _fstat fstat
+	#define _lseek lseek
+	#define _O_RDONLY O_RDONLY
+	#define _O_BINARY 0
+#endif
+
+#include "omindex.h"
+
+
+#define OMINDEX_MAGIC "OMIDX\r\n\x1a"
+#define OMINDEX_VERSION 2
+#define OMINDEX_BYTE_ORDER 0x01020304
+#define OMINDEX_ALIGN(_v) (((_v) + 7) & ~(uint64_t)7)
+
+// Number of sectors from the start and end of the data file included in the hash
+#define OMINDEX_HASH_SECTORS 2
+
+
+typedef struct
+{
+	char magic[8];					// OMINDEX_MAGIC
+	uint32_t version;				// OMINDEX_VERSION
+	uint32_t byteOrder;				// OMINDEX_BYTE_ORDER
+	uint32_t layout[6];				// Sizes of the native structures used in-place
+	uint64_t fileSize;				// Data file size
+	int64_t fileTime;				// Data file modification time
+	uint64_t fileHash;				// Hash of the first and last bytes of the data file
+	int32_t statsTotalSectors;
+	int32_t statsBadSectors;
+	int32_t statsDataSectors;
+	int32_t firstSession;			// Session number of the first session (-1 = none)
+	int32_t numSegments;
+	int32_t numSessions;
+	uint32_t runCount;
+	uint32_t runLookupCount;
+	uint32_t timestampBlockCount;
+	uint32_t residualSize;
+	uint32_t validWords;
+	uint32_t reserved;
+	uint64_t offsetMetadata;
+	uint64_t offsetStreams;
+	uint64_t offsetSegments;
+	uint64_t offsetSessions;
+	uint64_t offsetRuns;
+	uint64_t offsetRunLookup;
+	uint64_t offsetTimestampBlocks;
+	uint64_t offsetResiduals;
+	uint64_t offsetValid;
+	uint64_t totalSize;				// Total size of the index file
+} omindex_header_t;
+
+typedef struct
+{
+	int32_t inUse;
+	int32_t segmentFirst;			// Segment number (-1 = none)
+	int32_t segmentLast;			// Segment number (-1 = none)
+	uint32_t firstSequenceId;
+	uint32_t lastSequenceId;
+	uint32_t reserved;
+} omindex_stream_t;
+
+typedef struct
+{
+	double startTime;
+	double endTime;
+	double scaling;
+	double sampleRate;
+	int32_t segmentNext;			// Segment number (-1 = none)
+	int32_t lastPacketShort;
+	int32_t sectorCount;
+	int32_t timestampCount;
+	uint32_t runOffset;				// Offset in to the sector run array
+	int32_t runCount;
+	uint32_t runLookupOffset;		// Offset in to the sector run lookup array
+	int32_t runLookupCount;
+	uint32_t timestampBlockOffset;	// Offset in to the timestamp block array (the number of blocks is from the number of timestamps)
+	uint32_t residualOffset;		// Offset in to the residuals
+	uint32_t residualSize;
+	int32_t reserved2;
+	int32_t offset;
+	int32_t pitch;
+	int32_t packing;
+	int32_t channels;
+	int32_t range;
+	int32_t samplesPerSector;
+	int32_t numSamples;
+	int32_t reserved;
+} omindex_segment_t;
+
+typedef struct
+{
+	double startTime;
+	double endTime;
+	int32_t sessionNext;			// Session number (-1 = none)
+	int32_t reserved;
+	omindex_stream_t stream[OMDATA_MAX_STREAM];
+} omindex_session_t;
+
+
+// Layout check values, an index written by a build with different structures is rejected
+static void OmIndexLayout(uint32_t *layout)
+{
+	layout[0] = sizeof(omindex_header_t);
+	layout[1] = sizeof(omdata_metadata_t);
+	layout[2] = sizeof(omindex_segment_t);
+	layout[3] = sizeof(omindex_session_t);
+	layout[4] = (uint32_t)((sizeof(omdata_timestamp_block_t) << 16) | (OMDATA_TIMESTAMP_BLOCK_SHIFT << 8) | OMDATA_RUN_LOOKUP_SHIFT);
+	layout[5] = (uint32_t)((sizeof(omdata_sector_run_t) << 16) | OMDATA_MAX_STREAM);
+}
+
+
+// FNV-1a hash of the first and last sectors of the data file
+static uint64_t OmIndexHashSector(uint64_t hash, const unsigned char *p)
+{
+	int i;
+	for (i = 0; i < OMDATA_SECTOR_SIZE; i++) { hash = (hash ^ p[i]) * 0x100000001b3ULL; }
+	return hash;
+}
+
+static uint64_t OmIndexHash(omdata_t *omdata)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	int sectorCount = (int)(omdata->length / OMDATA_SECTOR_SIZE);
+	int start = (sectorCount < OMINDEX_HASH_SECTORS) ? sectorCount : OMINDEX_HASH_SECTORS;
+	int end = (sectorCount - start < OMINDEX_HASH_SECTORS) ? (sectorCount - start) : OMINDEX_HASH_SECTORS;
+	int i;
+	for (i = 0; i < start; i++) { hash = OmIndexHashSector(hash, OmDataSector(omdata, i)); }
+	for (i = sectorCount - end; i < sectorCount; i++) { hash = OmIndexHashSector(hash, OmDataSector(omdata, i)); }
+	return hash;
+}
+
+
+static char *OmIndexFilename(const char *filename)
+{
+	char *indexFilename = (char *)malloc(strlen(filename) + strlen(OMINDEX_EXTENSION) + 1);
+	if (indexFilename == NULL) { return NULL; }
+	strcpy(indexFilename, filename);
+	strcat(indexFilename, OMINDEX_EXTENSION);
+	return indexFilename;
+}
+
+
+// Sorted list of unique segment pointers, so that each segment has a number
+typedef struct
+{
+	omdata_segment_t **segments;
+	int capacity;
+	int count;
+} omindex_segment_list_t;
+
+static int OmIndexAddChain(omindex_segment_list_t *list, omdata_segment_t *seg)
+{
+	for (; seg != NULL; seg = seg->segmentNext)
+	{
+		if (list->count >= list->capacity)
+		{
+			int newCapacity = 15 * list->capacity / 10 + 1;
+			omdata_segment_t **newSegments = (omdata_segment_t **)realloc(list->segments, newCapacity * sizeof(omdata_segment_t *));
+			if (newSegments == NULL) { return 0; }
+			list->segments = newSegments;
+			list->capacity = newCapacity;
+		}
+		list->segments[list->count++] = seg;
+	}
+	return 1;
+}
+
+static int OmIndexComparePointer(const void *a, const void *b)
+{
+	uintptr_t pa = (uintptr_t)*(omdata_segment_t * const *)a;
+	uintptr_t pb = (uintptr_t)*(omdata_segment_t * const *)b;
+	return (pa > pb) - (pa < pb);
+}
+
+static int32_t OmIndexSegmentNumber(omindex_segment_list_t *list, omdata_segment_t *seg)
+{
+	omdata_segment_t **found;
+	if (seg == NULL) { return -1; }
+	found = (omdata_segment_t **)bsearch(&seg, list->segments, list->count, sizeof(omdata_segment_t *), OmIndexComparePointer);
+	if (found == NULL) { return -1; }
+	return (int32_t)(found - list->segments);
+}
+
+// Sizes of a segment's compact tables
+static int OmIndexRunLookupCount(const omdata_segment_t *seg)
+{
+	return (seg->runLookup != NULL) ? (seg->sectorCount >> OMDATA_RUN_LOOKUP_SHIFT) + 1 : 0;
+}
+
+static int OmIndexTimestampBlockCount(int timestampCount)
+{
+	return (timestampCount + OMDATA_TIMESTAMP_BLOCK - 1) >> OMDATA_TIMESTAMP_BLOCK_SHIFT;
+}
+
+static void OmIndexStreamToRecord(omindex_segment_list_t *list, const omdata_stream_t *stream, omindex_stream_t *record)
+{
+	memset(record, 0, sizeof(omindex_stream_t));
+	record->inUse = stream->inUse ? 1 : 0;
+	record->segmentFirst = OmIndexSegmentNumber(list, stream->segmentFirst);
+	record->segmentLast = OmIndexSegmentNumber(list, stream->segmentLast);
+	record->firstSequenceId = stream->firstSequenceId;
+	record->lastSequenceId = stream->lastSequenceId;
+}
+
+
+// Pad the file to the next table boundary after a table of the given size
+static int OmIndexWritePadding(FILE *fp, size_t size)
+{
+	static const unsigned char padding[8] = { 0 };
+	size_t padSize = (size_t)(OMINDEX_ALIGN(size) - size);
+	if (padSize > 0 && fwrite(padding, 1, padSize, fp) != padSize) { return 0; }
+	return 1;
+}
+
+static int OmIndexWritePadded(FILE *fp, const void *data, size_t size)
+{
+	if (size > 0 && fwrite(data, 1, size, fp) != size) { return 0; }
+	return OmIndexWritePadding(fp, size);
+}
+
+
+int OmIndexSave(omdata_t *omdata, const char *filename, int64_t fileTime)
+{
+	omindex_segment_list_t list = { 0 };
+	omindex_header_t header;
+	omindex_stream_t streams[OMDATA_MAX_STREAM];
+	omindex_segment_t *segments = NULL;
+	omindex_session_t *sessions = NULL;
+	omdata_session_t *session;
+	int ok = 1;
+	int i, streamIndex;
+
+	if (omdata == NULL || (omdata->buffer == NULL && omdata->store == NULL) || filename == NULL) { return 0; }
+
+	// Number every segment reachable from the stream and session chains
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		ok &= OmIndexAddChain(&list, omdata->stream[streamIndex].segmentFirst);
+		ok &= OmIndexAddChain(&list, omdata->stream[streamIndex].segmentLast);
+	}
+	for (session = omdata->firstSession; session != NULL; session = session->sessionNext)
+	{
+		for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+		{
+			ok &= OmIndexAddChain(&list, session->stream[streamIndex].segmentFirst);
+		}
+	}
+	if (list.count > 0) { qsort(list.segments, list.count, sizeof(omdata_segment_t *), OmIndexComparePointer); }
+	{
+		int unique = 0;
+		for (i = 0; i < list.count; i++)
+		{
+			if (unique == 0 || list.segments[i] != list.segments[unique - 1]) { list.segments[unique++] = list.segments[i]; }
+		}
+		list.count = unique;
+	}
+
+	// Header
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, OMINDEX_MAGIC, sizeof(header.magic));
+	header.version = OMINDEX_VERSION;
+	header.byteOrder = OMINDEX_BYTE_ORDER;
+	OmIndexLayout(header.layout);
+	header.fileSize = (uint64_t)omdata->length;
+	header.fileTime = fileTime;
+	header.fileHash = OmIndexHash(omdata);
+	header.statsTotalSectors = omdata->statsTotalSectors;
+	header.statsBadSectors = omdata->statsBadSectors;
+	header.statsDataSectors = omdata->statsDataSectors;
+	header.firstSession = (omdata->firstSession != NULL) ? 0 : -1;
+	header.numSegments = list.count;
+	header.numSessions = 0;
+	for (session = omdata->firstSession; session != NULL; session = session->sessionNext) { header.numSessions++; }
+	header.validWords = (omdata->sectorValid != NULL) ? (uint32_t)((omdata->length / OMDATA_SECTOR_SIZE + 31) / 32 + 1) : 0;
+
+	// Streams
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		OmIndexStreamToRecord(&list, &omdata->stream[streamIndex], &streams[streamIndex]);
+	}
+
+	// Segments
+	segments = (omindex_segment_t *)calloc(list.count + 1, sizeof(omindex_segment_t));
+	if (segments == NULL) { ok = 0; }
+	for (i = 0; ok && i < list.count; i++)
+	{
+		omdata_segment_t *seg = list.segments[i];
+		omindex_segment_t *record = &segments[i];
+		record->startTime = seg->startTime;
+		record->endTime = seg->endTime;
+		record->scaling = seg->description.scaling;
+		record->sampleRate = seg->description.sampleRate;
+		record->segmentNext = OmIndexSegmentNumber(&list, seg->segmentNext);
+		record->lastPacketShort = seg->lastPacketShort;
+		record->sectorCount = seg->sectorCount;
+		record->timestampCount = seg->timestampCount;
+		record->runOffset = header.runCount;
+		record->runCount = seg->runCount;
+		record->runLookupOffset = header.runLookupCount;
+		record->runLookupCount = OmIndexRunLookupCount(seg);
+		record->timestampBlockOffset = header.timestampBlockCount;
+		record->residualOffset = header.residualSize;
+		record->residualSize = seg->residualSize;
+		record->offset = seg->description.offset;
+		record->pitch = seg->description.pitch;
+		record->packing = seg->description.packing;
+		record->channels = seg->description.channels;
+		record->range = seg->description.range;
+		record->samplesPerSector = seg->description.samplesPerSector;
+		record->numSamples = seg->description.numSamples;
+		header.runCount += record->runCount;
+		header.runLookupCount += record->runLookupCount;
+		header.timestampBlockCount += OmIndexTimestampBlockCount(seg->timestampCount);
+		header.residualSize += record->residualSize;
+		if (seg->runs == NULL || seg->timestampBlocks == NULL) { ok = 0; }	// (segments are compacted once loaded)
+	}
+
+	// Sessions
+	sessions = (omindex_session_t *)calloc(header.numSessions + 1, sizeof(omindex_session_t));
+	if (sessions == NULL) { ok = 0; }
+	for (i = 0, session = omdata->firstSession; ok && session != NULL; i++, session = session->sessionNext)
+	{
+		omindex_session_t *record = &sessions[i];
+		record->startTime = session->startTime;
+		record->endTime = session->endTime;
+		record->sessionNext = (session->sessionNext != NULL) ? i + 1 : -1;
+		for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+		{
+			OmIndexStreamToRecord(&list, &session->stream[streamIndex], &record->stream[streamIndex]);
+		}
+	}
+
+	// Table offsets
+	header.offsetMetadata = OMINDEX_ALIGN(sizeof(omindex_header_t));
+	header.offsetStreams = header.offsetMetadata + OMINDEX_ALIGN(sizeof(omdata_metadata_t));
+	header.offsetSegments = header.offsetStreams + OMINDEX_ALIGN(sizeof(streams));
+	header.offsetSessions = header.offsetSegments + OMINDEX_ALIGN((uint64_t)header.numSegments * sizeof(omindex_segment_t));
+	header.offsetRuns = header.offsetSessions + OMINDEX_ALIGN((uint64_t)header.numSessions * sizeof(omindex_session_t));
+	header.offsetRunLookup = header.offsetRuns + OMINDEX_ALIGN((uint64_t)header.runCount * sizeof(omdata_sector_run_t));
+	header.offsetTimestampBlocks = header.offsetRunLookup + OMINDEX_ALIGN((uint64_t)header.runLookupCount * sizeof(unsigned int));
+	header.offsetResiduals = header.offsetTimestampBlocks + OMINDEX_ALIGN((uint64_t)header.timestampBlockCount * sizeof(omdata_timestamp_block_t));
+	header.offsetValid = header.offsetResiduals + OMINDEX_ALIGN((uint64_t)header.residualSize);
+	header.totalSize = header.offsetValid + OMINDEX_ALIGN((uint64_t)header.validWords * sizeof(uint32_t));
+
+	// Write the file
+	if (ok)
+	{
+		char *indexFilename = OmIndexFilename(filename);
+		FILE *fp = (indexFilename != NULL) ? fopen(indexFilename, "wb") : NULL;
+		if (fp == NULL)
+		{
+			fprintf(stderr, "WARNING: Cannot write index file: %s\n", indexFilename ? indexFilename : filename);
+			ok = 0;
+		}
+		else
+		{
+			fprintf(stderr, "OMDATA: Writing index: %s\n", indexFilename);
+			ok &= OmIndexWritePadded(fp, &header, sizeof(header));
+			ok &= OmIndexWritePadded(fp, &omdata->metadata, sizeof(omdata_metadata_t));
+			ok &= OmIndexWritePadded(fp, streams, sizeof(streams));
+			ok &= OmIndexWritePadded(fp, segments, (size_t)header.numSegments * sizeof(omindex_segment_t));
+			ok &= OmIndexWritePadded(fp, sessions, (size_t)header.numSessions * sizeof(omindex_session_t));
+			for (i = 0; ok && i < list.count; i++)
+			{
+				omdata_segment_t *seg = list.segments[i];
+				if (seg->runCount > 0 && fwrite(seg->runs, sizeof(omdata_sector_run_t), seg->runCount, fp) != (size_t)seg->runCount) { ok = 0; }
+			}
+			ok &= OmIndexWritePadding(fp, (size_t)header.runCount * sizeof(omdata_sector_run_t));
+			for (i = 0; ok && i < list.count; i++)
+			{
+				omdata_segment_t *seg = list.segments[i];
+				int count = OmIndexRunLookupCount(seg);
+				if (count > 0 && fwrite(seg->runLookup, sizeof(unsigned int), count, fp) != (size_t)count) { ok = 0; }
+			}
+			ok &= OmIndexWritePadding(fp, (size_t)header.runLookupCount * sizeof(unsigned int));
+			for (i = 0; ok && i < list.count; i++)
+			{
+				omdata_segment_t *seg = list.segments[i];
+				int count = OmIndexTimestampBlockCount(seg->timestampCount);
+				if (count > 0 && fwrite(seg->timestampBlocks, sizeof(omdata_timestamp_block_t), count, fp) != (size_t)count) { ok = 0; }
+			}
+			ok &= OmIndexWritePadding(fp, (size_t)header.timestampBlockCount * sizeof(omdata_timestamp_block_t));
+			for (i = 0; ok && i < list.count; i++)
+			{
+				omdata_segment_t *seg = list.segments[i];
+				if (seg->residualSize > 0 && fwrite(seg->residuals, 1, seg->residualSize, fp) != (size_t)seg->residualSize) { ok = 0; }
+			}
+			ok &= OmIndexWritePadding(fp, (size_t)header.residualSize);
+			ok &= OmIndexWritePadded(fp, omdata->sectorValid, (size_t)header.validWords * sizeof(uint32_t));
+			if (fclose(fp) != 0) { ok = 0; }
+			if (!ok)
+			{
+				fprintf(stderr, "WARNING: Problem writing index file: %s\n", indexFilename);
+				remove(indexFilename);
+			}
+		}
+		free(indexFilename);
+	}
+
+	free(sessions);
+	free(segments);
+	free(list.segments);
+	return ok;
+}
+
+
+static void OmIndexRecordToStream(omdata_segment_t *segments, const omindex_stream_t *record, omdata_stream_t *stream)
+{
+	stream->inUse = record->inUse ? true : false;
+	stream->segmentFirst = (record->segmentFirst >= 0) ? &segments[record->segmentFirst] : NULL;
+	stream->segmentLast = (record->segmentLast >= 0) ? &segments[record->segmentLast] : NULL;
+	stream->firstSequenceId = record->firstSequenceId;
+	stream->lastSequenceId = record->lastSequenceId;
+}
+
+// Check all of the segment and session numbers are in range
+static int OmIndexStreamValid(const omindex_header_t *header, const omindex_stream_t *record)
+{
+	if (record->segmentFirst < -1 || record->segmentFirst >= header->numSegments) { return 0; }
+	if (record->segmentLast < -1 || record->segmentLast >= header->numSegments) { return 0; }
+	return 1;
+}
+
+// Check a table starts on a table boundary after the header, and ends within the index
+static int OmIndexTableValid(uint64_t offset, uint64_t size, size_t indexLength)
+{
+	if (offset != OMINDEX_ALIGN(offset) || offset < OMINDEX_ALIGN(sizeof(omindex_header_t))) { return 0; }
+	if (offset > indexLength || size > indexLength - offset) { return 0; }
+	return 1;
+}
+
+// Check every chain of records (by the next record number at nextOffset in each record, -1 = none) ends, so visits no more than count records
+static int OmIndexChainsEnd(const unsigned char *records, size_t stride, size_t nextOffset, int count)
+{
+	unsigned char *state;		// 0 = not visited, 1 = on the chain being followed, 2 = known to end
+	int i, j, ok = 1;
+	if (count <= 0) { return 1; }
+	state = (unsigned char *)calloc((size_t)count, 1);
+	if (state == NULL) { return 0; }
+	for (i = 0; i < count && ok; i++)
+	{
+		for (j = i; j >= 0 && state[j] == 0; j = *(const int32_t *)(records + (size_t)j * stride + nextOffset)) { state[j] = 1; }
+		if (j >= 0 && state[j] == 1) { ok = 0; }		// Returned to a record on this chain
+		for (j = i; j >= 0 && state[j] == 1; j = *(const int32_t *)(records + (size_t)j * stride + nextOffset)) { state[j] = 2; }
+	}
+	free(state);
+	return ok;
+}
+
+// Check the index is consistent, and that it only refers to sectors within the data file (the arrays are used in place)
+static int OmIndexValid(const omindex_header_t *header, size_t indexLength, const unsigned char *index, uint64_t dataLength)
+{
+	uint64_t sectorCount = dataLength / OMDATA_SECTOR_SIZE;
+	const omindex_stream_t *streams = (const omindex_stream_t *)(index + header->offsetStreams);
+	const omindex_segment_t *segments = (const omindex_segment_t *)(index + header->offsetSegments);
+	const omindex_session_t *sessions = (const omindex_session_t *)(index + header->offsetSessions);
+	const unsigned int *runLookup = (const unsigned int *)(index + header->offsetRunLookup);
+	const omdata_timestamp_block_t *timestampBlocks = (const omdata_timestamp_block_t *)(index + header->offsetTimestampBlocks);
+	const omdata_sector_run_t *runs = (const omdata_sector_run_t *)(index + header->offsetRuns);
+	int i, j, streamIndex;
+
+	if (header->totalSize != indexLength) { return 0; }
+	if (header->numSegments < 0 || header->numSessions < 0) { return 0; }
+	if (!OmIndexTableValid(header->offsetMetadata, sizeof(omdata_metadata_t), indexLength)) { return 0; }
+	if (!OmIndexTableValid(header->offsetStreams, OMDATA_MAX_STREAM * sizeof(omindex_stream_t), indexLength)) { return 0; }
+	if (!OmIndexTableValid(header->offsetSegments, (uint64_t)header->numSegments * sizeof(omindex_segment_t), indexLength)) { return 0; }
+	if (!OmIndexTableValid(header->offsetSessions, (uint64_t)header->numSessions * sizeof(omindex_session_t), indexLength)) { return 0; }
+	if (!OmIndexTableValid(header->offsetRuns, (uint64_t)header->runCount * sizeof(omdata_sector_run_t), indexLength)) { return 0; }
+	if (!OmIndexTableValid(header->offsetRunLookup, (uint64_t)header->runLookupCount * sizeof(unsigned int), indexLength)) { return 0; }
+	if (!OmIndexTableValid(header->offsetTimestampBlocks, (uint64_t)header->timestampBlockCount * sizeof(omdata_timestamp_block_t), indexLength)) { return 0; }
+	if (!OmIndexTableValid(header->offsetResiduals, (uint64_t)header->residualSize, indexLength)) { return 0; }
+	if (!OmIndexTableValid(header->offsetValid, (uint64_t)header->validWords * sizeof(uint32_t), indexLength)) { return 0; }
+	if (header->validWords != 0 && header->validWords != (sectorCount + 31) / 32 + 1) { return 0; }	// Validity bitmap must cover exactly the data file's sectors
+	if (header->firstSession < -1 || header->firstSession >= header->numSessions) { return 0; }
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		if (!OmIndexStreamValid(header, &streams[streamIndex])) { return 0; }
+	}
+	for (i = 0; i < header->numSegments; i++)
+	{
+		const omindex_segment_t *record = &segments[i];
+		if (record->segmentNext < -1 || record->segmentNext >= header->numSegments) { return 0; }
+		if (record->sectorCount < 0 || record->timestampCount < 0) { return 0; }
+		if (record->runCount < (record->sectorCount > 0 ? 1 : 0) || (uint64_t)record->runOffset + record->runCount > header->runCount) { return 0; }
+		if (record->sectorCount > 0 && (record->samplesPerSector <= 0 || record->numSamples < 0 || (int64_t)record->numSamples > (int64_t)record->sectorCount * record->samplesPerSector)) { return 0; }
+		for (j = 0; j < record->runCount; j++)
+		{
+			// Runs start in order from the first sector of the segment, and each run of sectors must be within the data file
+			const omdata_sector_run_t *run = &runs[record->runOffset + j];
+			uint64_t end = (j + 1 < record->runCount) ? runs[record->runOffset + j + 1].first : (uint64_t)record->sectorCount;
+			if ((j == 0) ? (run->first != 0) : (run->first <= runs[record->runOffset + j - 1].first)) { return 0; }
+			if (end <= run->first || end > (uint64_t)record->sectorCount) { return 0; }
+			if ((uint64_t)run->sector + (end - run->first) > sectorCount) { return 0; }
+		}
+		if (record->runLookupCount != ((record->runCount > 1) ? (record->sectorCount >> OMDATA_RUN_LOOKUP_SHIFT) + 1 : 0) || (uint64_t)record->runLookupOffset + record->runLookupCount > header->runLookupCount) { return 0; }
+		for (j = 0; j < record->runLookupCount; j++)
+		{
+			if (runLookup[record->runLookupOffset + j] >= (unsigned int)record->runCount) { return 0; }
+		}
+		int blockCount = OmIndexTimestampBlockCount(record->timestampCount);
+		if ((uint64_t)record->timestampBlockOffset + blockCount > header->timestampBlockCount) { return 0; }
+		if ((uint64_t)record->residualOffset + record->residualSize > header->residualSize) { return 0; }
+		for (j = 0; j < blockCount; j++)
+		{
+			const omdata_timestamp_block_t *block = &timestampBlocks[record->timestampBlockOffset + j];
+			int count = (record->timestampCount - (j << OMDATA_TIMESTAMP_BLOCK_SHIFT) < OMDATA_TIMESTAMP_BLOCK) ? (record->timestampCount - (j << OMDATA_TIMESTAMP_BLOCK_SHIFT)) : OMDATA_TIMESTAMP_BLOCK;
+			if (block->timeWidth > OMDATA_TIMESTAMP_EXACT || block->sampleWidth > 4 || block->timeShift > 32) { return 0; }
+			if ((uint64_t)block->residual + (uint64_t)count * (block->timeWidth + block->sampleWidth) > record->residualSize) { return 0; }
+		}
+	}
+	for (i = 0; i < header->numSessions; i++)
+	{
+		const omindex_session_t *record = &sessions[i];
+		if (record->sessionNext < -1 || record->sessionNext >= header->numSessions) { return 0; }
+		for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+		{
+			if (!OmIndexStreamValid(header, &record->stream[streamIndex])) { return 0; }
+		}
+	}
+
+	// The chains are followed until the end, so must not loop
+	if (!OmIndexChainsEnd((const unsigned char *)segments, sizeof(omindex_segment_t), offsetof(omindex_segment_t, segmentNext), header->numSegments)) { return 0; }
+	if (!OmIndexChainsEnd((const unsigned char *)sessions, sizeof(omindex_session_t), offsetof(omindex_session_t, sessionNext), header->numSessions)) { return 0; }
+	return 1;
+}
+
+
+int OmIndexLoad(omdata_t *omdata, const char *filename, int64_t fileTime)
+{
+	omindex_header_t header;
+	uint32_t layout[6];
+	unsigned char *index = NULL;
+	char *indexFilename;
+	int i, streamIndex;
+
+	if (omdata == NULL || (omdata->buffer == NULL && omdata->store == NULL) || filename == NULL) { return 0; }
+
+	indexFilename = OmIndexFilename(filename);
+	if (indexFilename == NULL) { return 0; }
+
+	// Open the index file
+	int fd = _open(indexFilename, _O_RDONLY | _O_BINARY);
+	struct _stat sb = { 0 };
+	if (fd == -1) { free(indexFilename); return 0; }
+	if (_fstat(fd, &sb) == -1)
+	{
+		sb.st_size = _lseek(fd, 0, SEEK_END);
+		_lseek(fd, 0, SEEK_SET);
+	}
+	size_t length = (size_t)sb.st_size;
+
+	// Check the header before using the rest of the file
+	if (length < sizeof(header) || _read(fd, &header, sizeof(header)) != sizeof(header)) { _close(fd); free(indexFilename); return 0; }
+	OmIndexLayout(layout);
+	if (memcmp(header.magic, OMINDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != OMINDEX_VERSION || header.byteOrder != OMINDEX_BYTE_ORDER || memcmp(header.layout, layout, sizeof(layout)) != 0)
+	{
+		fprintf(stderr, "OMDATA: Ignoring index of a different version: %s\n", indexFilename);
+		_close(fd); free(indexFilename); return 0;
+	}
+	if (header.fileSize != (uint64_t)omdata->length || header.fileTime != fileTime || header.fileHash != OmIndexHash(omdata))
+	{
+		fprintf(stderr, "OMDATA: Ignoring out-of-date index: %s\n", indexFilename);
+		_close(fd); free(indexFilename); return 0;
+	}
+
+#ifdef USE_MMAP
+	index = (unsigned char *)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (index == MAP_FAILED) { index = NULL; }
+#else
+	index = (unsigned char *)malloc(length);
+	_lseek(fd, 0, SEEK_SET);
+	if (index != NULL && (size_t)_read(fd, index, length) != length) { free(index); index = NULL; }
+#endif
+	_close(fd);
+	if (index == NULL) { fprintf(stderr, "WARNING: Problem reading index: %s\n", indexFilename); free(indexFilename); return 0; }
+
+	if (!OmIndexValid(&header, length, index, (uint64_t)omdata->length))
+	{
+		fprintf(stderr, "WARNING: Ignoring invalid index: %s\n", indexFilename);
+#ifdef USE_MMAP
+		munmap(index, length);
+#else
+		free(index);
+#endif
+		free(indexFilename);
+		return 0;
+	}
+
+	fprintf(stderr, "OMDATA: Using index: %s\n", indexFilename);
+	free(indexFilename);
+
+	// Structures that refer in to the mapped index
+	omdata->indexBuffer = index;
+	omdata->indexLength = length;
+	omdata->indexSegments = (omdata_segment_t *)calloc(header.numSegments + 1, sizeof(omdata_segment_t));
+	omdata->indexSessions = (omdata_session_t *)calloc(header.numSessions + 1, sizeof(omdata_session_t));
+	if (omdata->indexSegments == NULL || omdata->indexSessions == NULL) { OmIndexFree(omdata); return 0; }
+	if (header.validWords > 0)
+	{
+		omdata->sectorValid = (uint32_t *)malloc(header.validWords * sizeof(uint32_t));
+		if (omdata->sectorValid == NULL) { OmIndexFree(omdata); return 0; }
+		memcpy(omdata->sectorValid, index + header.offsetValid, header.validWords * sizeof(uint32_t));
+	}
+
+	memcpy(&omdata->metadata, index + header.offsetMetadata, sizeof(omdata_metadata_t));
+	omdata->statsTotalSectors = header.statsTotalSectors;
+	omdata->statsBadSectors = header.statsBadSectors;
+	omdata->statsDataSectors = header.statsDataSectors;
+
+	// Segments
+	{
+		const omindex_segment_t *records = (const omindex_segment_t *)(index + header.offsetSegments);
+		omdata_sector_run_t *runs = (omdata_sector_run_t *)(index + header.offsetRuns);
+		unsigned int *runLookup = (unsigned int *)(index + header.offsetRunLookup);
+		omdata_timestamp_block_t *timestampBlocks = (omdata_timestamp_block_t *)(index + header.offsetTimestampBlocks);
+		unsigned char *residuals = index + header.offsetResiduals;
+		for (i = 0; i < header.numSegments; i++)
+		{
+			const omindex_segment_t *record = &records[i];
+			omdata_segment_t *seg = &omdata->indexSegments[i];
+			seg->segmentNext = (record->segmentNext >= 0) ? &omdata->indexSegments[record->segmentNext] : NULL;
+			seg->startTime = record->startTime;
+			seg->endTime = record->endTime;
+			seg->sectorCount = record->sectorCount;
+			seg->timestampCount = record->timestampCount;
+			seg->runs = runs + record->runOffset;
+			seg->runCount = record->runCount;
+			seg->runLookup = (record->runLookupCount > 0) ? runLookup + record->runLookupOffset : NULL;
+			seg->timestampBlocks = timestampBlocks + record->timestampBlockOffset;
+			seg->residuals = residuals + record->residualOffset;
+			seg->residualSize = record->residualSize;
+			seg->lastPacketShort = (char)record->lastPacketShort;
+			seg->description.offset = record->offset;
+			seg->description.pitch = record->pitch;
+			seg->description.packing = record->packing;
+			seg->description.channels = record->channels;
+			seg->description.scaling = record->scaling;
+			seg->description.range = record->range;
+			seg->description.samplesPerSector = record->samplesPerSector;
+			seg->description.numSamples = record->numSamples;
+			seg->description.sampleRate = record->sampleRate;
+		}
+	}
+
+	// Streams
+	{
+		const omindex_stream_t *records = (const omindex_stream_t *)(index + header.offsetStreams);
+		for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+		{
+			OmIndexRecordToStream(omdata->indexSegments, &records[streamIndex], &omdata->stream[streamIndex]);
+		}
+	}
+
+	// Sessions
+	{
+		const omindex_session_t *records = (const omindex_session_t *)(index + header.offsetSessions);
+		for (i = 0; i < header.numSessions; i++)
+		{
+			const omindex_session_t *record = &records[i];
+			omdata_session_t *session = &omdata->indexSessions[i];
+			session->sessionNext = (record->sessionNext >= 0) ? &omdata->indexSessions[record->sessionNext] : NULL;
+			session->startTime = record->startTime;
+			session->endTime = record->endTime;
+			for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+			{
+				OmIndexRecordToStream(omdata->indexSegments, &record->stream[streamIndex], &session->stream[streamIndex]);
+			}
+		}
+		omdata->firstSession = (header.firstSession >= 0) ? &omdata->indexSessions[header.firstSession] : NULL;
+	}
+
+	return 1;
+}
+
+
+void OmIndexFree(omdata_t *omdata)
+{
+	int streamIndex;
+	if (omdata == NULL || omdata->indexBuffer == NULL) { return; }
+
+	// The segments and sessions are not individually allocated
+	for (streamIndex = 0; streamIndex < OMDATA_MAX_STREAM; streamIndex++)
+	{
+		omdata->stream[streamIndex].segmentFirst = NULL;
+		omdata->stream[streamIndex].segmentLast = NULL;
+	}
+	omdata->firstSession = NULL;
+	free(omdata->indexSegments);
+	omdata->indexSegments = NULL;
+	free(omdata->indexSessions);
+	omdata->indexSessions = NULL;
+
+#ifdef USE_MMAP
+	munmap((void *)omdata->indexBuffer, omdata->indexLength);
+#else
+	free((void *)omdata->indexBuffer);
+#endif
+	omdata->indexBuffer = NULL;
+	omdata->indexLength = 0;
+}
@@ -0,0 +1,49 @@
+/*
+* Copyright (c) 2026, Open Movement contributors.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Open Movement Data Index (.omidx sidecar file)
+// Open Movement contributors, 2026
+
+// The index holds the result of loading a .CWA/.OMX file (segment chains, sector indexes,
+// corrected timestamps and sessions) so that later runs over the same file do not need to rescan it.
+// The arrays in the index file are used in-place from the mapped file.
+
+#ifndef OMINDEX_H
+#define OMINDEX_H
+
+#include "omdata.h"
+
+#define OMINDEX_EXTENSION ".omidx"
+
+// Load the index for the data file (the data must already be mapped), returns non-zero if the index was valid and has been loaded
+int OmIndexLoad(omdata_t *omdata, const char *filename, int64_t fileTime);
+
+// Save the index for the loaded data file, returns non-zero on success
+int OmIndexSave(omdata_t *omdata, const char *filename, int64_t fileTime);
+
+// Free the resources of a loaded index
+void OmIndexFree(omdata_t *omdata);
+
+#endif
@@ -0,0 +1,588 @@
+/*
+* Copyright (c) 2026, Open Movement contributors.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Open Movement Data Store - windowed sector reader
+// Open Movement contributors, 2026
+
+#ifdef _WIN32
+	#define _CRT_SECURE_NO_WARNINGS
+	#include <io.h>
+#elif defined(__linux__)
+	#ifndef _GNU_SOURCE
+		#define _GNU_SOURCE		// O_DIRECT, pread()
+	#endif
+#else
+	#define _DEFAULT_SOURCE	// pread()
+#endif
+#ifndef _WIN32
+	#define _FILE_OFFSET_BITS 64	// Files over 2 GB on 32-bit systems
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+	#include "pthread-win32.h"
+#else
+	#include <pthread.h>
+#endif
+
+#ifndef _WIN32
+	#include <unistd.h>
+	#define _open open
+	#define _close close
+	#define _read read
+	#define _stat stat
+	#define _fstat fstat
+	#define _lseek lseek
+	#define _O_RDONLY O_RDONLY
+	#define _O_BINARY 0
+#else
+	// 64-bit file sizes
+	#define _stat _stati64
+	#define _fstat _fstati64
+	#define _lseek _lseeki64
+#endif
+
+#if defined(__linux__) && !defined(NO_IO_URING)
+	#define USE_IO_URING
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <sys/uio.h>
+	#include <linux/io_uring.h>
+#endif
+
+#include "omdata.h"
+#include "omstore.h"
+
+
+#define OMSTORE_MIN_WINDOW_SECTORS 8
+#define OMSTORE_DIRECT_ALIGN 4096				// Buffer, offset and length alignment for direct reads
+#define OMSTORE_URING_ENTRIES 64				// Maximum reads in a batch
+#define OMSTORE_URING_CHUNK (256 * 1024)		// Size of each read in a batch
+
+#ifdef USE_IO_URING
+// Submission and completion rings
+typedef struct
+{
+	int fd;
+	void *sqRing;
+	size_t sqRingSize;
+	void *cqRing;
+	size_t cqRingSize;
+	struct io_uring_sqe *sqes;
+	size_t sqesSize;
+	unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+	unsigned *cqHead, *cqTail, *cqMask;
+	struct io_uring_cqe *cqes;
+	unsigned entries;
+} omstore_uring_t;
+#endif
+
+
+struct omstore_tag_t
+{
+	char *filename;
+	int fd;
+	int io;								// I/O backend (OMDATA_IO_READ/_DIRECT/_URING)
+	size_t length;
+	unsigned int sectorCount;
+#ifdef USE_IO_URING
+	omstore_uring_t uring;
+#endif
+
+	// Windows
+	size_t budget;
+	unsigned int windowSectors;
+	unsigned char *window[2];
+	unsigned int windowStart[2];		// First sector in each window
+	unsigned int windowCount[2];		// Number of sectors in each window (0 = empty)
+	int current;						// Window of the last access
+
+	// Read-ahead in to the other window
+	bool threaded;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool pending;						// A read-ahead is requested or in progress
+	bool quit;
+
+	unsigned char zero[OMDATA_SECTOR_SIZE];
+};
+
+
+// Read from an offset, returns the number of bytes read (fewer at the end of the file or on an error)
+static size_t OmStoreReadAt(omstore_t *store, unsigned char *buffer, size_t offset, size_t size)
+{
+	size_t total = 0;
+#ifdef _WIN32
+	if (_lseek(store->fd, (__int64)offset, SEEK_SET) == -1) { return 0; }
+#endif
+	while (total < size)
+	{
+#ifdef _WIN32
+		int len = _read(store->fd, buffer + total, (unsigned int)(size - total));
+#else
+		ssize_t len = pread(store->fd, buffer + total, size - total, (off_t)(offset + total));
+#endif
+		if (len <= 0) { break; }
+		total += len;
+	}
+	return total;
+}
+
+
+#ifdef USE_IO_URING
+static void OmStoreUringClose(omstore_uring_t *uring)
+{
+	if (uring->sqes != NULL) { munmap(uring->sqes, uring->sqesSize); }
+	if (uring->cqRing != NULL && uring->cqRing != uring->sqRing) { munmap(uring->cqRing, uring->cqRingSize); }
+	if (uring->sqRing != NULL) { munmap(uring->sqRing, uring->sqRingSize); }
+	if (uring->fd > 0) { close(uring->fd); }
+	memset(uring, 0, sizeof(omstore_uring_t));
+}
+
+
+static bool OmStoreUringOpen(omstore_uring_t *uring)
+{
+	struct io_uring_params params;
+	memset(uring, 0, sizeof(omstore_uring_t));
+	memset(&params, 0, sizeof(params));
+	int fd = (int)syscall(__NR_io_uring_setup, OMSTORE_URING_ENTRIES, &params);
+	if (fd < 0) { return false; }
+	uring->fd = fd;
+	uring->entries = params.sq_entries;
+
+	// Map the rings (a single mapping for both, where supported) and the submission entries
+	uring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	uring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single && uring->cqRingSize > uring->sqRingSize) { uring->sqRingSize = uring->cqRingSize; }
+	uring->sqRing = mmap(NULL, uring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (uring->sqRing == MAP_FAILED) { uring->sqRing = NULL; OmStoreUringClose(uring); return false; }
+	if (single)
+	{
+		uring->cqRing = uring->sqRing;
+	}
+	else
+	{
+		uring->cqRing = mmap(NULL, uring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if (uring->cqRing == MAP_FAILED) { uring->cqRing = NULL; OmStoreUringClose(uring); return false; }
+	}
+	uring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	uring->sqes = (struct io_uring_sqe *)mmap(NULL, uring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (uring->sqes == MAP_FAILED) { uring->sqes = NULL; OmStoreUringClose(uring); return false; }
+
+	uring->sqHead = (unsigned *)((char *)uring->sqRing + params.sq_off.head);
+	uring->sqTail = (unsigned *)((char *)uring->sqRing + params.sq_off.tail);
+	uring->sqMask = (unsigned *)((char *)uring->sqRing + params.sq_off.ring_mask);
+	uring->sqArray = (unsigned *)((char *)uring->sqRing + params.sq_off.array);
+	uring->cqHead = (unsigned *)((char *)uring->cqRing + params.cq_off.head);
+	uring->cqTail = (unsigned *)((char *)uring->cqRing + params.cq_off.tail);
+	uring->cqMask = (unsigned *)((char *)uring->cqRing + params.cq_off.ring_mask);
+	uring->cqes = (struct io_uring_cqe *)((char *)uring->cqRing + params.cq_off.cqes);
+	return true;
+}
+
+
+// Read from an offset as a batch of reads, returns the number of bytes read (as OmStoreReadAt)
+static size_t OmStoreUringReadAt(omstore_t *store, unsigned char *buffer, size_t offset, size_t size)
+{
+	omstore_uring_t *uring = &store->uring;
+	struct iovec iov[OMSTORE_URING_ENTRIES];
+	int result[OMSTORE_URING_ENTRIES];
+	size_t total = 0;
+
+	while (total < size)
+	{
+		// Queue a batch of reads
+		unsigned count = 0;
+		unsigned tail = *uring->sqTail;
+		size_t position = total;
+		while (count < uring->entries && count < OMSTORE_URING_ENTRIES && position < size)
+		{
+			size_t len = size - position;
+			if (len > OMSTORE_URING_CHUNK) { len = OMSTORE_URING_CHUNK; }
+			iov[count].iov_base = buffer + position;
+			iov[count].iov_len = len;
+			result[count] = -1;
+			unsigned index = tail & *uring->sqMask;
+			struct io_uring_sqe *sqe = &uring->sqes[index];
+			memset(sqe, 0, sizeof(struct io_uring_sqe));
+			sqe->opcode = IORING_OP_READV;
+			sqe->fd = store->fd;
+			sqe->off = offset + position;
+			sqe->addr = (unsigned long long)(uintptr_t)&iov[count];
+			sqe->len = 1;
+			sqe->user_data = count;
+			uring->sqArray[index] = index;
+			tail++;
+			count++;
+			position += len;
+		}
+		__atomic_store_n(uring->sqTail, tail, __ATOMIC_RELEASE);
+
+		// Submit and wait for the whole batch
+		unsigned submit = count;
+		unsigned completed = 0;
+		while (completed < count)
+		{
+			int ret = (int)syscall(__NR_io_uring_enter, uring->fd, submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+			if (ret < 0) { fprintf(stderr, "ERROR: Problem submitting reads.\n"); return total; }
+			if ((unsigned)ret > submit) { ret = submit; }
+			submit -= ret;
+			unsigned head = *uring->cqHead;
+			while (head != __atomic_load_n(uring->cqTail, __ATOMIC_ACQUIRE))
+			{
+				struct io_uring_cqe *cqe = &uring->cqes[head & *uring->cqMask];
+				if (cqe->user_data < count) { result[cqe->user_data] = cqe->res; }
+				head++;
+				completed++;
+			}
+			__atomic_store_n(uring->cqHead, head, __ATOMIC_RELEASE);
+		}
+
+		// Complete any short reads, stopping at the end of the file
+		unsigned i;
+		for (i = 0; i < count; i++)
+		{
+			size_t len = (result[i] > 0) ? (size_t)result[i] : 0;
+			if (len < iov[i].iov_len)
+			{
+				len += OmStoreReadAt(store, (unsigned char *)iov[i].iov_base + len, offset + total + len, iov[i].iov_len - len);
+			}
+			total += len;
+			if (len < iov[i].iov_len) { return total; }
+		}
+	}
+	return total;
+}
+#endif
+
+
+// Read sectors in to a window, returns the number of sectors read (a partial last sector is zero-padded)
+static unsigned int OmStoreRead(omstore_t *store, unsigned char *buffer, unsigned int sectorStart, unsigned int count)
+{
+	size_t offset = (size_t)sectorStart * OMDATA_SECTOR_SIZE;
+	size_t size = (size_t)count * OMDATA_SECTOR_SIZE;
+	size_t total;
+
+#ifdef USE_IO_URING
+	if (store->io == OMDATA_IO_URING)
+	{
+		total = OmStoreUringReadAt(store, buffer, offset, size);
+	}
+	else
+#endif
+	{
+		total = OmStoreReadAt(store, buffer, offset, size);
+	}
+#ifdef O_DIRECT
+	if (store->io == OMDATA_IO_DIRECT && total == 0 && offset < store->length)
+	{
+		// The file system may have a larger alignment requirement, continue without direct reads
+		fprintf(stderr, "NOTE: Direct read failed, continuing with buffered reads.\n");
+		fcntl(store->fd, F_SETFL, fcntl(store->fd, F_GETFL) & ~O_DIRECT);
+		store->io = OMDATA_IO_READ;
+		total = OmStoreReadAt(store, buffer, offset, size);
+	}
+#endif
+	if (total < size && sectorStart + total / OMDATA_SECTOR_SIZE < store->sectorCount) { fprintf(stderr, "ERROR: Problem reading sector %u.\n", sectorStart + (unsigned int)(total / OMDATA_SECTOR_SIZE)); }
+
+	// Zero the remainder of a partial sector
+	if (total % OMDATA_SECTOR_SIZE)
+	{
+		size_t end = total + OMDATA_SECTOR_SIZE - (total % OMDATA_SECTOR_SIZE);
+		memset(buffer + total, 0, end - total);
+		total = end;
+	}
+	return (unsigned int)(total / OMDATA_SECTOR_SIZE);
+}
+
+
+static void *OmStoreReadAheadThread(void *arg)
+{
+	omstore_t *store = (omstore_t *)arg;
+	pthread_mutex_lock(&store->mutex);
+	while (!store->quit)
+	{
+		if (store->pending)
+		{
+			int other = 1 - store->current;
+			unsigned int start = store->windowStart[other];
+			pthread_mutex_unlock(&store->mutex);
+			unsigned int count = OmStoreRead(store, store->window[other], start, store->windowSectors);
+			pthread_mutex_lock(&store->mutex);
+			store->windowCount[other] = count;
+			store->pending = false;
+			pthread_cond_broadcast(&store->cond);
+		}
+		else
+		{
+			pthread_cond_wait(&store->cond, &store->mutex);
+		}
+	}
+	pthread_mutex_unlock(&store->mutex);
+	return NULL;
+}
+
+
+// Wait for any read-ahead to finish (the other window can then be used)
+static void OmStoreWait(omstore_t *store)
+{
+	if (!store->threaded) { return; }
+	pthread_mutex_lock(&store->mutex);
+	while (store->pending)
+	{
+		pthread_cond_wait(&store->cond, &store->mutex);
+	}
+	pthread_mutex_unlock(&store->mutex);
+}
+
+
+// Start reading the window after the current one in to the other window
+static void OmStoreReadAhead(omstore_t *store)
+{
+	int other = 1 - store->current;
+	unsigned int next = store->windowStart[store->current] + store->windowSectors;
+	if (!store->threaded || next >= store->sectorCount) { return; }
+	if (store->windowCount[other] > 0 && store->windowStart[other] == next) { return; }
+	pthread_mutex_lock(&store->mutex);
+	store->windowStart[other] = next;
+	store->windowCount[other] = 0;
+	store->pending = true;
+	pthread_cond_broadcast(&store->cond);
+	pthread_mutex_unlock(&store->mutex);
+}
+
+
+// Allocate a window (aligned for direct reads)
+static unsigned char *OmStoreAllocateWindow(omstore_t *store)
+{
+	size_t size = (size_t)store->windowSectors * OMDATA_SECTOR_SIZE;
+#ifndef _WIN32
+	if (store->io == OMDATA_IO_DIRECT)
+	{
+		void *buffer = NULL;
+		if (posix_memalign(&buffer, OMSTORE_DIRECT_ALIGN, size) != 0) { return NULL; }
+		return (unsigned char *)buffer;
+	}
+#endif
+	return (unsigned char *)malloc(size);
+}
+
+
+static bool OmStoreAllocate(omstore_t *store)
+{
+	if (store->window[0] != NULL) { return true; }
+	store->window[0] = OmStoreAllocateWindow(store);
+	store->window[1] = OmStoreAllocateWindow(store);
+	if (store->window[0] == NULL || store->window[1] == NULL)
+	{
+		fprintf(stderr, "ERROR: Problem allocating %u sector windows.\n", store->windowSectors);
+		free(store->window[0]);
+		free(store->window[1]);
+		store->window[0] = NULL;
+		store->window[1] = NULL;
+		return false;
+	}
+	return true;
+}
+
+
+void OmStoreSetBudget(omstore_t *store, size_t budget)
+{
+	if (store == NULL) { return; }
+	OmStoreWait(store);
+	free(store->window[0]);
+	free(store->window[1]);
+	store->window[0] = NULL;
+	store->window[1] = NULL;
+	store->windowCount[0] = 0;
+	store->windowCount[1] = 0;
+	store->current = 0;
+
+	// Budget for both windows
+	if (budget == 0) { budget = OMSTORE_DEFAULT_BUDGET; }
+	store->budget = budget;
+	store->windowSectors = (unsigned int)(budget / 2 / OMDATA_SECTOR_SIZE);
+	if (store->windowSectors < OMSTORE_MIN_WINDOW_SECTORS) { store->windowSectors = OMSTORE_MIN_WINDOW_SECTORS; }
+	if (store->windowSectors > store->sectorCount + 1) { store->windowSectors = store->sectorCount + 1; }
+
+	// Direct reads are whole aligned blocks (so the window starts are also aligned)
+	if (store->io == OMDATA_IO_DIRECT)
+	{
+		unsigned int align = OMSTORE_DIRECT_ALIGN / OMDATA_SECTOR_SIZE;
+		store->windowSectors = (store->windowSectors + align - 1) / align * align;
+	}
+}
+
+
+size_t OmStoreBudget(omstore_t *store)
+{
+	return (store != NULL) ? store->budget : 0;
+}
+
+
+int OmStoreIo(omstore_t *store)
+{
+	return (store != NULL) ? store->io : OMDATA_IO_DEFAULT;
+}
+
+
+const char *OmStoreIoName(int io)
+{
+	switch (io)
+	{
+		case OMDATA_IO_MMAP: return "mmap";
+		case OMDATA_IO_READ: return "read";
+		case OMDATA_IO_DIRECT: return "direct";
+		case OMDATA_IO_URING: return "uring";
+		default: return "default";
+	}
+}
+
+
+size_t OmStoreLength(omstore_t *store)
+{
+	return (store != NULL) ? store->length : 0;
+}
+
+
+omstore_t *OmStoreOpen(const char *filename, size_t budget, int io)
+{
+	omstore_t *store = (omstore_t *)calloc(1, sizeof(omstore_t));
+	if (store == NULL) { return NULL; }
+	store->io = OMDATA_IO_READ;
+	store->fd = -1;
+	if (io == OMDATA_IO_DIRECT)
+	{
+#if defined(O_DIRECT)
+		store->fd = _open(filename, _O_RDONLY | _O_BINARY | O_DIRECT);
+		if (store->fd != -1) { store->io = OMDATA_IO_DIRECT; }
+		else { fprintf(stderr, "NOTE: Direct reads not supported for this file, using buffered reads.\n"); }
+#else
+		fprintf(stderr, "NOTE: Direct reads not supported on this platform, using buffered reads.\n");
+#endif
+	}
+	if (store->fd == -1) { store->fd = _open(filename, _O_RDONLY | _O_BINARY); }
+	if (store->fd == -1) { free(store); return NULL; }
+	if (io == OMDATA_IO_URING)
+	{
+#ifdef USE_IO_URING
+		if (OmStoreUringOpen(&store->uring)) { store->io = OMDATA_IO_URING; }
+		else { fprintf(stderr, "NOTE: io_uring not available, using buffered reads.\n"); }
+#else
+		fprintf(stderr, "NOTE: io_uring not supported on this platform, using buffered reads.\n");
+#endif
+	}
+	store->filename = (char *)malloc(strlen(filename) + 1);
+	if (store->filename == NULL) { _close(store->fd); free(store); return NULL; }
+	strcpy(store->filename, filename);
+
+	struct _stat sb = { 0 };
+	if (_fstat(store->fd, &sb) == -1)
+	{
+		sb.st_size = _lseek(store->fd, 0, SEEK_END);
+		_lseek(store->fd, 0, SEEK_SET);
+	}
+	store->length = (size_t)sb.st_size;
+	store->sectorCount = (unsigned int)((store->length + OMDATA_SECTOR_SIZE - 1) / OMDATA_SECTOR_SIZE);
+
+	OmStoreSetBudget(store, budget);
+
+	// Read-ahead thread (otherwise all reads are synchronous)
+	pthread_mutex_init(&store->mutex, NULL);
+	pthread_cond_init(&store->cond, NULL);
+	store->threaded = (pthread_create(&store->thread, NULL, OmStoreReadAheadThread, store) == 0);
+
+	return store;
+}
+
+
+omstore_t *OmStoreReopen(omstore_t *store, size_t budget)
+{
+	if (store == NULL) { return NULL; }
+	return OmStoreOpen(store->filename, budget, store->io);
+}
+
+
+const unsigned char *OmStoreSector(omstore_t *store, unsigned int sectorIndex)
+{
+	int w;
+
+	if (sectorIndex >= store->sectorCount) { return store->zero; }
+
+	// Current window
+	w = store->current;
+	if (store->windowCount[w] > 0 && sectorIndex - store->windowStart[w] < store->windowCount[w])
+	{
+		return store->window[w] + (size_t)(sectorIndex - store->windowStart[w]) * OMDATA_SECTOR_SIZE;
+	}
+
+	// The other window (possibly being read ahead)
+	OmStoreWait(store);
+	if (!OmStoreAllocate(store)) { return store->zero; }
+	w = 1 - store->current;
+	if (store->windowCount[w] == 0 || sectorIndex - store->windowStart[w] >= store->windowCount[w])
+	{
+		// Not read ahead, read the window containing the sector
+		store->windowStart[w] = sectorIndex - (sectorIndex % store->windowSectors);
+		store->windowCount[w] = OmStoreRead(store, store->window[w], store->windowStart[w], store->windowSectors);
+		if (sectorIndex - store->windowStart[w] >= store->windowCount[w]) { store->windowCount[w] = 0; return store->zero; }
+	}
+	store->current = w;
+	OmStoreReadAhead(store);
+
+	return store->window[w] + (size_t)(sectorIndex - store->windowStart[w]) * OMDATA_SECTOR_SIZE;
+}
+
+
+void OmStoreClose(omstore_t *store)
+{
+	if (store == NULL) { return; }
+	if (store->threaded)
+	{
+		pthread_mutex_lock(&store->mutex);
+		store->quit = true;
+		pthread_cond_broadcast(&store->cond);
+		pthread_mutex_unlock(&store->mutex);
+		pthread_join(store->thread, NULL);
+	}
+	pthread_cond_destroy(&store->cond);
+	pthread_mutex_destroy(&store->mutex);
+	free(store->window[0]);
+	free(store->window[1]);
+#ifdef USE_IO_URING
+	if (store->io == OMDATA_IO_URING) { OmStoreUringClose(&store->uring); }
+#endif
+	_close(store->fd);
+	free(store->filename);
+	free(store);
+}
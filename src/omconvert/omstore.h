@@ -0,0 +1,70 @@
+/*
+* Copyright (c) 2026, Open Movement contributors.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Open Movement Data Store - windowed sector reader
+// Open Movement contributors, 2026
+
+// Reads a file through two fixed-size windows (the current window, and the following window read ahead
+// on a background thread), so that the memory used is a fixed budget rather than the file size.
+// A sector pointer remains valid until a sector outside of its window is requested from the same store.
+// A store must only be used by one thread at a time (open another store on the same file for other threads).
+
+#ifndef OMSTORE_H
+#define OMSTORE_H
+
+#include <stddef.h>
+
+#define OMSTORE_DEFAULT_BUDGET (32 * 1024 * 1024)
+
+typedef struct omstore_tag_t omstore_t;
+
+// Open a file for windowed reading with a memory budget (bytes, 0 = default) and I/O backend (OMDATA_IO_READ/_DIRECT/_URING, an unavailable backend falls back to OMDATA_IO_READ)
+omstore_t *OmStoreOpen(const char *filename, size_t budget, int io);
+
+// Open another store on the same file with the same backend (for use by another thread)
+omstore_t *OmStoreReopen(omstore_t *store, size_t budget);
+
+// Change the memory budget (discards the current windows)
+void OmStoreSetBudget(omstore_t *store, size_t budget);
+
+// Memory budget
+size_t OmStoreBudget(omstore_t *store);
+
+// I/O backend in use (as it may have fallen back)
+int OmStoreIo(omstore_t *store);
+
+// Name of an I/O backend
+const char *OmStoreIoName(int io);
+
+// File length
+size_t OmStoreLength(omstore_t *store);
+
+// Contents of a sector (a zeroed sector if beyond the end of the file or unreadable)
+const unsigned char *OmStoreSector(omstore_t *store, unsigned int sectorIndex);
+
+// Close the store
+void OmStoreClose(omstore_t *store);
+
+#endif
@@ -0,0 +1,93 @@
+/*
+* Copyright (c) 2026, Open Movement contributors.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Threads - Implementation of the subset of pthreads used here, for Windows
+// Open Movement contributors, 2026
+
+// References:
+//   CreateThread:              http://msdn.microsoft.com/en-us/library/ms682453(VS.85).aspx
+//   WaitForSingleObject:       http://msdn.microsoft.com/en-us/library/ms687032(VS.85).aspx
+//   Condition Variables:       http://msdn.microsoft.com/en-us/library/ms682052(VS.85).aspx
+
+
+// This file does nothing if not on Windows
+#ifdef _WIN32
+#ifndef PTHREAD_WIN32_C		// Designed to be included for local static versions
+#define PTHREAD_WIN32_C
+
+#include <stdlib.h>
+#include <windows.h>
+
+typedef HANDLE pthread_t;
+typedef CRITICAL_SECTION pthread_mutex_t;
+typedef CONDITION_VARIABLE pthread_cond_t;
+
+typedef struct
+{
+	void *(*start_routine)(void *);
+	void *arg;
+} pthread_win32_start_t;
+
+static DWORD WINAPI pthread_win32_start(LPVOID param)
+{
+	pthread_win32_start_t start = *(pthread_win32_start_t *)param;
+	free(param);
+	start.start_routine(start.arg);
+	return 0;
+}
+
+static int pthread_create(pthread_t *thread, const void *attr, void *(*start_routine)(void *), void *arg)
+{
+	pthread_win32_start_t *start = (pthread_win32_start_t *)malloc(sizeof(pthread_win32_start_t));
+	(void)attr;
+	if (start == NULL) { return -1; }
+	start->start_routine = start_routine;
+	start->arg = arg;
+	*thread = CreateThread(NULL, 0, pthread_win32_start, start, 0, NULL);
+	if (*thread == NULL) { free(start); return -1; }
+	return 0;
+}
+
+static int pthread_join(pthread_t thread, void **value_ptr)
+{
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+	if (value_ptr != NULL) { *value_ptr = NULL; }
+	return 0;
+}
+
+static int pthread_mutex_init(pthread_mutex_t *mutex, const void *attr) { (void)attr; InitializeCriticalSection(mutex); return 0; }
+static int pthread_mutex_destroy(pthread_mutex_t *mutex) { DeleteCriticalSection(mutex); return 0; }
+static int pthread_mutex_lock(pthread_mutex_t *mutex) { EnterCriticalSection(mutex); return 0; }
+static int pthread_mutex_unlock(pthread_mutex_t *mutex) { LeaveCriticalSection(mutex); return 0; }
+
+static int pthread_cond_init(pthread_cond_t *cond, const void *attr) { (void)attr; InitializeConditionVariable(cond); return 0; }
+static int pthread_cond_destroy(pthread_cond_t *cond) { (void)cond; return 0; }
+static int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); return 0; }
+static int pthread_cond_signal(pthread_cond_t *cond) { WakeConditionVariable(cond); return 0; }
+static int pthread_cond_broadcast(pthread_cond_t *cond) { WakeAllConditionVariable(cond); return 0; }
+
+#endif	// PTHREAD_WIN32_C
+#endif	// _WIN32
@@ -12,6 +12,20 @@
 
 #include "resampler.h"
 
+// Fixed-point filter over four axes at a time
+#if !defined(NO_SIMD) && !defined(RESAMPLER_FILTER_DOUBLE) && (RESAMPLER_MAX_AXES % 4 == 0)
+	#if defined(__AVX2__)
+		#include <immintrin.h>
+		#define RESAMPLER_AVX2
+	#elif defined(__SSE4_1__)
+		#include <smmintrin.h>
+		#define RESAMPLER_SSE4		// (SSE2 has no signed 32-bit multiply: emulating it is slower than the scalar code)
+	#elif defined(__aarch64__) && defined(__ARM_NEON)
+		#include <arm_neon.h>
+		#define RESAMPLER_NEON
+	#endif
+#endif
+
 //#define IIR_TEST 100
 #ifdef IIR_TEST
 	#define IIR_RATE IIR_TEST
@@ -38,25 +52,98 @@ static int gcd(int u, int v) {
 }
 
 
-// Apply the filter, specified by the coefficients b & a, to count elements of data X, returning in data Y (can be same as X), where z[] tracks the final/initial conditions.
-static void resampler_filter(int numCoefficients, const filter_data_t *b, const filter_data_t *a, const filter_data_t *X, filter_data_t *Y, int count, filter_data_t *z) {
-	if (numCoefficients > 0) {
-		int m, i;
-		z[numCoefficients - 1] = 0;
-		for (m = 0; m < count; m++) {
-			filter_data_t oldXm = X[m];
-			filter_data_t newXm = FILTER_MULTIPLY(b[0], oldXm) + z[0];
-			for (i = 1; i < numCoefficients; i++)
-			{
-				z[i - 1] = FILTER_MULTIPLY(b[i], oldXm) + z[i] - FILTER_MULTIPLY(a[i], newXm);
-			}
-			Y[m] = newXm;
+#if defined(RESAMPLER_AVX2)
+// FILTER_MULTIPLY() of four axes by a coefficient (b64 is the coefficient in each 64-bit lane)
+static __m128i resampler_multiply4(__m256i b64, __m128i x) {
+	__m256i p = _mm256_mul_epi32(_mm256_cvtepi32_epi64(x), b64);
+	// (the logical shift only differs from the arithmetic shift in the upper bits that are discarded)
+	p = _mm256_srli_epi64(_mm256_add_epi64(p, _mm256_set1_epi64x(FILTER_BIAS)), FILTER_FRACTIONAL);
+	return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(p, _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0)));
+}
+#elif defined(RESAMPLER_SSE4)
+// FILTER_MULTIPLY() of four axes by a coefficient (b is the coefficient in each lane)
+static __m128i resampler_multiply4(__m128i b, __m128i x) {
+	const __m128i bias = _mm_set1_epi64x(FILTER_BIAS);
+	__m128i even = _mm_mul_epi32(x, b);
+	__m128i odd = _mm_mul_epi32(_mm_srli_epi64(x, 32), b);
+	// (the logical shift only differs from the arithmetic shift in the upper bits that are discarded)
+	even = _mm_srli_epi64(_mm_add_epi64(even, bias), FILTER_FRACTIONAL);
+	odd = _mm_srli_epi64(_mm_add_epi64(odd, bias), FILTER_FRACTIONAL);
+	return _mm_blend_epi16(even, _mm_slli_epi64(odd, 32), 0xcc);
+}
+#elif defined(RESAMPLER_NEON)
+// FILTER_MULTIPLY() of four axes by a coefficient
+static int32x4_t resampler_multiply4(int32x2_t b, int32x4_t x) {
+	int64x2_t lo = vmull_s32(vget_low_s32(x), b);
+	int64x2_t hi = vmull_s32(vget_high_s32(x), b);
+	lo = vshrq_n_s64(vaddq_s64(lo, vdupq_n_s64(FILTER_BIAS)), FILTER_FRACTIONAL);
+	hi = vshrq_n_s64(vaddq_s64(hi, vdupq_n_s64(FILTER_BIAS)), FILTER_FRACTIONAL);
+	return vcombine_s32(vmovn_s64(lo), vmovn_s64(hi));
+}
+#endif
+
+// Apply the filter, specified by the resampler's coefficients, to one value of each axis in X (in place), where the resampler's z[][] tracks the final/initial conditions.
+// When zeroInput is set, X is all zero (the upsampler's zero padding) and the input terms are skipped (as FILTER_MULTIPLY(b, 0) is zero).
+static void resampler_filter(resampler_t *resampler, filter_data_t *X, bool zeroInput) {
+	const int numCoefficients = resampler->numCoefficients;
+	const filter_data_t *b = resampler->B;
+	const filter_data_t *a = resampler->A;
+	int j = 0;
+	if (numCoefficients <= 0) {
+		return;		// Pass-through
+	}
+	for (j = 0; j < resampler->axes; j++) {
+		resampler->z[numCoefficients - 1][j] = 0;
+	}
+	j = 0;
+#if defined(RESAMPLER_AVX2) || defined(RESAMPLER_SSE4) || defined(RESAMPLER_NEON)
+	// Four axes at a time (the state of any padding axes is unused)
+	for (; j < resampler->axes; j += 4) {
+		int i;
+	#if defined(RESAMPLER_AVX2)
+		__m128i oldXm = _mm_loadu_si128((const __m128i *)&X[j]);
+		__m128i newXm = _mm_loadu_si128((const __m128i *)&resampler->z[0][j]);
+		if (!zeroInput) newXm = _mm_add_epi32(resampler_multiply4(_mm256_set1_epi64x(b[0]), oldXm), newXm);
+		for (i = 1; i < numCoefficients; i++) {
+			__m128i zi = _mm_loadu_si128((const __m128i *)&resampler->z[i][j]);
+			if (!zeroInput) zi = _mm_add_epi32(resampler_multiply4(_mm256_set1_epi64x(b[i]), oldXm), zi);
+			zi = _mm_sub_epi32(zi, resampler_multiply4(_mm256_set1_epi64x(a[i]), newXm));
+			_mm_storeu_si128((__m128i *)&resampler->z[i - 1][j], zi);
+		}
+		_mm_storeu_si128((__m128i *)&X[j], newXm);
+	#elif defined(RESAMPLER_SSE4)
+		__m128i oldXm = _mm_loadu_si128((const __m128i *)&X[j]);
+		__m128i newXm = _mm_loadu_si128((const __m128i *)&resampler->z[0][j]);
+		if (!zeroInput) newXm = _mm_add_epi32(resampler_multiply4(_mm_set1_epi32(b[0]), oldXm), newXm);
+		for (i = 1; i < numCoefficients; i++) {
+			__m128i zi = _mm_loadu_si128((const __m128i *)&resampler->z[i][j]);
+			if (!zeroInput) zi = _mm_add_epi32(resampler_multiply4(_mm_set1_epi32(b[i]), oldXm), zi);
+			zi = _mm_sub_epi32(zi, resampler_multiply4(_mm_set1_epi32(a[i]), newXm));
+			_mm_storeu_si128((__m128i *)&resampler->z[i - 1][j], zi);
+		}
+		_mm_storeu_si128((__m128i *)&X[j], newXm);
+	#elif defined(RESAMPLER_NEON)
+		int32x4_t oldXm = vld1q_s32(&X[j]);
+		int32x4_t newXm = vld1q_s32(&resampler->z[0][j]);
+		if (!zeroInput) newXm = vaddq_s32(resampler_multiply4(vdup_n_s32(b[0]), oldXm), newXm);
+		for (i = 1; i < numCoefficients; i++) {
+			int32x4_t zi = vld1q_s32(&resampler->z[i][j]);
+			if (!zeroInput) zi = vaddq_s32(resampler_multiply4(vdup_n_s32(b[i]), oldXm), zi);
+			zi = vsubq_s32(zi, resampler_multiply4(vdup_n_s32(a[i]), newXm));
+			vst1q_s32(&resampler->z[i - 1][j], zi);
 		}
+		vst1q_s32(&X[j], newXm);
+	#endif
 	}
-	else if (X != Y) 
-	{
-		// Pass-through, and destination is not the source
-		memmove(Y, X, sizeof(filter_data_t) * count);
+#endif
+	for (; j < resampler->axes; j++) {
+		filter_data_t oldXm = X[j];
+		filter_data_t newXm = (zeroInput ? 0 : FILTER_MULTIPLY(b[0], oldXm)) + resampler->z[0][j];
+		for (int i = 1; i < numCoefficients; i++)
+		{
+			resampler->z[i - 1][j] = (zeroInput ? 0 : FILTER_MULTIPLY(b[i], oldXm)) + resampler->z[i][j] - FILTER_MULTIPLY(a[i], newXm);
+		}
+		X[j] = newXm;
 	}
 	return;
 }
@@ -232,6 +319,22 @@ bool resampler_init(resampler_t *resampler, int inFrequency, int outFrequency, i
 		filterSet = true;
 	}
 
+	// 100 -> 50 Hz (upsample 1:1; high-pass 0 Hz; low-pass 25 Hz; downsample 2:1), also 50 -> 100 Hz (upsample 1:2; downsample 1:1)
+	if (resampler->intermediateFrequency == 1 * 100 /*=100*/ && resampler->highPass1000 == 0 && resampler->lowPass == 50 / 2 /*=25*/) {
+		resampler->numCoefficients = 5;
+		resampler->B[0] = FILTER_FROM_FLOAT(+0.093980851433794); // Fixed: +0.093994140625000
+		resampler->B[1] = FILTER_FROM_FLOAT(+0.375923405735178); // Fixed: +0.375976562500000
+		resampler->B[2] = FILTER_FROM_FLOAT(+0.563885108602767); // Fixed: +0.563842773437500
+		resampler->B[3] = FILTER_FROM_FLOAT(+0.375923405735178); // Fixed: +0.375976562500000
+		resampler->B[4] = FILTER_FROM_FLOAT(+0.093980851433794); // Fixed: +0.093994140625000
+		resampler->A[0] = FILTER_FROM_FLOAT(+1.000000000000000); // Fixed: +1.000000000000000
+		resampler->A[1] = FILTER_FROM_FLOAT(-0.000000000000000); // Fixed: +0.000000000000000
+		resampler->A[2] = FILTER_FROM_FLOAT(+0.486028822068269); // Fixed: +0.486083984375000
+		resampler->A[3] = FILTER_FROM_FLOAT(-0.000000000000000); // Fixed: +0.000000000000000
+		resampler->A[4] = FILTER_FROM_FLOAT(+0.017664800872442); // Fixed: +0.017700195312500
+		filterSet = true;
+	}
+
 #endif
 
 	// Allow the pass-through filter
@@ -240,9 +343,9 @@ bool resampler_init(resampler_t *resampler, int inFrequency, int outFrequency, i
 	}
 
 	// Initialize filter state
-	for (int j = 0; j < resampler->axes; j++) {
-		for (int k = 0; k < resampler->numCoefficients; k++) {
-			resampler->z[j][k] = FILTER_FROM_INPUT(0);
+	for (int k = 0; k < resampler->numCoefficients; k++) {
+		for (int j = 0; j < RESAMPLER_MAX_AXES; j++) {
+			resampler->z[k][j] = FILTER_FROM_INPUT(0);
 		}
 	}
 
@@ -291,12 +394,18 @@ size_t resampler_output(resampler_t *resampler, resampler_data_t *output, size_t
 		// Use the actual data at the start of the upsample cycle, otherwise zero (the filter interpolates the data)
 		const resampler_data_t *inData = (resampler->upPos == 0) ? resampler->currentData : zeroData;
 
-		// Apply upsampled data through per-channel filters
+		// Apply upsampled data through per-channel filters (any padding axes up to the next four are zero)
+		filter_data_t v[RESAMPLER_MAX_AXES];
+		for (int j = 0; j < resampler->axes; j++) {
+			v[j] = FILTER_FROM_INPUT(inData[j]);
+			v[j] *= resampler->upSample;	// Apply gain: must scale values to keep constant average energy after upsample interpolation filter
+		}
+		for (int j = resampler->axes; j < RESAMPLER_MAX_AXES && (j & 3) != 0; j++) {
+			v[j] = 0;
+		}
+		resampler_filter(resampler, v, inData == zeroData);
 		for (int j = 0; j < resampler->axes; j++) {
-			filter_data_t v = FILTER_FROM_INPUT(inData[j]);
-			v *= resampler->upSample;	// Apply gain: must scale values to keep constant average energy after upsample interpolation filter
-			resampler_filter(resampler->numCoefficients, resampler->B, resampler->A, &v, &v, 1, resampler->z[j]);
-			resampler->filtered[j] = FILTER_TO_OUTPUT(v);
+			resampler->filtered[j] = FILTER_TO_OUTPUT(v[j]);
 		}
 
 		// Take output at start of next downsample cycle
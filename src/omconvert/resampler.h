@@ -15,7 +15,9 @@ extern "C" {
 // Config (move to `resampler-config.h`?)
 //#define RESAMPLER_CALCULATE_COEFFICIENTS	// Support generating arbitrary filters (not just a fixed set) - relies on butter.h/butter.c
 //#define RESAMPLER_FILTER_DOUBLE			// Use floating-point calculations (otherwise, fixed-point for embedded)
-#define RESAMPLER_MAX_AXES 3				// Triaxial
+#ifndef RESAMPLER_MAX_AXES
+	#define RESAMPLER_MAX_AXES 16			// Axes filtered together (e.g. define as 3 for triaxial on embedded; a multiple of 4 allows the axes to be filtered four at a time)
+#endif
 typedef int16_t resampler_data_t;
 
 #ifdef RESAMPLER_CALCULATE_COEFFICIENTS
@@ -79,8 +81,8 @@ typedef struct {
 	filter_data_t A[RESAMPLER_MAX_COEFFICIENTS];
 	int numCoefficients;
 
-	// State for (per axis) filter - final/initial condition tracking
-	filter_data_t z[RESAMPLER_MAX_AXES][RESAMPLER_MAX_COEFFICIENTS];
+	// State for (per axis) filter - final/initial condition tracking (each coefficient's state for all axes, so the axes are filtered together)
+	filter_data_t z[RESAMPLER_MAX_COEFFICIENTS][RESAMPLER_MAX_AXES];
 
 	// Filter output value
 	resampler_data_t filtered[RESAMPLER_MAX_AXES];